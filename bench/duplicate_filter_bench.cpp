@@ -0,0 +1,51 @@
+//
+// Created by muhammad-abdullah on 6/16/25.
+//
+// File: bench/duplicate_filter_bench.cpp
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "rms/duplicate_filter.h"
+
+// Session-sized run: 12M distinct ids through one shard's filter.
+int main(int argc, char **argv) {
+    const uint64_t num_ids = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 12'000'000;
+    rms::DuplicateFilterParams params;
+    params.generations = 4;
+    params.ids_per_generation = 1u << 22;
+    rms::DuplicateOrderFilter filter;
+    filter.init(params, 0);
+
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> ids(num_ids);
+    for (auto &id : ids) id = rng();
+
+    using clock = std::chrono::steady_clock;
+    auto t0 = clock::now();
+    for (uint64_t id : ids) filter.insert(id);
+    auto t1 = clock::now();
+
+    // the most recent generation's worth of ids must all still be visible
+    uint64_t recent = std::min<uint64_t>(num_ids, params.ids_per_generation);
+    uint64_t hits = 0;
+    auto t2 = clock::now();
+    for (uint64_t i = num_ids - recent; i < num_ids; ++i) hits += filter.mayContain(ids[i]);
+    auto t3 = clock::now();
+
+    uint64_t false_hits = 0;
+    for (uint64_t i = 0; i < num_ids; ++i) false_hits += filter.mayContain(rng());
+    auto t4 = clock::now();
+
+    auto ns = [](auto a, auto b, uint64_t n) {
+        return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count() / (double)n;
+    };
+    std::printf("ids=%llu memory=%.1f MiB rotations=%llu\n", (unsigned long long)num_ids,
+                filter.memoryBytes() / (1024.0 * 1024.0), (unsigned long long)filter.rotations());
+    std::printf("insert        %.2f ns/id\n", ns(t0, t1, num_ids));
+    std::printf("lookup (hit)  %.2f ns/id  visible=%llu/%llu\n", ns(t2, t3, recent),
+                (unsigned long long)hits, (unsigned long long)recent);
+    std::printf("lookup (miss) %.2f ns/id  false positive rate=%.5f\n", ns(t3, t4, num_ids),
+                (double)false_hits / (double)num_ids);
+    return hits == recent ? 0 : 1;
+}
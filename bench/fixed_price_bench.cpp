@@ -0,0 +1,130 @@
+//
+// Created by muhammad-abdullah on 7/28/25.
+//
+// File: bench/fixed_price_bench.cpp
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "rms/pretrade_checks.h"
+#include "rms/pretrade_batch.h"
+#include "rms/price_scale.h"
+
+namespace {
+    struct DoubleOrder {
+        uint32_t instrument_id;
+        int64_t  quantity;
+        double   price;
+    };
+
+    // The stateless checks as they were with double prices: the tick test needs
+    // a tolerance, and band edges fall either side depending on binary rounding.
+    bool doubleChecks(const DoubleOrder &o, double ref, double tick) {
+        const auto &lim = instrument_limits;
+        uint32_t i = o.instrument_id;
+        if (o.quantity > (int64_t)lim.max_order_qty[i]) return false;
+        if (std::abs((double)o.quantity * o.price) > lim.max_order_notional[i]) return false;
+        if (std::abs(o.price - ref) > lim.price_tolerance_pct[i] * ref) return false;
+        double ticks = o.price / tick;
+        return std::abs(ticks - std::nearbyint(ticks)) <= 1e-9;
+    }
+
+    // The same checks on FixedPrice, written inline like doubleChecks so the two
+    // differ only in representation.
+    bool fixedChecks(const Order &o, FixedPrice ref) {
+        const auto &lim = instrument_limits;
+        uint32_t i = o.instrument_id;
+        if (o.quantity > (int64_t)lim.max_order_qty[i]) return false;
+        if (std::abs(o.quantity * o.price) > rms::price_scales.toUnits(i, lim.max_order_notional[i])) return false;
+        if (std::abs(o.price - ref) > rms::PriceScales::fraction(ref, lim.price_tolerance_pct[i])) return false;
+        return rms::price_scales.onTick(o.instrument_id, o.price);
+    }
+}
+
+// The per-order stateless checks (qty, notional, price band, tick) over the
+// same order stream with double and with FixedPrice prices, then the batch
+// kernels on FixedPrice lanes.
+int main(int argc, char **argv) {
+    const size_t num_orders = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4'000'000;
+    const uint32_t num_instruments = 64;
+    const double ref = 100.0, tick = 0.01;
+    for (uint32_t i = 0; i < num_instruments; ++i) {
+        rms::price_scales.setDecimals(i, 3);
+        rms::price_scales.setTickSize(i, tick);
+        InstrumentLimits lim;
+        lim.max_order_qty = 100;
+        lim.max_order_notional = 10000.0;
+        lim.price_tolerance_pct = 0.05;
+        lim.max_daily_position = 1'000'000;
+        instrument_limits.set(i, lim);
+    }
+
+    std::mt19937_64 rng(17);
+    std::vector<DoubleOrder> double_orders(4096);
+    std::vector<Order> fixed_orders(4096);
+    for (size_t k = 0; k < fixed_orders.size(); ++k) {
+        auto &f = fixed_orders[k];
+        f.account_id = 0;
+        f.instrument_id = (uint32_t)(rng() % num_instruments);
+        f.quantity = (int64_t)(rng() % 120);
+        // whole cents from 94.00 to 106.00, one in 16 a thousandth off the grid
+        f.price = (FixedPrice)(9400 + rng() % 1201) * 10 + (rng() % 16 == 0 ? 1 : 0);
+        f.side = "BUY";
+        double_orders[k] = DoubleOrder{f.instrument_id, f.quantity, rms::price_scales.toDouble(f.instrument_id, f.price)};
+    }
+
+    using clock = std::chrono::steady_clock;
+    rms::PreTradeChecks checks;
+    uint64_t double_passes = 0, inline_passes = 0, fixed_passes = 0, disagree = 0;
+    auto t0 = clock::now();
+    for (size_t n = 0; n < num_orders; ++n) {
+        double_passes += doubleChecks(double_orders[n & (double_orders.size() - 1)], ref, tick);
+    }
+    auto t1 = clock::now();
+    // instruments share one scale here, so the reference converts once
+    FixedPrice fixed_ref = rms::price_scales.toFixed(0, ref);
+    for (size_t n = 0; n < num_orders; ++n) {
+        inline_passes += fixedChecks(fixed_orders[n & (fixed_orders.size() - 1)], fixed_ref);
+    }
+    auto t2 = clock::now();
+    for (size_t n = 0; n < num_orders; ++n) {
+        const Order &o = fixed_orders[n & (fixed_orders.size() - 1)];
+        fixed_passes += checks.checkMaxOrderQty(o) && checks.checkMaxOrderNotional(o)
+                        && checks.checkPriceBand(o, ref) && checks.checkTickSize(o);
+    }
+    auto t3 = clock::now();
+    for (size_t k = 0; k < fixed_orders.size(); ++k) {
+        const Order &o = fixed_orders[k];
+        bool fixed = checks.checkMaxOrderQty(o) && checks.checkMaxOrderNotional(o)
+                     && checks.checkPriceBand(o, ref) && checks.checkTickSize(o);
+        disagree += fixed != doubleChecks(double_orders[k], ref, tick);
+    }
+
+    auto ns = [&](auto a, auto b) {
+        return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count() / (double)num_orders;
+    };
+    std::printf("orders=%zu passes double=%llu fixed=%llu checks=%llu, %llu of %zu decisions differ\n", num_orders,
+                (unsigned long long)double_passes, (unsigned long long)inline_passes, (unsigned long long)fixed_passes,
+                (unsigned long long)disagree, fixed_orders.size());
+    std::printf("double inline      %.2f ns/order\n", ns(t0, t1));
+    std::printf("fixed inline       %.2f ns/order\n", ns(t1, t2));
+    std::printf("fixed PreTradeChecks %.2f ns/order\n", ns(t2, t3));
+
+    // gather once, then time the kernels alone
+    rms::PreTradeBatch batch;
+    for (uint32_t k = 0; k < MAX_PRETRADE_BATCH_SIZE; ++k) batch.gather(fixed_orders[k], ref);
+    const size_t batches = num_orders / MAX_PRETRADE_BATCH_SIZE;
+    for (auto isa : {rms::BatchIsa::Scalar, rms::BatchIsa::Avx2, rms::BatchIsa::Avx512}) {
+        if (!rms::PreTradeBatch::isaSupported(isa)) continue;
+        uint64_t rejects = 0;
+        auto b0 = clock::now();
+        for (size_t b = 0; b < batches; ++b) rejects += __builtin_popcountll(batch.evaluate(isa).any());
+        auto b1 = clock::now();
+        std::printf("fixed batch %-7s %.2f ns/order (%llu rejects)\n", rms::PreTradeBatch::isaName(isa),
+                    (double)std::chrono::duration_cast<std::chrono::nanoseconds>(b1 - b0).count()
+                        / (double)(batches * MAX_PRETRADE_BATCH_SIZE),
+                    (unsigned long long)rejects);
+    }
+    return 0;
+}
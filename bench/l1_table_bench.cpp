@@ -0,0 +1,58 @@
+//
+// Created by muhammad-abdullah on 7/5/25.
+//
+// File: bench/l1_table_bench.cpp
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "rms/l1_table.h"
+
+// One market-data writer spraying quotes across every instrument while
+// one reader per default shard takes snapshots of random instruments, as checkSpread does.
+int main(int argc, char **argv) {
+    const uint64_t num_updates = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20'000'000;
+    using clock = std::chrono::steady_clock;
+    const int num_readers = (int)rms::ShardLayout::DEFAULT_SHARDS;
+    std::atomic<bool> done{false};
+    std::vector<uint64_t> reads(num_readers);
+    std::vector<double> read_ns(num_readers);
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < num_readers; ++r) {
+        readers.emplace_back([&, r] {
+            uint32_t inst = r * 7919;
+            uint64_t n = 0;
+            double sink = 0.0;
+            auto t0 = clock::now();
+            while (!done.load(std::memory_order_relaxed)) {
+                rms::L1Snapshot snap;
+                inst = (inst * 1103515245u + 12345u) % NUM_INSTRUMENTS;
+                rms::l1_table.read(inst, snap);
+                sink += snap.ask - snap.bid;
+                ++n;
+            }
+            auto t1 = clock::now();
+            reads[r] = n + (sink < 0 ? 1 : 0);
+            read_ns[r] = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / (double)n;
+        });
+    }
+
+    auto t0 = clock::now();
+    for (uint64_t i = 0; i < num_updates; ++i) {
+        double px = 100.0 + (double)(i & 1023) * 0.01;
+        rms::l1_table.updateQuote((uint32_t)(i % NUM_INSTRUMENTS), px, px + 0.01);
+    }
+    auto t1 = clock::now();
+    done = true;
+    for (auto &t : readers) t.join();
+
+    double secs = std::chrono::duration<double>(t1 - t0).count();
+    std::printf("writer: %llu updates in %.3f s, %.1f M updates/s\n",
+                (unsigned long long)num_updates, secs, (double)num_updates / secs / 1e6);
+    for (int r = 0; r < num_readers; ++r) {
+        std::printf("reader %d: %llu reads, %.1f ns/read\n", r, (unsigned long long)reads[r], read_ns[r]);
+    }
+    return 0;
+}
@@ -0,0 +1,212 @@
+//
+// Created by muhammad-abdullah on 7/29/25.
+//
+// File: bench/limits_layout_bench.cpp
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "rms/data_types.h"
+
+namespace {
+    // The layout before the split: a 64-byte struct per instrument and per
+    // account, and a full copy of the instrument limits on every shard.
+    struct alignas(64) AosInstrumentLimits {
+        uint32_t max_order_qty;
+        double   max_order_notional;
+        double   price_tolerance_pct;
+        double   max_spread_ticks;
+        double   init_margin_pct;
+        double   maint_margin_pct;
+        uint32_t max_daily_position;
+        uint32_t max_window_qty;
+        double   max_window_notional;
+    };
+    struct alignas(64) AosAccountLimits {
+        uint32_t max_order_rate_per_sec;
+        uint32_t max_concurrent_orders;
+        double   max_leverage;
+        double   max_drawdown_pct;
+        double   initial_equity;
+        bool     kill_switch;
+    };
+    // the default layout, with slots as account_id % accounts per shard
+    constexpr uint32_t SHARDS = rms::ShardLayout::DEFAULT_SHARDS;
+    constexpr uint32_t ACCOUNTS = rms::ShardLayout::DEFAULT_ACCOUNTS_PER_SHARD;
+    AosInstrumentLimits aos_instruments[SHARDS][NUM_INSTRUMENTS];
+    AosAccountLimits aos_accounts[SHARDS][ACCOUNTS];
+
+    constexpr int64_t SCALE = 10000;    // price units per currency unit
+
+    struct BenchOrder {
+        uint32_t account_id;
+        uint32_t instrument_id;
+        int64_t  quantity;
+        int64_t  price;
+        int64_t  position;      // worst-case position after the order
+        int64_t  reference;
+        uint32_t slot;          // the account's slot, looked up when the order reaches its shard
+    };
+
+    // qty, notional, band, position and the initial-margin gate, the fields the
+    // per-order checks read; both layouts run the same arithmetic
+    bool aosChecks(const BenchOrder &o) {
+        int shard = o.account_id % SHARDS;
+        const auto &lim = aos_instruments[shard][o.instrument_id];
+        const auto &acct = aos_accounts[shard][o.account_id % ACCOUNTS];
+        if (o.quantity > (int64_t)lim.max_order_qty) return false;
+        if ((double)(o.quantity * o.price) > lim.max_order_notional * SCALE) return false;
+        if ((double)std::abs(o.price - o.reference) > lim.price_tolerance_pct * (double)o.reference) return false;
+        if (std::abs(o.position) > (int64_t)lim.max_daily_position) return false;
+        return acct.initial_equity <= 0.0
+            || (double)std::abs(o.position) * (double)o.reference * lim.init_margin_pct <= acct.initial_equity * SCALE;
+    }
+
+    bool soaChecks(const BenchOrder &o) {
+        const auto &lim = instrument_limits;
+        const auto &acct = account_limits[shardOf(o.account_id)];
+        uint32_t i = o.instrument_id, a = o.slot;
+        if (o.quantity > (int64_t)lim.max_order_qty[i]) return false;
+        if ((double)(o.quantity * o.price) > lim.max_order_notional[i] * SCALE) return false;
+        if ((double)std::abs(o.price - o.reference) > lim.price_tolerance_pct[i] * (double)o.reference) return false;
+        if (std::abs(o.position) > (int64_t)lim.max_daily_position[i]) return false;
+        return acct.initial_equity[a] <= 0.0
+            || (double)std::abs(o.position) * (double)o.reference * lim.init_margin_pct[i] <= acct.initial_equity[a] * SCALE;
+    }
+
+    // One hardware counter for this thread, user space only. fd < 0 when the
+    // kernel refuses it (perf_event_paranoid, no PMU in a VM).
+    struct PerfCounter {
+        int fd = -1;
+
+        PerfCounter(uint32_t type, uint64_t config) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+        ~PerfCounter() { if (fd >= 0) close(fd); }
+
+        void start() {
+            if (fd < 0) return;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+        void stop() { if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0); }
+        long long value() const {
+            uint64_t v = 0;
+            if (fd < 0 || read(fd, &v, sizeof(v)) != sizeof(v)) return -1;
+            return (long long)v;
+        }
+    };
+
+    constexpr uint64_t cacheEvent(uint64_t cache, uint64_t op, uint64_t result) {
+        return cache | (op << 8) | (result << 16);
+    }
+
+    void printMisses(const char *name, long long misses, size_t orders) {
+        if (misses < 0) std::printf("  %-10s n/a", name);
+        else std::printf("  %-10s %.3f/order", name, (double)misses / (double)orders);
+    }
+}
+
+// Checks/sec and cache misses of the per-order limit checks with the limits as
+// per-shard 64-byte structs and as the shared columns in data_types.h.
+// Usage: limits_layout_bench [orders] [raw L2 miss event, e.g. 0x3f24 for
+// L2_RQSTS.MISS on recent Intel]; there is no generic L2 event, so without it
+// only L1D and last-level misses are counted.
+int main(int argc, char **argv) {
+    const size_t num_orders = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 8'000'000;
+    const uint64_t l2_event = argc > 2 ? std::strtoull(argv[2], nullptr, 0) : 0;
+    const uint32_t num_accounts = SHARDS * ACCOUNTS;
+
+    std::mt19937_64 rng(29);
+    for (uint32_t i = 0; i < NUM_INSTRUMENTS; ++i) {
+        InstrumentLimits lim;
+        lim.max_order_qty = 500;
+        lim.max_order_notional = 40000.0;
+        lim.price_tolerance_pct = 0.05;
+        lim.max_daily_position = 2000;
+        lim.init_margin_pct = 0.05 + (double)(rng() % 10) / 100.0;
+        instrument_limits.set(i, lim);
+        for (auto &shard : aos_instruments) {
+            shard[i] = AosInstrumentLimits{lim.max_order_qty, lim.max_order_notional, lim.price_tolerance_pct,
+                                           lim.max_spread_ticks, lim.init_margin_pct, lim.maint_margin_pct,
+                                           lim.max_daily_position, lim.max_window_qty, lim.max_window_notional};
+        }
+    }
+    for (uint32_t a = 0; a < num_accounts; ++a) {
+        AccountLimits lim;
+        lim.initial_equity = a % 3 == 0 ? 0.0 : 50000.0 + (double)(rng() % 50000);
+        account_limits[shardOf(a)].set(rms::shard_layout.assign(a), lim);
+        aos_accounts[a % SHARDS][a % ACCOUNTS] =
+            AosAccountLimits{lim.max_order_rate_per_sec, lim.max_concurrent_orders, lim.max_leverage,
+                             lim.max_drawdown_pct, lim.initial_equity, lim.kill_switch};
+    }
+
+    // every account and instrument at random; the orders are read in sequence,
+    // so the prefetcher covers them and what misses is the limits
+    std::vector<BenchOrder> orders(1 << 16);
+    for (auto &o : orders) {
+        o.account_id = (uint32_t)(rng() % num_accounts);
+        o.instrument_id = (uint32_t)(rng() % NUM_INSTRUMENTS);
+        o.quantity = 1 + (int64_t)(rng() % 600);
+        o.reference = (int64_t)(50 + rng() % 100) * SCALE;
+        o.price = o.reference + (int64_t)(rng() % (SCALE * 8)) - SCALE * 4;
+        o.position = (int64_t)(rng() % 4000) - 2000;
+        o.slot = rms::shard_layout.slot(o.account_id);
+    }
+
+    PerfCounter l1d(PERF_TYPE_HW_CACHE,
+                    cacheEvent(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS));
+    PerfCounter llc(PERF_TYPE_HW_CACHE,
+                    cacheEvent(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS));
+    PerfCounter l2(PERF_TYPE_RAW, l2_event);
+    if (l2_event == 0 && l2.fd >= 0) {
+        close(l2.fd);
+        l2.fd = -1;
+    }
+    if (l1d.fd < 0) std::printf("perf counters unavailable (perf_event_paranoid or no PMU); timing only\n");
+    std::printf("orders=%zu instrument limits: aos %zu bytes, soa %zu bytes; account limits: aos %zu, soa %zu\n",
+                num_orders, sizeof(aos_instruments), sizeof(instrument_limits), sizeof(aos_accounts),
+                SHARDS * rms::ShardArena::bytesFor(ACCOUNTS, {sizeof(double), sizeof(double),
+                                                              sizeof(AccountLimitTable::Cold)}));
+
+    using clock = std::chrono::steady_clock;
+    const size_t mask = orders.size() - 1;
+    auto run = [&](const char *name, auto checks) {
+        uint64_t passes = 0;
+        for (const auto &o : orders) passes += checks(o);     // warm up
+        passes = 0;
+        l1d.start();
+        l2.start();
+        llc.start();
+        auto t0 = clock::now();
+        for (size_t n = 0; n < num_orders; ++n) passes += checks(orders[n & mask]);
+        auto t1 = clock::now();
+        llc.stop();
+        l2.stop();
+        l1d.stop();
+        double secs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / 1e9;
+        std::printf("%s  %.1f M checks/s (%llu pass)", name, (double)num_orders / secs / 1e6,
+                    (unsigned long long)passes);
+        printMisses("L1D miss", l1d.value(), num_orders);
+        printMisses("L2 miss", l2.value(), num_orders);
+        printMisses("LLC miss", llc.value(), num_orders);
+        std::printf("\n");
+    };
+    run("aos", [](const BenchOrder &o) { return aosChecks(o); });
+    run("soa", [](const BenchOrder &o) { return soaChecks(o); });
+    return 0;
+}
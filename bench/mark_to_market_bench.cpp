@@ -0,0 +1,51 @@
+//
+// Created by muhammad-abdullah on 7/18/25.
+//
+// File: bench/mark_to_market_bench.cpp
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+#include "rms/mark_to_market.h"
+#include "rms/reference_price.h"
+
+// Cost of repricing one instrument's positions on a shard after its mark moves,
+// per position, and of a full sweep of the shard.
+int main(int argc, char **argv) {
+    const uint32_t num_positions = argc > 1 ? (uint32_t)std::strtoul(argv[1], nullptr, 10) : 100'000;
+    const uint32_t num_instruments = 16;
+    auto &mtm = rms::mark_to_market;
+    std::mt19937_64 rng(4);
+    std::vector<Position> positions(num_positions);
+    for (uint32_t k = 0; k < num_positions; ++k) {
+        Position &pos = positions[k];
+        pos.net_qty = (int64_t)(rng() % 2001) - 1000;
+        pos.avg_entry_price = 90.0 + (double)(rng() % 2000) / 100.0;
+        // shard 0 accounts; positions spread over a few instruments
+        mtm.onPosition((k % rms::shard_layout.accountsPerShard()) * rms::shard_layout.shards(), k % num_instruments, pos, 100.0);
+    }
+
+    using clock = std::chrono::steady_clock;
+    const int ticks = 2000;
+    auto t0 = clock::now();
+    for (int t = 0; t < ticks; ++t) {
+        uint32_t i = (uint32_t)t % num_instruments;
+        rms::reference_prices.onQuote(i, 99.99 + t * 1e-4, 100.01 + t * 1e-4);
+        rms::reference_prices.publish(i);
+        mtm.onMarkChanged(i);
+        mtm.reprice(0);
+    }
+    auto t1 = clock::now();
+    const int sweeps = 200;
+    for (int s = 0; s < sweeps; ++s) mtm.sweep(0);
+    auto t2 = clock::now();
+
+    double per_tick_ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / ticks;
+    std::printf("positions=%u instruments=%u equity[0]=%.2f\n", num_positions, num_instruments, mtm.equity(0));
+    std::printf("reprice     %.2f us/tick, %.2f ns/position\n", per_tick_ns / 1000.0,
+                per_tick_ns / ((double)num_positions / num_instruments));
+    std::printf("sweep       %.2f us/pass\n",
+                (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / sweeps / 1000.0);
+    return 0;
+}
@@ -0,0 +1,65 @@
+//
+// Created by muhammad-abdullah on 7/16/25.
+//
+// File: bench/position_table_bench.cpp
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include <folly/container/F14Map.h>
+#include "rms/data_types.h"
+
+// One shard's worth of live positions: insert, random hit lookups, and the
+// read-modify-write a fill does, for the flat table against F14FastMap.
+namespace {
+    using clock = std::chrono::steady_clock;
+
+    double nsPer(clock::time_point a, clock::time_point b, size_t n) {
+        return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count() / (double)n;
+    }
+}
+
+int main(int argc, char **argv) {
+    const size_t num_positions = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'500'000;
+    const size_t num_lookups = 10'000'000;
+    std::mt19937_64 rng(9);
+    // ~2000 accounts trading up to ~3000 instruments each
+    std::vector<uint64_t> keys;
+    keys.reserve(num_positions);
+    {
+        folly::F14FastMap<uint64_t, bool> seen;
+        while (keys.size() < num_positions) {
+            uint64_t key = positionKey((uint32_t)(rng() % 2000), (uint32_t)(rng() % 100000));
+            if (seen.emplace(key, true).second) keys.push_back(key);
+        }
+    }
+    std::vector<uint32_t> probes(num_lookups);
+    for (auto &p : probes) p = (uint32_t)(rng() % num_positions);
+
+    PositionTable flat;
+    auto t0 = clock::now();
+    for (uint64_t key : keys) flat.findOrInsert((uint32_t)(key >> 32), (uint32_t)key).net_qty = 1;
+    auto t1 = clock::now();
+    int64_t flat_sum = 0;
+    for (uint32_t p : probes) flat_sum += flat.find((uint32_t)(keys[p] >> 32), (uint32_t)keys[p])->net_qty;
+    auto t2 = clock::now();
+    for (uint32_t p : probes) flat.findOrInsert((uint32_t)(keys[p] >> 32), (uint32_t)keys[p]).net_qty += 1;
+    auto t3 = clock::now();
+
+    folly::F14FastMap<uint64_t, Position> f14;
+    auto f0 = clock::now();
+    for (uint64_t key : keys) f14[key].net_qty = 1;
+    auto f1 = clock::now();
+    int64_t f14_sum = 0;
+    for (uint32_t p : probes) f14_sum += f14.find(keys[p])->second.net_qty;
+    auto f2 = clock::now();
+    for (uint32_t p : probes) f14[keys[p]].net_qty += 1;
+    auto f3 = clock::now();
+
+    std::printf("positions=%zu lookups=%zu flat capacity=%zu\n", num_positions, num_lookups, flat.capacity());
+    std::printf("%-10s insert %6.1f ns  find %6.1f ns  update %6.1f ns\n", "flat",
+                nsPer(t0, t1, num_positions), nsPer(t1, t2, num_lookups), nsPer(t2, t3, num_lookups));
+    std::printf("%-10s insert %6.1f ns  find %6.1f ns  update %6.1f ns\n", "F14",
+                nsPer(f0, f1, num_positions), nsPer(f1, f2, num_lookups), nsPer(f2, f3, num_lookups));
+    return flat_sum == f14_sum ? 0 : 1;
+}
@@ -0,0 +1,58 @@
+//
+// Created by muhammad-abdullah on 6/26/25.
+//
+// File: bench/rule_engine_bench.cpp
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "rms/rule_engine.h"
+#include "rms/pretrade_checks.h"
+#include "rms/price_scale.h"
+
+// The built-in qty and notional checks written as a config rule, against the
+// hand-written versions, over the same order stream.
+int main(int argc, char **argv) {
+    const size_t num_orders = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4'000'000;
+    rms::RuleSet rules;
+    std::string error;
+    if (!rules.addRule("QTY_NOTIONAL", "order.qty > limit.max_order_qty || abs(order.notional) > limit.max_order_notional", error)) {
+        std::fprintf(stderr, "compile failed: %s\n", error.c_str());
+        return 1;
+    }
+
+    std::mt19937_64 rng(11);
+    std::vector<Order> orders(4096);
+    for (auto &o : orders) {
+        o = Order{rng(), (uint32_t)(rng() % 1024), (uint32_t)(rng() % NUM_INSTRUMENTS),
+                  (int64_t)(rng() % 150), 0, "SYM", (rng() & 1) ? "BUY" : "SELL"};
+        o.price = rms::price_scales.toFixed(o.instrument_id, 1.0 + (double)(rng() % 20000));
+    }
+
+    using clock = std::chrono::steady_clock;
+    rms::PreTradeChecks checks;
+    uint64_t hand_rejects = 0;
+    auto t0 = clock::now();
+    for (size_t i = 0; i < num_orders; ++i) {
+        const Order &o = orders[i & (orders.size() - 1)];
+        hand_rejects += !(checks.checkMaxOrderQty(o) && checks.checkMaxOrderNotional(o));
+    }
+    auto t1 = clock::now();
+    uint64_t rule_rejects = 0;
+    for (size_t i = 0; i < num_orders; ++i) {
+        const Order &o = orders[i & (orders.size() - 1)];
+        rule_rejects += rules.evaluate(o, shardOf(o.account_id)) >= 0;
+    }
+    auto t2 = clock::now();
+
+    auto ns = [&](auto a, auto b) {
+        return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count() / (double)num_orders;
+    };
+    rms::RuleStats st = rules.stats(0);
+    std::printf("orders=%zu rejects hand=%llu rule=%llu\n", num_orders,
+                (unsigned long long)hand_rejects, (unsigned long long)rule_rejects);
+    std::printf("hand-written  %.2f ns/order\n", ns(t0, t1));
+    std::printf("compiled rule %.2f ns/order  (%.1f cycles/eval sampled)\n", ns(t1, t2),
+                st.sampled ? (double)st.sampled_cycles / st.sampled : 0.0);
+    return hand_rejects == rule_rejects ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+//
+// Created by muhammad-abdullah on 7/23/25.
+//
+// File: bench/scenario_margin_bench.cpp
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "rms/scenario_margin.h"
+
+// Cost of the incremental risk-array update a fill makes, and of rebuilding
+// every account's risk array across all shards in parallel (target: < 10 ms
+// for 100k positions).
+int main(int argc, char **argv) {
+    const uint32_t num_positions = argc > 1 ? (uint32_t)std::strtoul(argv[1], nullptr, 10) : 100'000;
+    auto &span = rms::scenario_margin;
+    std::mt19937_64 rng(44);
+    for (uint32_t i = 0; i < NUM_INSTRUMENTS; ++i) {
+        span.setLinearScenarios(i, 0.5 + (double)(rng() % 500) / 100.0);
+    }
+    // distinct (account, instrument) pairs spread over every shard
+    const uint32_t num_accounts = rms::shard_layout.shards() * rms::shard_layout.accountsPerShard();
+    std::vector<Position> positions(num_positions);
+    for (uint32_t k = 0; k < num_positions; ++k) {
+        positions[k].net_qty = (int64_t)(rng() % 2001) - 1000;
+        span.onPosition(k % num_accounts, (k / num_accounts) % NUM_INSTRUMENTS, positions[k]);
+    }
+
+    using clock = std::chrono::steady_clock;
+    const int fills = 1'000'000;
+    auto t0 = clock::now();
+    for (int f = 0; f < fills; ++f) {
+        uint32_t k = (uint32_t)(rng() % num_positions);
+        positions[k].net_qty += (f & 1) ? 10 : -10;
+        span.onPosition(k % num_accounts, (k / num_accounts) % NUM_INSTRUMENTS, positions[k]);
+    }
+    auto t1 = clock::now();
+    const int passes = 50;
+    for (int p = 0; p < passes; ++p) span.recomputeAll();
+    auto t2 = clock::now();
+    for (int p = 0; p < passes; ++p) span.recompute(0);
+    auto t3 = clock::now();
+
+    double margin = 0.0;
+    for (uint32_t a = 0; a < num_accounts; ++a) margin += span.scenarioMargin(a);
+    std::printf("positions=%u accounts=%u total scenario margin=%.2f\n", num_positions, num_accounts, margin);
+    std::printf("fill          %.2f ns\n",
+                (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / fills);
+    std::printf("recomputeAll  %.3f ms/pass (%d shards in parallel)\n",
+                (double)std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() / passes / 1000.0,
+                (int)rms::shard_layout.shards());
+    std::printf("recompute     %.3f ms/pass (one shard)\n",
+                (double)std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count() / passes / 1000.0);
+    return 0;
+}
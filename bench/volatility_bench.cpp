@@ -0,0 +1,52 @@
+//
+// Created by muhammad-abdullah on 7/8/25.
+//
+// File: bench/volatility_bench.cpp
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+#include "rms/volatility.h"
+
+// Per-tick ingestion cost of the volatility estimators, with ticks spread
+// over every instrument, and the cost of one bulk recompute of all states.
+int main(int argc, char **argv) {
+    const uint64_t num_ticks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20'000'000;
+    auto table = std::make_unique<rms::VolatilityTable>();
+    for (uint32_t i = 0; i < NUM_INSTRUMENTS; ++i) table->setBands(i, 0.002, 0.03);
+
+    // pre-generated random walk so the timed loop only measures onQuote
+    std::mt19937_64 rng(3);
+    std::normal_distribution<double> step(0.0, 0.0005);
+    const size_t path_len = 1 << 20;
+    std::vector<double> mids(path_len);
+    std::vector<uint32_t> insts(path_len);
+    std::vector<double> px(NUM_INSTRUMENTS, 100.0);
+    for (size_t k = 0; k < path_len; ++k) {
+        uint32_t inst = (uint32_t)(rng() % NUM_INSTRUMENTS);
+        px[inst] *= 1.0 + step(rng);
+        insts[k] = inst;
+        mids[k] = px[inst];
+    }
+
+    using clock = std::chrono::steady_clock;
+    auto t0 = clock::now();
+    for (uint64_t k = 0; k < num_ticks; ++k) {
+        size_t j = k & (path_len - 1);
+        table->onQuote(insts[j], mids[j], k / 1000);   // ~1M ticks per simulated second
+    }
+    auto t1 = clock::now();
+    const int passes = 10000;
+    for (int p = 0; p < passes; ++p) table->recompute();
+    auto t2 = clock::now();
+
+    uint32_t breached = 0;
+    for (uint32_t i = 0; i < NUM_INSTRUMENTS; ++i) breached += table->state(i) == rms::VolState::Breach;
+    std::printf("ticks=%llu instruments=%d breached=%u\n", (unsigned long long)num_ticks, NUM_INSTRUMENTS, breached);
+    std::printf("onQuote     %.2f ns/tick\n",
+                (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / (double)num_ticks);
+    std::printf("recompute   %.2f us/pass over all instruments\n",
+                (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / passes / 1000.0);
+    return 0;
+}
@@ -189,7 +189,7 @@ public:
 
     SBE_NODISCARD static SBE_CONSTEXPR std::uint16_t sbeSchemaVersion() SBE_NOEXCEPT
     {
-        return static_cast<std::uint16_t>(0);
+        return static_cast<std::uint16_t>(1);
     }
 
     SBE_NODISCARD static const char *sbeSemanticVersion() SBE_NOEXCEPT
@@ -591,19 +591,19 @@ public:
         return 24;
     }
 
-    static SBE_CONSTEXPR double priceNullValue() SBE_NOEXCEPT
+    static SBE_CONSTEXPR std::int64_t priceNullValue() SBE_NOEXCEPT
     {
-        return SBE_DOUBLE_NAN;
+        return SBE_NULLVALUE_INT64;
     }
 
-    static SBE_CONSTEXPR double priceMinValue() SBE_NOEXCEPT
+    static SBE_CONSTEXPR std::int64_t priceMinValue() SBE_NOEXCEPT
     {
-        return -1.7976931348623157E308;
+        return INT64_C(-9223372036854775807);
     }
 
-    static SBE_CONSTEXPR double priceMaxValue() SBE_NOEXCEPT
+    static SBE_CONSTEXPR std::int64_t priceMaxValue() SBE_NOEXCEPT
     {
-        return 1.7976931348623157E308;
+        return INT64_C(9223372036854775807);
     }
 
     static SBE_CONSTEXPR std::size_t priceEncodingLength() SBE_NOEXCEPT
@@ -611,20 +611,17 @@ public:
         return 8;
     }
 
-    SBE_NODISCARD double price() const SBE_NOEXCEPT
+    SBE_NODISCARD std::int64_t price() const SBE_NOEXCEPT
     {
-        union sbe_double_as_uint_u val;
-        std::memcpy(&val, m_buffer + m_offset + 24, sizeof(double));
-        val.uint_value = SBE_LITTLE_ENDIAN_ENCODE_64(val.uint_value);
-        return val.fp_value;
+        std::int64_t val;
+        std::memcpy(&val, m_buffer + m_offset + 24, sizeof(std::int64_t));
+        return SBE_LITTLE_ENDIAN_ENCODE_64(val);
     }
 
-    Order &price(const double value) SBE_NOEXCEPT
+    Order &price(const std::int64_t value) SBE_NOEXCEPT
     {
-        union sbe_double_as_uint_u val;
-        val.fp_value = value;
-        val.uint_value = SBE_LITTLE_ENDIAN_ENCODE_64(val.uint_value);
-        std::memcpy(m_buffer + m_offset + 24, &val, sizeof(double));
+        std::int64_t val = SBE_LITTLE_ENDIAN_ENCODE_64(value);
+        std::memcpy(m_buffer + m_offset + 24, &val, sizeof(std::int64_t));
         return *this;
     }
 
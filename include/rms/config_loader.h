@@ -4,10 +4,16 @@
 
 // File: include/rms/config_loader.hpp
 #pragma once
+#include <cstdint>
 #include <string>
 
 namespace rms {
     struct ConfigLoader {
         static bool loadConfig(const std::string &filepath);
+        /// Instrument/account limits, limit hierarchy and credit lines (etc/risk_config.yaml)
+        static bool loadRiskConfig(const std::string &filepath);
+        /// Set the shard layout and re-size every per-shard table and module for it,
+        /// dropping their contents. Call before loadRiskConfig and before the shards start.
+        static bool configureShards(uint32_t shards, uint32_t accounts_per_shard);
     };
 }
\ No newline at end of file
@@ -0,0 +1,88 @@
+//
+// Created by muhammad-abdullah on 6/23/25.
+//
+
+// File: include/rms/credit_manager.hpp
+#pragma once
+#include <atomic>
+#include <string>
+#include <vector>
+#include "data_types.h"
+
+namespace rms {
+    // credit is tracked in integer cents so exhaustion is exact
+    constexpr double CREDIT_UNITS_PER_CCY = 100.0;
+
+    struct CreditLine {
+        std::string name;
+        int64_t limit = 0;    // units
+        int64_t chunk = 0;    // units a shard pulls from the pool at a time
+    };
+
+    // Global credit limits (firm credit line, clearing-member cap) spanning
+    // accounts on every shard. Each shard owns a slice of every line and
+    // consumes from it with an uncontended CAS on its own cache line; the
+    // shared pool is only touched when a slice is refilled or topped down,
+    // which the shard does from its idle loop (rebalance). When the pool and
+    // the caller's slice cannot cover an order, the caller sweeps every
+    // shard's slice back, so orders are rejected when the line as a whole is
+    // exhausted, not when one shard's slice runs dry. Credit only moves
+    // between the pool and a slice under the line's flag, so a sweep never
+    // misses credit in transit. An order that needs the pool while another
+    // shard holds the flag is rejected rather than kept waiting, even if the
+    // line still has credit. Each shard also counts what it has consumed, and
+    // releases are capped at that, so available credit never exceeds the
+    // limit.
+    class CreditManager {
+    public:
+        int32_t addLine(const std::string &name, double limit, double chunk);
+        int32_t findLine(const std::string &name) const;
+        bool assignAccount(uint32_t account_id, int32_t line);
+        /// Allocate slices and hand each shard its first chunk; call after the last addLine.
+        void finalize();
+        void clear();
+
+        /// Reserve credit for an order; false if the account's line cannot cover it.
+        bool tryConsume(uint32_t account_id, double notional);
+        /// Unconditional change from fills, cancels and position moves (negative releases,
+        /// up to what the account's shard has consumed from the line).
+        void adjust(uint32_t account_id, double notional);
+        /// Refill low slices and return surplus to the pool. Shard thread only.
+        void rebalance(int shard);
+
+        /// Unreserved credit of a line: pool plus every shard slice.
+        int64_t available(int32_t line) const;
+        int64_t slice(int32_t line, int shard) const;
+        /// Credit of a line consumed and not yet released, over every shard.
+        int64_t used(int32_t line) const;
+        size_t size() const { return lines_.size(); }
+
+        static int64_t toUnits(double notional);
+
+    private:
+        struct alignas(64) SliceLine {
+            std::atomic<int64_t> v[8];
+        };
+        struct alignas(64) Pool {
+            std::atomic<int64_t> free{0};
+            std::atomic_flag sweeping = ATOMIC_FLAG_INIT;
+        };
+
+        std::atomic<int64_t> &sliceRef(int32_t line, int shard) const;
+        std::atomic<int64_t> &usedRef(int32_t line, int shard) const;
+        int32_t lineFor(uint32_t account_id) const;
+        int64_t takeFromPool(int32_t line, int64_t want);
+        bool refillAndConsume(int32_t line, int shard, int64_t units);
+        bool sweepAndConsume(int32_t line, int shard, int64_t units);   // caller holds the line's flag
+
+        std::vector<CreditLine> lines_;
+        folly::F14FastMap<uint32_t, int32_t> account_lines_;
+        mutable std::vector<SliceLine> slices_;
+        mutable std::vector<SliceLine> used_;   // same layout; written by the owning shard only
+        std::vector<Pool> pools_;
+        size_t lines_per_shard_ = 0;
+        uint32_t shards_ = 0;         // shard_layout.shards() at finalize()
+    };
+
+    extern CreditManager credit_manager;
+}
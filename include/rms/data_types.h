@@ -5,11 +5,18 @@
 #pragma once
 #include <cstdint>
 #include <array>
+#include <string>
+#include <vector>
 #include <folly/container/F14Map.h>
+#include "position_table.h"
+#include "shard_layout.h"
 
-constexpr u_int8_t NUM_SHARDS = 4;
 constexpr int NUM_INSTRUMENTS = 1024;
-constexpr int ACCOUNTS_PER_SHARD = 256;
+constexpr uint32_t NO_MARK_SLOT = UINT32_MAX;
+
+// Order and trade prices: an integer count of 10^-decimals of the instrument's
+// currency, decimals set per instrument in rms::price_scales
+using FixedPrice = int64_t;
 
 struct InstrumentLimits {
     uint32_t  max_order_qty = 100;
@@ -19,22 +26,27 @@ struct InstrumentLimits {
     double    init_margin_pct = 0.05;
     double    maint_margin_pct = 0.025;
     uint32_t  max_daily_position = 1000;
-} __attribute__((aligned(64)));
+    uint32_t  max_window_qty = 0;           // rolling-window traded qty, 0 = unlimited
+    double    max_window_notional = 0.0;    // rolling-window traded notional, 0 = unlimited
+};
 
 struct AccountLimits {
     uint32_t max_order_rate_per_sec = 100;
     uint32_t max_concurrent_orders = 100;
     double   max_leverage = 10.0;
     double   max_drawdown_pct = 0.1;
+    double   initial_equity = 0.0;      // account equity before the session's PnL
     bool     kill_switch = false;
-} __attribute__((aligned(64)));
+};
 
 struct Position {
     int64_t net_qty = 0;
     double  avg_entry_price = 0.0;
     double  realized_pnl = 0.0;
     double  unrealized_pnl = 0.0;
-    double  peak_equity = 0.0;
+    uint32_t mark_slot = NO_MARK_SLOT;  // row in the shard's mark-to-market columns
+    uint32_t scenario_slot = NO_MARK_SLOT;  // row in the shard's scenario-margin columns
+    uint32_t var_slot = NO_MARK_SLOT;       // row in the shard's historical VaR columns
 } __attribute__((aligned(64)));
 
 struct Order {
@@ -42,25 +54,123 @@ struct Order {
     uint32_t account_id;
     uint32_t instrument_id;
     int64_t  quantity;
-    double   price;
+    FixedPrice price;
     std::string     symbol;
     std::string     side;   // "BUY" or "SELL"
 };
 
+// Accepted order still working at the venue
+struct OpenOrder {
+    uint32_t account_id;
+    uint32_t instrument_id;
+    int64_t  leaves_qty;
+    FixedPrice price;
+    bool     is_buy;
+};
+
+// Working quantity per (account, instrument) on each side, net of fills and cancels
+struct OpenExposure {
+    int64_t buy_qty = 0;
+    int64_t sell_qty = 0;
+};
+
+inline bool isBuy(const Order &order) {
+    return order.side != "SELL";
+}
+
+// Shard owning the account's orders, positions and per-account state
+inline uint32_t shardOf(uint32_t account_id) {
+    return rms::shard_layout.shardOf(account_id);
+}
+
+inline uint64_t positionKey(uint32_t account_id, uint32_t instrument_id) {
+    return ((uint64_t)account_id << 32) | instrument_id;
+}
+
 struct TradeExecution {
     uint64_t order_id;
     uint32_t account_id;
     uint32_t instrument_id;
     int64_t  quantity;
-    double   price;
+    FixedPrice price;
     char     symbol[16];
     bool     is_buy;
+    uint16_t venue_id;
+    uint64_t trade_id;          // the venue's sequence number; 0 if it assigns none
+}__attribute__((aligned(64)));
+
+enum class TradeCorrectionKind : uint8_t { Bust = 0, Correct = 1 };
+
+// A venue busting or correcting an earlier trade, identified by venue_id and trade_id
+struct TradeCorrection {
+    uint32_t account_id;
+    uint32_t instrument_id;
+    uint16_t venue_id;
     uint64_t trade_id;
+    int64_t  quantity;          // Correct: the trade's corrected quantity and price, same side
+    FixedPrice price;
+    TradeCorrectionKind kind;
+}__attribute__((aligned(64)));
+
+// A client or venue cancel of a working order; releases whatever it still had working
+struct OrderCancel {
+    uint64_t order_id;
+    uint32_t account_id;
 }__attribute__((aligned(64)));
 
-using InstrumentLimitsShard = std::array<InstrumentLimits, NUM_INSTRUMENTS>;
-using AccountLimitsShard = std::array<AccountLimits, ACCOUNTS_PER_SHARD>;
+// InstrumentLimits stored a column per field, so a check loads only the fields
+// it reads and a line of one column covers 8-16 instruments. The limits are
+// the same on every shard: one table, written at config load and read-only
+// while the shards run.
+struct InstrumentLimitTable {
+    alignas(64) uint32_t max_order_qty[NUM_INSTRUMENTS];
+    alignas(64) uint32_t max_daily_position[NUM_INSTRUMENTS];
+    alignas(64) uint32_t max_window_qty[NUM_INSTRUMENTS];
+    alignas(64) double   max_order_notional[NUM_INSTRUMENTS];
+    alignas(64) double   price_tolerance_pct[NUM_INSTRUMENTS];
+    alignas(64) double   max_window_notional[NUM_INSTRUMENTS];
+    alignas(64) double   init_margin_pct[NUM_INSTRUMENTS];
+    alignas(64) double   maint_margin_pct[NUM_INSTRUMENTS];
+    alignas(64) double   max_spread_ticks[NUM_INSTRUMENTS];
+
+    InstrumentLimitTable();     // every instrument at the InstrumentLimits defaults
+    void set(uint32_t instrument_id, const InstrumentLimits &lim);
+    InstrumentLimits get(uint32_t instrument_id) const;
+};
+
+// One shard's AccountLimits, indexed by the account's slot in
+// rms::shard_layout. The fields read per order or per tick are columns; the
+// rest, read only by config, persistence and rules, stay together in cold.
+// Every slot starts at the AccountLimits defaults.
+struct AccountLimitTable {
+    struct Cold {
+        uint32_t max_order_rate_per_sec;
+        uint32_t max_concurrent_orders;
+        double   max_leverage;
+        bool     kill_switch;
+    };
+
+    double *initial_equity = nullptr;
+    double *max_drawdown_pct = nullptr;
+    Cold   *cold = nullptr;
+
+    explicit AccountLimitTable(uint32_t accounts);
+    void set(uint32_t slot, const AccountLimits &lim);
+    AccountLimits get(uint32_t slot) const;
+
+private:
+    rms::ShardArena arena_;
+};
+
+using PositionTable = rms::FlatPositionTable<Position>;
+
+// The per-shard tables below hold one entry per shard of rms::shard_layout
+extern InstrumentLimitTable instrument_limits;
+extern std::vector<AccountLimitTable> account_limits;
+extern std::vector<PositionTable> position_store;    // keyed by (account_id, instrument_id)
+extern std::vector<folly::F14FastMap<uint64_t, OpenOrder>> open_order_store;
+extern std::vector<folly::F14FastMap<uint64_t, OpenExposure>> open_exposure_store;
 
-extern InstrumentLimitsShard instrument_limits_shards[NUM_SHARDS];
-extern AccountLimitsShard account_limits_shards[NUM_SHARDS];
-extern std::array<folly::F14FastMap<uint32_t, Position>, NUM_SHARDS> position_store;
\ No newline at end of file
+// Re-create the per-shard tables, empty and at default limits, for a new
+// shard layout. Not safe while shards run.
+void resizeShardTables(uint32_t shards, uint32_t accounts_per_shard);
\ No newline at end of file
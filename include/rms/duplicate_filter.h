@@ -0,0 +1,67 @@
+//
+// Created by muhammad-abdullah on 6/16/25.
+//
+
+// File: include/rms/duplicate_filter.hpp
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace rms {
+    struct DuplicateFilterParams {
+        uint32_t generations = 4;              // window is split across this many sub-filters
+        uint32_t ids_per_generation = 1u << 20;
+        uint32_t bits_per_id = 16;
+        uint64_t window_ms = 600000;           // minimum age an id stays visible
+    };
+
+    // Blocked Bloom filter over order ids with a sliding time window. Every id
+    // maps to one 64-byte block per generation and those blocks sit next to
+    // each other, so a lookup reads a few adjacent cache lines regardless of
+    // how many ids were seen. One spare generation beyond the window is wiped
+    // a few blocks per call, so when the current generation's time slice or
+    // capacity runs out the spare is already empty and takes over, and the
+    // oldest generation becomes the next spare. Memory stays fixed for the
+    // session and no call clears a whole generation.
+    class DuplicateOrderFilter {
+    public:
+        void init(const DuplicateFilterParams &params, uint64_t now_ms);
+
+        /// Rotate out generations older than the window and wipe part of the spare;
+        /// call with a coarse clock, also when idle.
+        void advance(uint64_t now_ms);
+
+        /// False means the id was definitely not seen inside the window.
+        bool mayContain(uint64_t order_id) const;
+        void insert(uint64_t order_id);
+
+        uint64_t rotations() const { return rotations_; }
+        size_t memoryBytes() const { return blocks_.size() * sizeof(Block); }
+
+    private:
+        struct alignas(64) Block {
+            uint64_t words[8];
+        };
+
+        void rotate(uint64_t now_ms);
+        // wipe up to n more blocks of the spare generation
+        void clearSpare(uint32_t n);
+        size_t blockIndex(uint64_t hash) const;
+
+        std::vector<Block> blocks_;      // blocks_per_gen_ * slots_, generation-minor
+        uint32_t generations_ = 0;       // generations inside the window
+        uint32_t slots_ = 0;             // generations_ plus the spare
+        uint32_t blocks_per_gen_ = 0;
+        uint32_t current_ = 0;
+        uint32_t spare_ = 0;
+        uint32_t cleared_ = 0;           // blocks of the spare wiped so far
+        uint32_t clear_step_ = 0;        // blocks wiped per insert or advance
+        uint32_t inserted_ = 0;          // ids in the current generation
+        uint32_t capacity_ = 0;
+        uint64_t slice_ms_ = 0;
+        uint64_t slice_start_ms_ = 0;
+        uint64_t last_now_ms_ = 0;
+        uint64_t rotations_ = 0;
+    };
+}
@@ -0,0 +1,115 @@
+//
+// Created by muhammad-abdullah on 7/24/25.
+//
+
+// File: include/rms/historical_var.hpp
+#pragma once
+#include <string>
+#include <vector>
+#include "data_types.h"
+
+namespace rms {
+    struct VarParams {
+        double confidence = 0.99;        // VaR is the loss not exceeded in this share of the history
+    };
+
+    // Layout of the returns file: this header, then one column of num_scenarios
+    // doubles per instrument, instrument 0 first. Column i is the instrument's
+    // return on each historical day.
+    struct VarFileHeader {
+        char     magic[8];               // "RMSVAR1"
+        uint32_t num_instruments;
+        uint32_t num_scenarios;
+    };
+
+    // Intraday historical-simulation VaR per account and per limit-tree node.
+    //
+    // The returns file is memory-mapped and read in place. Every account keeps
+    // a P&L vector over the historical scenarios, the sum of exposure (qty *
+    // mark) times the instrument's return column over its positions; every
+    // limit-tree node keeps one per shard for the accounts below it. A fill
+    // adds the change in exposure times the column, so VaR is a partial
+    // selection (nth_element) over an up-to-date vector.
+    //
+    // Marks drift away from the exposures the vectors were built at, so each
+    // shard rebuilds its vectors at current marks in slices on its own thread:
+    // recomputeStep() fills shadow vectors a few instruments at a time while
+    // fills keep updating both, and swaps them in when the pass completes.
+    // Order flow on the shard only ever waits for one slice.
+    class HistoricalVarEngine {
+    public:
+        HistoricalVarEngine() = default;
+        ~HistoricalVarEngine();
+        HistoricalVarEngine(const HistoricalVarEngine &) = delete;
+        HistoricalVarEngine &operator=(const HistoricalVarEngine &) = delete;
+
+        void init(const VarParams &params) { params_ = params; }
+        /// Take shard_layout's capacities; load() sizes the vectors for them. Drops every
+        /// position. Not safe while shards run.
+        void resize(uint32_t shards, uint32_t accounts_per_shard);
+        /// Map the returns file and size the vectors; drops every position. Call after
+        /// the limit tree is finalized. Not safe while shards run.
+        bool load(const std::string &path);
+        void unload();
+        /// Write a returns file from num_instruments columns of num_scenarios returns.
+        static bool writeFile(const std::string &path, uint32_t num_instruments, uint32_t num_scenarios,
+                              const double *columns);
+
+        uint32_t scenarios() const { return num_scenarios_; }
+        /// The instrument's return column, or nullptr if the file has none for it.
+        const double *returns(uint32_t instrument_id) const;
+
+        /// Shard thread: the fill changed pos. Exposure is priced at the instrument's
+        /// reference price, else its last mark, else fallback_mark.
+        void onPosition(uint32_t account_id, uint32_t instrument_id, Position &pos, double fallback_mark);
+        /// Shard thread: rebuild up to about max_positions positions of the running
+        /// pass at current marks; starts a pass if none is running. True when a pass
+        /// completed and was swapped in.
+        bool recomputeStep(int shard, size_t max_positions);
+        /// Full pass on every shard, each on its own thread. Not safe while shards run.
+        void recomputeAll();
+
+        /// Shard thread: the account's VaR at the configured confidence, as a positive loss.
+        double var(uint32_t account_id);
+        /// VaR of a limit-tree node over all shards. Reads other shards' vectors while
+        /// they may be mid-update, so it is for monitoring, not for checks.
+        double nodeVar(int32_t node, std::vector<double> &scratch) const;
+        /// The account's P&L in each historical scenario; nullptr for an account without a slot.
+        const double *pnl(uint32_t account_id) const;
+
+    private:
+        struct Columns {
+            std::vector<double> qty;
+            std::vector<double> exposure;   // qty * mark the live vectors hold
+            std::vector<double> pending;    // qty * mark the shadow vectors hold
+            std::vector<uint16_t> account;  // the account's slot in the shard
+            double mark = 0.0;
+        };
+        struct alignas(64) Shard {
+            std::vector<Columns> columns;
+            std::vector<double> account_pnl;          // accounts per shard x num_scenarios
+            std::vector<double> node_pnl;             // limit-tree nodes x num_scenarios
+            std::vector<double> shadow_account_pnl;
+            std::vector<double> shadow_node_pnl;
+            std::vector<double> scratch;
+            uint32_t cursor = 0;                      // next instrument of the running pass
+            bool in_pass = false;
+        };
+
+        void addExposure(Shard &shard, uint32_t account_id, uint16_t acct, const double *ret, double delta);
+        void rebuildNodes(int shard_id, std::vector<double> &node_pnl, const std::vector<double> &account_pnl) const;
+        double quantileLoss(double *pnl) const;
+
+        VarParams params_;
+        void *map_ = nullptr;
+        size_t map_size_ = 0;
+        const double *columns_ = nullptr;
+        uint32_t num_instruments_ = 0;
+        uint32_t num_scenarios_ = 0;
+        size_t num_nodes_ = 0;
+        uint32_t accounts_per_shard_ = ShardLayout::DEFAULT_ACCOUNTS_PER_SHARD;
+        std::vector<Shard> shards_ = std::vector<Shard>(ShardLayout::DEFAULT_SHARDS);
+    };
+
+    extern HistoricalVarEngine historical_var;
+}
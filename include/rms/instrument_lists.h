@@ -0,0 +1,92 @@
+//
+// Created by muhammad-abdullah on 6/30/25.
+//
+
+// File: include/rms/instrument_lists.hpp
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "data_types.h"
+
+namespace rms {
+    enum class InstrumentListKind : uint8_t { Restricted, HardToBorrow, Count };
+
+    // Immutable bitset over instrument_id: membership is one word load.
+    class InstrumentSet {
+    public:
+        static constexpr uint32_t MAX_INSTRUMENT_ID = 1u << 24;   // 2 MiB of bits at most
+
+        explicit InstrumentSet(const std::vector<uint32_t> &ids);
+
+        bool contains(uint32_t instrument_id) const {
+            size_t word = instrument_id >> 6;
+            return word < words_.size() && ((words_[word] >> (instrument_id & 63)) & 1);
+        }
+        size_t size() const { return count_; }
+
+    private:
+        std::vector<uint64_t> words_;
+        size_t count_ = 0;
+    };
+
+    // Restricted and hard-to-borrow lists. Each list is rebuilt off the hot path
+    // and published with a single pointer store; shard threads read it with one
+    // acquire load and no write. Reclamation is quiescent-state based: each
+    // shard registers as a reader and, once per loop, publishes the global
+    // epoch it has seen, promising it holds no set from before it. A writer
+    // that swapped a set out bumps the epoch and frees the old set once every
+    // registered reader has published the new value. A thread that is not a
+    // registered reader must not read while another thread publishes.
+    class InstrumentLists {
+    public:
+        static constexpr uint32_t MAX_READERS = ShardLayout::MAX_SHARDS;
+
+        InstrumentLists() = default;
+        InstrumentLists(const InstrumentLists &) = delete;
+        InstrumentLists &operator=(const InstrumentLists &) = delete;
+        ~InstrumentLists();
+
+        bool contains(InstrumentListKind kind, uint32_t instrument_id) const {
+            const InstrumentSet *set = slots_[(int)kind].current.load(std::memory_order_acquire);
+            return set != nullptr && set->contains(instrument_id);
+        }
+        size_t size(InstrumentListKind kind) const;
+
+        /// Register reader (a shard id) before its first read.
+        void online(uint32_t reader);
+        /// Called by a registered reader between reads, once per loop: it holds no set.
+        void quiesce(uint32_t reader) {
+            readers_[reader].epoch.store(epoch_.load(std::memory_order_acquire), std::memory_order_release);
+        }
+        /// Deregister reader; publishers stop waiting for it.
+        void offline(uint32_t reader);
+
+        /// Build a set from ids and swap it in; false if an id exceeds MAX_INSTRUMENT_ID.
+        bool publish(InstrumentListKind kind, const std::vector<uint32_t> &ids);
+        /// Load ids separated by whitespace or commas; '#' starts a comment.
+        bool loadFile(InstrumentListKind kind, const std::string &path);
+        void clear();
+
+        static bool parseIds(const char *data, size_t len, std::vector<uint32_t> &ids, std::string &error);
+
+    private:
+        struct alignas(64) Slot {
+            std::atomic<const InstrumentSet *> current{nullptr};
+        };
+        struct alignas(64) Reader {
+            std::atomic<uint64_t> epoch{0};    // 0 while offline
+        };
+
+        // Publisher, after swapping old out: free it once no reader can hold it.
+        void retire(const InstrumentSet *old);
+
+        Slot slots_[(int)InstrumentListKind::Count];
+        alignas(64) std::atomic<uint64_t> epoch_{1};
+        Reader readers_[MAX_READERS];
+        std::mutex publish_mutex_;
+    };
+
+    extern InstrumentLists instrument_lists;
+}
@@ -0,0 +1,56 @@
+//
+// Created by muhammad-abdullah on 7/5/25.
+//
+
+// File: include/rms/l1_table.hpp
+#pragma once
+#include <atomic>
+#include "data_types.h"
+
+namespace rms {
+    struct L1Snapshot {
+        double bid = 0.0;
+        double ask = 0.0;
+        double last = 0.0;
+        double tick_size = 0.0;
+        uint32_t seq = 0;
+
+        bool hasQuote() const { return bid > 0.0 && ask > 0.0; }
+    };
+
+    // Top of book per instrument, one cache line each, indexed by instrument_id.
+    // Single writer (the market-data thread) and any number of shard readers,
+    // synchronised by a per-entry sequence lock: the writer never waits and a
+    // reader only retries if it raced an update to the same instrument.
+    class L1Table {
+    public:
+        L1Table() = default;
+        L1Table(const L1Table &) = delete;
+        L1Table &operator=(const L1Table &) = delete;
+
+        /// Writer side. Ids outside the table are ignored.
+        void updateQuote(uint32_t instrument_id, double bid, double ask);
+        void updateLast(uint32_t instrument_id, double last);
+        void setTickSize(uint32_t instrument_id, double tick_size);
+
+        /// Consistent copy of one entry; false for ids outside the table.
+        bool read(uint32_t instrument_id, L1Snapshot &out) const;
+
+    private:
+        struct alignas(64) Entry {
+            std::atomic<uint32_t> seq{0};
+            // fields are atomics only so racing reads are defined; all accesses are relaxed
+            std::atomic<double> bid{0.0};
+            std::atomic<double> ask{0.0};
+            std::atomic<double> last{0.0};
+            std::atomic<double> tick_size{0.01};
+        };
+
+        Entry &beginWrite(uint32_t instrument_id);
+        static void endWrite(Entry &e);
+
+        std::array<Entry, NUM_INSTRUMENTS> entries_;
+    };
+
+    extern L1Table l1_table;
+}
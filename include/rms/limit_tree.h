@@ -0,0 +1,73 @@
+//
+// Created by muhammad-abdullah on 6/20/25.
+//
+
+// File: include/rms/limit_tree.hpp
+#pragma once
+#include <atomic>
+#include <string>
+#include <vector>
+#include "data_types.h"
+
+namespace rms {
+    constexpr int MAX_LIMIT_DEPTH = 4;
+
+    enum class LimitLevel : uint8_t { Firm, Desk, Trader, Account };
+
+    struct LimitNode {
+        std::string name;
+        LimitLevel  level = LimitLevel::Firm;
+        int32_t     parent = -1;
+        uint8_t     depth = 0;                  // 0 for roots
+        double      max_gross_notional = 0.0;   // open order notional plus filled gross notional
+    };
+
+    // Nodes from the account's own node up to its root
+    struct LimitPath {
+        uint8_t depth = 0;
+        int32_t nodes[MAX_LIMIT_DEPTH] = {};
+    };
+
+    // Firm/desk/trader/account exposure caps. The structure is built once from
+    // config before the shards start and is read-only afterwards. Usage is kept
+    // as one partial sum per shard, written only by that shard's thread, so
+    // updates never contend; readers reconcile a node by summing the partials.
+    class LimitTree {
+    public:
+        /// Returns the node index, or -1 if the parent is unknown or the path would be too deep.
+        int32_t addNode(const std::string &name, LimitLevel level, int32_t parent, double max_gross_notional);
+        int32_t findNode(const std::string &name) const;
+        bool assignAccount(uint32_t account_id, int32_t node);
+        /// Allocate the usage partials; call after the last addNode.
+        void finalize();
+        void clear();
+
+        /// True if adding notional keeps every node on the account's path within its cap.
+        bool check(uint32_t account_id, double notional) const;
+        /// Apply a usage delta along the account's path. Shard thread of the account only.
+        void addUsage(uint32_t account_id, double delta);
+
+        double usage(int32_t node) const;
+        const LimitPath *pathFor(uint32_t account_id) const;
+        size_t size() const { return nodes_.size(); }
+        const LimitNode &node(int32_t idx) const { return nodes_[idx]; }
+
+        static bool parseLevel(const std::string &name, LimitLevel &level);
+
+    private:
+        // eight partials per line; each shard owns whole lines
+        struct alignas(64) UsageLine {
+            std::atomic<double> v[8];
+        };
+
+        std::atomic<double> &partial(int shard, int32_t node) const;
+
+        std::vector<LimitNode> nodes_;
+        folly::F14FastMap<uint32_t, LimitPath> account_paths_;
+        mutable std::vector<UsageLine> usage_;
+        size_t lines_per_shard_ = 0;
+        uint32_t shards_ = 0;         // shard_layout.shards() at finalize()
+    };
+
+    extern LimitTree limit_tree;
+}
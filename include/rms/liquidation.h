@@ -0,0 +1,132 @@
+//
+// Created by muhammad-abdullah on 7/21/25.
+//
+
+// File: include/rms/liquidation.hpp
+#pragma once
+#include <atomic>
+#include <cstring>
+#include <vector>
+#include <concurrent/ringbuffer/OneToOneRingBuffer.h>
+#include "data_types.h"
+#include "utils/params.h"
+
+namespace rms {
+    enum class LiquidationReason : uint8_t { MaintenanceMargin = 0, Drawdown = 1 };
+
+    // Wire format on the liquidation outbound stream: a type byte, then this struct
+    struct LiquidationOrder {
+        uint64_t liquidation_id;         // comes back as order_id on its fills and cancels
+        uint64_t breach_ns;              // when the breach was detected, utils::nowNs()
+        uint32_t account_id;
+        uint32_t instrument_id;
+        int64_t  quantity;
+        FixedPrice price;                // mark the order was sized at
+        bool     is_buy;
+        LiquidationReason reason;
+    };
+
+    // Breach-to-publish latency, log2 buckets of nanoseconds. One writer (the publisher).
+    struct LiquidationLatency {
+        static constexpr int BUCKETS = 48;
+        std::atomic<uint64_t> buckets[BUCKETS] = {};
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> max_ns{0};
+
+        void record(uint64_t ns);
+        /// Upper bound of the bucket holding the p-quantile (0 < p <= 1); 0 if empty.
+        uint64_t percentileNs(double p) const;
+    };
+
+    // Turns margin and drawdown breaches into closing orders. The shard thread
+    // that detects a breach sizes the orders from the account's positions and
+    // writes them to its own one-to-one ring, so it never waits on the network;
+    // the publisher thread drains the rings onto the outbound stream and records
+    // the breach-to-publish latency. A maintenance breach reduces the biggest
+    // margin users until initial margin is covered by equity again; a drawdown
+    // breach, or an account with no equity left, is flattened. The quantity of
+    // each (account, instrument) still in flight is netted out of the sizing,
+    // so the ticks of a fast market re-detecting the same breach do not stack
+    // liquidations on top of the ones already out; it is released by the
+    // order's fills and by its cancel or reject, not by a timer.
+    class LiquidationEngine {
+    public:
+        LiquidationEngine();
+        LiquidationEngine(const LiquidationEngine &) = delete;
+        LiquidationEngine &operator=(const LiquidationEngine &) = delete;
+
+        /// One ring per shard; drops queued and in-flight orders. Not safe while shards or
+        /// the publisher run.
+        void resize(uint32_t shards, uint32_t accounts_per_shard);
+
+        /// Shard thread, after any fill or mark on the account: flatten on a drawdown past
+        /// max_drawdown_pct from the high-water mark, else reduce if equity is below maintenance
+        /// margin. True on a breach, whether orders went out or were suppressed.
+        /// Accounts without initial_equity are skipped.
+        bool checkAccount(uint32_t account_id, uint64_t now_ms);
+        /// Shard thread: size and queue liquidation orders; returns orders queued (0 when suppressed).
+        size_t onBreach(uint32_t account_id, LiquidationReason reason, uint64_t now_ms);
+        /// Shard thread, before the fill is applied to the position: a fill of a liquidation
+        /// order releases its filled quantity. Other fills are ignored.
+        void onFill(const TradeExecution &trade);
+        /// Shard thread: the venue cancelled or rejected the order; releases what was left of it.
+        /// False if order_id is no liquidation order in flight.
+        bool onCancel(uint32_t account_id, uint64_t order_id);
+        /// Quantity of the account's liquidation orders in instrument_id not yet filled or cancelled.
+        int64_t inFlight(uint32_t account_id, uint32_t instrument_id) const;
+
+        /// Publisher thread: hand up to limit queued orders of the shard to f.
+        template <typename F>
+        int drain(int shard, F &&f, int limit = 64) {
+            return shards_[shard].ring.read(
+                [&f](int8_t, aeron::concurrent::AtomicBuffer &buffer, int32_t offset, int32_t length) {
+                    LiquidationOrder order;
+                    if (length != (int32_t)sizeof(order)) return;
+                    std::memcpy(&order, buffer.buffer() + offset, sizeof(order));
+                    f(order);
+                },
+                limit);
+        }
+        /// Publisher thread: the order is on the wire.
+        void onPublished(const LiquidationOrder &order, uint64_t now_ns);
+
+        const LiquidationLatency &latency() const { return latency_; }
+        uint64_t issued() const;
+        uint64_t suppressed() const;
+        uint64_t ringFull() const;
+
+    private:
+        struct Candidate {
+            uint32_t instrument_id;
+            int64_t  net_qty;
+            double   mark;
+            double   margin;             // initial margin the position uses
+            int64_t  in_flight;          // closing quantity already out
+        };
+        struct InFlight {
+            uint64_t position;           // positionKey(account_id, instrument_id)
+            int64_t  leaves_qty;
+        };
+        struct alignas(64) Shard {
+            Shard();
+            std::array<uint8_t, LIQUIDATION_RING_BUFFER_SIZE + aeron::concurrent::ringbuffer::RingBufferDescriptor::TRAILER_LENGTH> buffer;
+            aeron::concurrent::AtomicBuffer atomic_buffer;
+            aeron::concurrent::ringbuffer::OneToOneRingBuffer ring;
+            folly::F14FastMap<uint64_t, InFlight> orders;        // by liquidation_id
+            folly::F14FastMap<uint64_t, int64_t> in_flight;      // by positionKey, sum of leaves_qty
+            std::vector<Candidate> candidates;
+            uint64_t next_id = 0;
+            std::atomic<uint64_t> issued{0};
+            std::atomic<uint64_t> suppressed{0};
+            std::atomic<uint64_t> ring_full{0};
+        };
+
+        bool enqueue(Shard &shard, const LiquidationOrder &order);
+        static void release(Shard &shard, folly::F14FastMap<uint64_t, InFlight>::iterator it, int64_t qty);
+
+        std::vector<Shard> shards_;
+        LiquidationLatency latency_;
+    };
+
+    extern LiquidationEngine liquidations;
+}
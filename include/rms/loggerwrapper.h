@@ -21,6 +21,11 @@ namespace rms
         ~LoggerWrapper()
         {
         }
+        // the messaging logger comes after the shards'
+        uint8_t messagingId() const
+        {
+            return (uint8_t)(shard_loggers.size() - 1);
+        }
         std::unique_ptr<Logger> &getLogger(uint8_t shard_id)
         {
             return shard_loggers[shard_id];
@@ -0,0 +1,120 @@
+//
+// Created by muhammad-abdullah on 7/18/25.
+//
+
+// File: include/rms/mark_to_market.hpp
+#pragma once
+#include <atomic>
+#include <vector>
+#include "data_types.h"
+
+namespace rms {
+    // Live unrealized PnL, account equity and margin, repriced whenever an
+    // instrument's reference price moves rather than only when the position trades.
+    //
+    // Each shard keeps its positions a second time as SoA columns grouped by
+    // instrument (qty, entry price, unrealized, gross notional, realized,
+    // account), so a mark change is one vector pass over that instrument's
+    // column followed by a scatter of the deltas into the account totals.
+    // Initial and maintenance margin are gross notional times the instrument's
+    // init/maint_margin_pct, so they ride on the gross delta and an account's
+    // margin is never recomputed by walking its positions. Each account also
+    // keeps an intraday high-water mark of its equity, so its drawdown is O(1)
+    // to check after any fill or mark. The market-data thread
+    // only flags instruments in a per-shard dirty bitmap; the shard thread
+    // reprices them in reprice(), and sweep() reprices everything and rebuilds
+    // the account totals from scratch to bound accumulated rounding.
+    class MarkToMarketEngine {
+    public:
+        MarkToMarketEngine();
+
+        /// Shard thread: the fill changed pos; the instrument's reference price is
+        /// used as mark, else its last mark, else fallback_mark.
+        void onPosition(uint32_t account_id, uint32_t instrument_id, Position &pos, double fallback_mark);
+        /// Market-data thread: the instrument's reference price changed.
+        void onMarkChanged(uint32_t instrument_id);
+        /// Shard thread: reprice the instruments flagged since the last call; returns instruments repriced.
+        size_t reprice(int shard);
+        /// Shard thread: reprice every instrument and recompute the account totals.
+        void sweep(int shard);
+        /// Shard thread: f(account_id) for each account repriced since the last call.
+        template <typename F>
+        void drainRepricedAccounts(int shard_id, F &&f) {
+            Shard &shard = shards_[shard_id];
+            for (uint32_t w = 0; w < shard.account_words; ++w) {
+                uint64_t bits = shard.repriced[w];
+                shard.repriced[w] = 0;
+                while (bits) {
+                    uint32_t acct = w * 64 + __builtin_ctzll(bits);
+                    bits &= bits - 1;
+                    f(shard_layout.accountAt(shard_id, acct));
+                }
+            }
+        }
+        /// Drop every position, e.g. at session start. Not safe while shards run.
+        void clear();
+        /// Re-carve the per-shard state for shard_layout's capacities, dropping every
+        /// position. Not safe while shards run.
+        void resize(uint32_t shards, uint32_t accounts_per_shard);
+
+        /// initial_equity + realized + unrealized PnL over all the account's positions. Shard thread.
+        double equity(uint32_t account_id) const;
+        double unrealizedPnl(uint32_t account_id) const;
+        double realizedPnl(uint32_t account_id) const;
+        double initMargin(uint32_t account_id) const;
+        double maintMargin(uint32_t account_id) const;
+        /// Shard thread: raise the account's high-water mark to its current equity and
+        /// return the drawdown from the mark as a fraction; 0 while there is no positive mark.
+        double updateDrawdown(uint32_t account_id);
+        double highWaterMark(uint32_t account_id) const;
+        /// Session start: every account's high-water mark restarts at its current equity.
+        /// Not safe while shards run.
+        void resetHighWaterMarks();
+        /// Shard thread, at a session boundary: the same for the shard's accounts.
+        void resetHighWaterMarks(int shard);
+        /// Unrealized PnL of one position at its instrument's last mark.
+        double unrealizedPnl(uint32_t account_id, uint32_t instrument_id, const Position &pos) const;
+        double mark(int shard, uint32_t instrument_id) const { return shards_[shard].columns[instrument_id].mark; }
+        size_t positions(int shard) const;
+
+    private:
+        static constexpr int DIRTY_WORDS = (NUM_INSTRUMENTS + 63) / 64;
+
+        struct Columns {
+            std::vector<double> qty;
+            std::vector<double> entry;
+            std::vector<double> unrealized;
+            std::vector<double> gross;       // |qty| * mark
+            std::vector<double> realized;
+            std::vector<uint16_t> account;   // the account's slot in the shard
+            double mark = 0.0;
+        };
+        struct alignas(64) Shard {
+            std::atomic<uint64_t> dirty[DIRTY_WORDS];
+            std::vector<Columns> columns;
+            std::vector<double> delta;       // scratch for one column
+            std::vector<double> delta_gross;
+            // per-account columns by slot, carved from arena
+            ShardArena arena;
+            uint32_t accounts = 0;
+            uint32_t account_words = 0;
+            double *account_unrealized = nullptr;
+            double *account_realized = nullptr;
+            double *account_init_margin = nullptr;
+            double *account_maint_margin = nullptr;
+            double *account_peak = nullptr;          // intraday equity high-water mark
+            uint64_t *repriced = nullptr;
+        };
+
+        void repriceColumns(int shard_id, uint32_t instrument_id, double mark);
+        static void carve(Shard &shard, uint32_t accounts);
+        static void resetTotals(Shard &shard);
+        double equityAt(int shard_id, uint32_t acct) const;
+        /// One per-account column by account_id; 0 for an account without a slot.
+        double accountValue(uint32_t account_id, double *Shard::*column) const;
+
+        std::vector<Shard> shards_;
+    };
+
+    extern MarkToMarketEngine mark_to_market;
+}
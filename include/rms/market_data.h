@@ -0,0 +1,54 @@
+//
+// Created by muhammad-abdullah on 7/12/25.
+//
+
+// File: include/rms/market_data.hpp
+#pragma once
+#include "data_types.h"
+#include "vcm_module.h"
+
+namespace rms {
+    constexpr uint32_t MD_HAS_QUOTE = 1u << 0;
+    constexpr uint32_t MD_HAS_LAST  = 1u << 1;
+
+    // Wire format on the market-data stream: a type byte, then this struct
+    struct MarketDataUpdate {
+        uint64_t seq;             // feed sequence, increasing per instrument
+        uint32_t instrument_id;
+        uint32_t flags;           // MD_HAS_QUOTE | MD_HAS_LAST
+        double   bid;
+        double   ask;
+        double   last;
+        int64_t  last_qty;
+    };
+
+    // Latest-value-wins buffer between the market-data subscription and the
+    // price tables. offer() drops anything not newer than what was already seen
+    // for the instrument and overwrites the pending update in place, so a burst
+    // of N ticks for one instrument costs one table write on drain(). Nothing is
+    // queued: memory is one slot per instrument. Trades are the exception: they
+    // are added to the reference-price VWAP sums as they arrive, since a VWAP
+    // cannot be conflated. Market-data thread only.
+    class MarketDataConflator {
+    public:
+        MarketDataConflator();
+
+        /// False if the update is stale or for an unknown instrument.
+        bool offer(const MarketDataUpdate &update);
+        /// Publish each instrument's latest pending update and flag moved reference
+        /// prices for mark-to-market; returns instruments published.
+        size_t drain(VCMModule &vcm);
+
+        uint64_t staleDropped() const { return stale_; }
+        uint64_t conflated() const { return conflated_; }
+
+    private:
+        static constexpr int DIRTY_WORDS = (NUM_INSTRUMENTS + 63) / 64;
+
+        uint64_t last_seq_[NUM_INSTRUMENTS];
+        MarketDataUpdate pending_[NUM_INSTRUMENTS];
+        uint64_t dirty_[DIRTY_WORDS];
+        uint64_t stale_ = 0;
+        uint64_t conflated_ = 0;
+    };
+}
@@ -13,6 +13,9 @@
 #include <concurrent/AtomicBuffer.h>
 #include "data_types.h"      // For Order, TradeExecution, etc.
 #include "sharded_queue.h"
+#include "vcm_state.h"
+#include "market_data.h"
+#include "liquidation.h"
 #include "logger.h"
 #include "loggerwrapper.h"
 
@@ -36,13 +39,28 @@ namespace rms {
         /// Send a TradeExecution message out via Aeron Publication.
         bool sendTradeExecution(const TradeExecution& trade);
 
+        /// Publish a VCM state change on the VCM outbound stream.
+        bool sendVcmTransition(const VcmTransition& transition);
+
+        /// Drain up to MAX_MD_FRAGMENT_BATCH_SIZE market-data fragments into the conflator.
+        /// Called from the market-data thread; returns fragments read.
+        int pollMarketData(MarketDataConflator &conflator);
+
+        /// Publish queued liquidation orders of every shard; orders the publication
+        /// refuses are kept and retried first on the next call. Single caller thread.
+        int publishLiquidations(LiquidationEngine &engine);
+
         ///fragment handler
         aeron::fragment_handler_t fragHandler();
 
         ///get queue
-        std::array<ShardedQueue, NUM_SHARDS>& getQueue();
+        std::vector<ShardedQueue>& getQueue();
 
     private:
+        /// Shard owning the message: the account's shard for orders, trades, corrections and cancels;
+        /// -1 for anything else, including Orders of another schema version, which are dropped.
+        int shardFor(const aeron::AtomicBuffer &buffer, std::int32_t offset, std::int32_t length);
+
         /// Listener loop that polls Aeron Subscription.
         void listenerLoop();
 
@@ -55,14 +73,17 @@ namespace rms {
 
         std::shared_ptr<aeron::Aeron> aeron_;
         std::shared_ptr<aeron::Subscription> subscription_;
+        std::shared_ptr<aeron::Subscription> md_subscription_;
         std::shared_ptr<aeron::Publication> publication_;
+        std::shared_ptr<aeron::Publication> vcm_publication_;
+        std::shared_ptr<aeron::Publication> liquidation_publication_;
+        std::vector<LiquidationOrder> liquidation_backlog_;
 
-        std::array<ShardedQueue, NUM_SHARDS> sharded_queue;
+        std::vector<ShardedQueue> sharded_queue;     // one per shard_layout shard
 
         //log wrapper
         LoggerWrapper* logWrapper;
-
-        uint32_t _shard_counter = 3;
+        uint8_t log_id_ = 0;
     };
 
 }  // namespace rms
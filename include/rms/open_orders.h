@@ -0,0 +1,28 @@
+//
+// Created by muhammad-abdullah on 6/18/25.
+//
+
+// File: include/rms/open_orders.hpp
+#pragma once
+#include "data_types.h"
+
+namespace rms {
+    // Maintains open_order_store and the per (account, instrument) open_exposure_store
+    // accumulators so worst-case position checks stay O(1). Credit is reserved by
+    // the caller before onAccepted; fills and cancels give it back here.
+    class OpenOrderTracker {
+    public:
+        /// Record an accepted order; false if the id is already working.
+        bool onAccepted(const Order &order);
+        /// Release the filled quantity of the trade's order.
+        void onFill(const TradeExecution &trade);
+        /// Release whatever the order still had working; false if it was not open.
+        bool onCancel(uint32_t account_id, uint64_t order_id);
+
+        bool isOpen(uint32_t account_id, uint64_t order_id) const;
+        OpenExposure exposure(uint32_t account_id, uint32_t instrument_id) const;
+
+    private:
+        void release(int shard, const OpenOrder &open, int64_t qty);
+    };
+}
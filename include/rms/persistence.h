@@ -83,28 +83,26 @@ public:
      * @param shard_id The shard ID
      * @param limits The account limits to save
      */
-    void saveAccountLimits(int shard_id, const AccountLimitsShard& limits);
+    void saveAccountLimits(int shard_id, const AccountLimitTable& limits);
 
     /**
      * @brief Load account limits for a specific shard
      * @param shard_id The shard ID
      * @param limits The account limits to load into
      */
-    void loadAccountLimits(int shard_id, AccountLimitsShard& limits);
+    void loadAccountLimits(int shard_id, AccountLimitTable& limits);
 
     /**
-     * @brief Save instrument limits for a specific shard
-     * @param shard_id The shard ID
+     * @brief Save instrument limits, shared by all shards
      * @param limits The instrument limits to save
      */
-    void saveInstrumentLimits(int shard_id, const InstrumentLimitsShard& limits);
+    void saveInstrumentLimits(const InstrumentLimitTable& limits);
 
     /**
-     * @brief Load instrument limits for a specific shard
-     * @param shard_id The shard ID
+     * @brief Load instrument limits, shared by all shards
      * @param limits The instrument limits to load into
      */
-    void loadInstrumentLimits(int shard_id, InstrumentLimitsShard& limits);
+    void loadInstrumentLimits(InstrumentLimitTable& limits);
 
     /**
      * @brief Log an order for audit purposes
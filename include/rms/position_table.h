@@ -0,0 +1,134 @@
+//
+// Created by muhammad-abdullah on 7/16/25.
+//
+
+// File: include/rms/position_table.hpp
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <folly/container/F14Map.h>
+
+namespace rms {
+    // Positions (or any trivially copyable per-pair record) of one shard keyed by (account_id, instrument_id) packed into
+    // 64 bits. Open addressing with linear probing over a power-of-two key
+    // array (eight keys per cache line), with the Position for a key held in
+    // the same slot of a parallel value array, so a hit is one probe run plus
+    // one value line and no pointer chasing. Each account's positions are
+    // chained through their slots for iteration. Entries are never erased: a
+    // flat position stays until clear(), which is done per session. The pair
+    // (0xFFFFFFFF, 0xFFFFFFFF) packs to the empty key and cannot be stored;
+    // callers keep instrument_id below NUM_INSTRUMENTS, which rules it out.
+    // Single writer (the owning shard thread).
+    template <typename Value>
+    class FlatPositionTable {
+    public:
+        explicit FlatPositionTable(size_t initial_capacity = 1024) { rehash(roundUp(initial_capacity)); }
+
+        Value *find(uint32_t account_id, uint32_t instrument_id) {
+            size_t slot = probe(pack(account_id, instrument_id));
+            return keys_[slot] == EMPTY ? nullptr : &values_[slot];
+        }
+        const Value *find(uint32_t account_id, uint32_t instrument_id) const {
+            size_t slot = probe(pack(account_id, instrument_id));
+            return keys_[slot] == EMPTY ? nullptr : &values_[slot];
+        }
+
+        /// Existing position, or a default-constructed one inserted for the pair.
+        Value &findOrInsert(uint32_t account_id, uint32_t instrument_id) {
+            uint64_t key = pack(account_id, instrument_id);
+            size_t slot = probe(key);
+            if (keys_[slot] != EMPTY) return values_[slot];
+            if ((size_ + 1) * MAX_LOAD_DEN > capacity_ * MAX_LOAD_NUM) {
+                rehash(capacity_ * 2);
+                slot = probe(key);
+            }
+            keys_[slot] = key;
+            values_[slot] = Value{};
+            link(slot, account_id);
+            ++size_;
+            return values_[slot];
+        }
+
+        /// f(instrument_id, Value &) for every position of the account.
+        template <typename F>
+        void forEachOfAccount(uint32_t account_id, F &&f) {
+            auto it = heads_.find(account_id);
+            if (it == heads_.end()) return;
+            for (uint32_t slot = it->second; slot != NO_SLOT; slot = next_[slot]) {
+                f((uint32_t)keys_[slot], values_[slot]);
+            }
+        }
+
+        void clear() {
+            std::fill_n(keys_.get(), capacity_, EMPTY);
+            heads_.clear();
+            size_ = 0;
+        }
+        void reserve(size_t n) {
+            size_t cap = roundUp(n * MAX_LOAD_DEN / MAX_LOAD_NUM + 1);
+            if (cap > capacity_) rehash(cap);
+        }
+        size_t size() const { return size_; }
+        size_t capacity() const { return capacity_; }
+
+    private:
+        static constexpr uint64_t EMPTY = ~0ULL;          // account and instrument 0xFFFFFFFF, never stored
+        static constexpr uint32_t NO_SLOT = ~0u;
+        static constexpr size_t MAX_LOAD_NUM = 7;         // grow past 70% full
+        static constexpr size_t MAX_LOAD_DEN = 10;
+
+        static uint64_t pack(uint32_t account_id, uint32_t instrument_id) {
+            return ((uint64_t)account_id << 32) | instrument_id;
+        }
+        static size_t roundUp(size_t n) {
+            size_t cap = 16;
+            while (cap < n) cap <<= 1;
+            return cap;
+        }
+
+        size_t home(uint64_t key) const {
+            // Fibonacci hashing: the high bits of the product mix account and instrument
+            return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> shift_);
+        }
+        size_t probe(uint64_t key) const {
+            size_t mask = capacity_ - 1;
+            size_t slot = home(key);
+            while (keys_[slot] != key && keys_[slot] != EMPTY) slot = (slot + 1) & mask;
+            return slot;
+        }
+        void link(size_t slot, uint32_t account_id) {
+            auto [it, inserted] = heads_.try_emplace(account_id, (uint32_t)slot);
+            next_[slot] = inserted ? NO_SLOT : it->second;
+            it->second = (uint32_t)slot;
+        }
+
+        void rehash(size_t new_capacity) {
+            std::unique_ptr<uint64_t[]> old_keys = std::move(keys_);
+            std::unique_ptr<Value[]> old_values = std::move(values_);
+            size_t old_capacity = capacity_;
+            capacity_ = new_capacity;
+            shift_ = 64 - __builtin_ctzll(capacity_);
+            keys_.reset(new uint64_t[capacity_]);
+            values_.reset(new Value[capacity_]);
+            next_.reset(new uint32_t[capacity_]);
+            std::fill_n(keys_.get(), capacity_, EMPTY);
+            heads_.clear();
+            for (size_t i = 0; i < old_capacity; ++i) {
+                if (old_keys[i] == EMPTY) continue;
+                size_t slot = probe(old_keys[i]);
+                keys_[slot] = old_keys[i];
+                values_[slot] = old_values[i];
+                link(slot, (uint32_t)(old_keys[i] >> 32));
+            }
+        }
+
+        std::unique_ptr<uint64_t[]> keys_;
+        std::unique_ptr<Value[]> values_;
+        std::unique_ptr<uint32_t[]> next_;     // next slot of the same account
+        folly::F14FastMap<uint32_t, uint32_t> heads_;
+        size_t capacity_ = 0;
+        size_t size_ = 0;
+        uint32_t shift_ = 64;
+    };
+}
@@ -6,10 +6,33 @@
 #pragma once
 #include "data_types.h"
 #include "pretrade_checks.h"
+#include "open_orders.h"
+#include "trade_dedupe.h"
+#include "trade_ledger.h"
 
 namespace rms {
     class PostTradeControls {
     public:
-        void onTrade(const TradeExecution &trade);
+        /// False if the trade was already applied (a replayed drop-copy) or its instrument_id
+        /// is not below NUM_INSTRUMENTS; nothing changes then.
+        bool onTrade(const TradeExecution &trade);
+        /// A venue bust or correction of an earlier trade; false if the trade is unknown, already
+        /// busted, or the instrument_id is out of range.
+        bool onCorrection(const TradeCorrection &correction);
+        /// Forget the session's trade ids and lots at the session boundary. Open positions carry
+        /// over as one lot at their average price; busts of earlier trades are rejected after this.
+        void resetSession();
+        const TradeDeduplicator &dedupe() const { return dedupe_; }
+        const TradeLedger &ledger() const { return ledger_; }
+
+    private:
+        // limits, credit, marking, margin and VaR after pos changed; mark is the price to
+        // mark at until the instrument has a reference price
+        void onPositionChanged(uint32_t account_id, uint32_t instrument_id, Position &pos, double gross_before,
+                               double mark, uint64_t now_ms);
+
+        OpenOrderTracker open_orders_;
+        TradeDeduplicator dedupe_;
+        TradeLedger ledger_;
     };
 }
\ No newline at end of file
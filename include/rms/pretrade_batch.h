@@ -0,0 +1,62 @@
+//
+// Created by muhammad-abdullah on 6/12/25.
+//
+
+// File: include/rms/pretrade_batch.hpp
+#pragma once
+#include "data_types.h"
+#include "utils/params.h"
+
+namespace rms {
+    // Reject masks of one batch, one per check; bit i is the i-th gathered order.
+    struct BatchRejects {
+        uint64_t max_qty = 0;
+        uint64_t notional = 0;
+        uint64_t price_band = 0;
+        uint64_t position = 0;
+
+        uint64_t any() const { return max_qty | notional | price_band | position; }
+    };
+
+    // Order and limit fields laid out as SoA lanes so every check is a vector compare.
+    // Prices and notionals are in the instrument's FixedPrice units, so every lane is an integer.
+    struct PreTradeLanes {
+        alignas(64) int64_t qty[MAX_PRETRADE_BATCH_SIZE] = {};
+        alignas(64) int64_t max_qty[MAX_PRETRADE_BATCH_SIZE] = {};
+        alignas(64) int64_t notional[MAX_PRETRADE_BATCH_SIZE] = {};        // qty * price
+        alignas(64) int64_t max_notional[MAX_PRETRADE_BATCH_SIZE] = {};
+        alignas(64) int64_t price[MAX_PRETRADE_BATCH_SIZE] = {};
+        alignas(64) int64_t ref_price[MAX_PRETRADE_BATCH_SIZE] = {};
+        alignas(64) int64_t band[MAX_PRETRADE_BATCH_SIZE] = {};
+        alignas(64) int64_t position[MAX_PRETRADE_BATCH_SIZE] = {};     // worst case after the order
+        alignas(64) int64_t max_position[MAX_PRETRADE_BATCH_SIZE] = {};
+        uint32_t count = 0;
+    };
+
+    enum class BatchIsa : uint8_t { Scalar, Avx2, Avx512 };
+
+    // Stateless pre-trade screen over a burst of orders. Mirrors the scalar
+    // PreTradeChecks semantics; stateful checks still run per order afterwards.
+    // The position lane is a snapshot: accepts earlier in the same batch only
+    // add open quantity, so a snapshot reject is final but a pass is rechecked.
+    class PreTradeBatch {
+    public:
+        void clear() { lanes_.count = 0; }
+        bool full() const { return lanes_.count == MAX_PRETRADE_BATCH_SIZE; }
+        uint32_t size() const { return lanes_.count; }
+
+        /// Append an order; reference_price <= 0 means no band is applied.
+        void gather(const Order &order, double reference_price);
+
+        /// Evaluate with the best kernel the CPU supports.
+        BatchRejects evaluate() const;
+        BatchRejects evaluate(BatchIsa isa) const;
+
+        static BatchIsa detectIsa();
+        static bool isaSupported(BatchIsa isa);
+        static const char *isaName(BatchIsa isa);
+
+    private:
+        PreTradeLanes lanes_;
+    };
+}
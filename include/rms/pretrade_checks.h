@@ -10,7 +10,24 @@ namespace rms {
     class PreTradeChecks {
     public:
         bool checkMaxOrderQty(const Order &order);
+        bool checkMaxOrderNotional(const Order &order);
         bool checkPriceBand(const Order &order, double reference_price);
+        /// Band around the instrument's reference_prices value; passes while there is none.
+        bool checkPriceBand(const Order &order);
+        /// Positive and a whole number of the instrument's ticks.
+        bool checkTickSize(const Order &order);
         bool checkPositionLimit(const Order &order);
+        bool checkLimitTree(const Order &order);
+        bool checkRestricted(const Order &order);
+        /// Sells in hard-to-borrow names may only reduce a long, counting working sells.
+        bool checkShortSell(const Order &order);
+        /// Volume traded in the rolling window plus this order stays within the window limits.
+        bool checkWindowVolume(const Order &order, uint64_t now_ms);
+        /// Account initial margin after the order's worst case fills stays within equity.
+        /// Not enforced for accounts without an initial_equity.
+        bool checkInitialMargin(const Order &order);
+
+        /// Filled position plus all working orders on the order's side, including the order itself.
+        static int64_t worstCasePosition(const Order &order);
     };
 }
\ No newline at end of file
@@ -0,0 +1,76 @@
+//
+// Created by muhammad-abdullah on 7/28/25.
+//
+
+// File: include/rms/price_scale.hpp
+#pragma once
+#include <cstdint>
+#include "data_types.h"
+
+namespace rms {
+    // Decimal places and tick size of each instrument's FixedPrice. Orders and
+    // trades carry prices as integers, so tick, band and notional checks and
+    // the position ledger compare and add exactly; toDouble() is for the risk
+    // models (marking, margin, VaR) and limits kept in currency. Configure
+    // before the shards start; read-only afterwards.
+    class PriceScales {
+    public:
+        static constexpr uint8_t DEFAULT_DECIMALS = 4;
+        static constexpr uint8_t MAX_DECIMALS = 9;
+
+        PriceScales();
+
+        /// Also resets the instrument's tick to one unit; false for decimals > MAX_DECIMALS.
+        bool setDecimals(uint32_t instrument_id, uint8_t decimals);
+        /// False unless tick_size is a positive whole number of units at the instrument's decimals.
+        bool setTickSize(uint32_t instrument_id, double tick_size);
+        void clear();
+
+        uint8_t decimals(uint32_t instrument_id) const { return decimals_[instrument_id]; }
+        /// Units per currency unit, 10^decimals.
+        int64_t scale(uint32_t instrument_id) const { return scale_[instrument_id]; }
+        FixedPrice tick(uint32_t instrument_id) const { return tick_[instrument_id]; }
+
+        /// Nearest FixedPrice; the one rounding on the way in from market data or config.
+        FixedPrice toFixed(uint32_t instrument_id, double price) const {
+            return round(price * (double)scale_[instrument_id]);
+        }
+        /// Division rather than a multiply by 10^-decimals, so toFixed(toDouble(p)) == p.
+        double toDouble(uint32_t instrument_id, FixedPrice price) const {
+            return (double)price / (double)scale_[instrument_id];
+        }
+        /// quantity * price in currency, for limits kept as double.
+        double notional(uint32_t instrument_id, int64_t quantity, FixedPrice price) const {
+            return (double)((__int128)quantity * price) / (double)scale_[instrument_id];
+        }
+        /// quantity * price in units, saturated to +-INT64_MAX: both come off the wire and the
+        /// product of two in-range values overflows int64, so a saturated product fails every
+        /// notional limit instead of wrapping past it.
+        static int64_t notionalUnits(int64_t quantity, FixedPrice price) {
+            __int128 units = (__int128)quantity * price;
+            if (units > INT64_MAX) return INT64_MAX;
+            if (units < -(__int128)INT64_MAX) return -INT64_MAX;
+            return (int64_t)units;
+        }
+        /// A currency amount (e.g. a notional limit) in units of qty * price, to the nearest unit.
+        int64_t toUnits(uint32_t instrument_id, double amount) const {
+            return round(amount * (double)scale_[instrument_id]);
+        }
+        /// pct of price in whole units, rounded down. pct is read to parts per million, so
+        /// 0.29 of 100 is 29 and not the 28.999... of the double product.
+        static FixedPrice fraction(FixedPrice price, double pct) {
+            return price * round(pct * 1e6) / 1000000;
+        }
+        bool onTick(uint32_t instrument_id, FixedPrice price) const { return price % tick_[instrument_id] == 0; }
+
+    private:
+        // half away from zero like std::llround, which is a libm call on the check path
+        static int64_t round(double x) { return (int64_t)(x < 0.0 ? x - 0.5 : x + 0.5); }
+
+        uint8_t    decimals_[NUM_INSTRUMENTS];
+        int64_t    scale_[NUM_INSTRUMENTS];
+        FixedPrice tick_[NUM_INSTRUMENTS];
+    };
+
+    extern PriceScales price_scales;
+}
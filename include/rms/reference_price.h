@@ -0,0 +1,56 @@
+//
+// Created by muhammad-abdullah on 7/14/25.
+//
+
+// File: include/rms/reference_price.hpp
+#pragma once
+#include <atomic>
+#include <string>
+#include "data_types.h"
+
+namespace rms {
+    enum class RefPricePolicy : uint8_t { Mid, Last, Vwap, Settlement };
+
+    // Reference price per instrument for price bands and marking. The market-data
+    // thread maintains the inputs (mid, last, session VWAP sums) and publishes the
+    // value chosen by each instrument's policy; readers on any thread get it with
+    // one relaxed load. When the policy's input is missing the engine falls back
+    // Vwap -> Last -> Mid and Last <-> Mid; Settlement has no fallback.
+    class ReferencePriceEngine {
+    public:
+        ReferencePriceEngine();
+
+        /// Configuration; call before the market-data thread starts.
+        void setPolicy(uint32_t instrument_id, RefPricePolicy policy);
+        void setSettlement(uint32_t instrument_id, double price);
+        /// Start a new session: VWAP sums and last trades are cleared. Before the market-data
+        /// thread starts, or on it at a session_clock boundary.
+        void resetSession();
+
+        /// Market-data thread only. Every trade must be seen for VWAP to be exact.
+        void onTrade(uint32_t instrument_id, double price, int64_t qty);
+        void onQuote(uint32_t instrument_id, double bid, double ask);
+        /// Recompute and publish the instrument's reference price.
+        void publish(uint32_t instrument_id);
+
+        /// Current reference price, 0 if none is available.
+        double reference(uint32_t instrument_id) const {
+            return instrument_id < NUM_INSTRUMENTS ? ref_[instrument_id].load(std::memory_order_relaxed) : 0.0;
+        }
+        RefPricePolicy policy(uint32_t instrument_id) const { return policy_[instrument_id]; }
+        double vwap(uint32_t instrument_id) const;
+
+        static bool parsePolicy(const std::string &name, RefPricePolicy &policy);
+
+    private:
+        RefPricePolicy policy_[NUM_INSTRUMENTS];
+        double mid_[NUM_INSTRUMENTS];
+        double last_[NUM_INSTRUMENTS];
+        double settlement_[NUM_INSTRUMENTS];
+        double pv_sum_[NUM_INSTRUMENTS];     // session sum of price * qty
+        double qty_sum_[NUM_INSTRUMENTS];
+        std::atomic<double> ref_[NUM_INSTRUMENTS];
+    };
+
+    extern ReferencePriceEngine reference_prices;
+}
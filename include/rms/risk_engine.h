@@ -9,7 +9,11 @@
 #include "data_types.h"
 #include "messaging.h"
 #include "pretrade_checks.h"
+#include "pretrade_batch.h"
+#include "duplicate_filter.h"
+#include "open_orders.h"
 #include "posttrade_controls.h"
+#include "vcm_module.h"
 
 namespace rms
 {
@@ -40,18 +44,41 @@ namespace rms
     private:
         void runShard(int shard_id);
 
-        // Callback invoked by Messaging when a new Order arrives
+        // Market-data thread: sole writer of the L1, volatility and VCM tables;
+        // also publishes liquidation orders
+        void runMarketData();
+
+        // Screen a burst of drained orders with the vectorized checks
+        void onOrderBatch(const std::vector<Order> &orders, int shard_id);
+
+        // Sequential stage for an order that passed the batch screen
         void onOrderReceived(const Order &order, int shard_id);
 
         // Callback invoked by Messaging when a TradeExecution arrives
         void onTradeReceived(const TradeExecution &trade, int shard_id);
 
+        // A venue bust or correction of an earlier trade
+        void onCorrectionReceived(const TradeCorrection &correction, int shard_id);
+
+        // Release the working quantity of a cancelled order
+        void onCancelReceived(const OrderCancel &cancel, int shard_id);
+
         std::vector<std::thread> shard_threads_;
+        std::thread market_data_thread_;
         bool running_ = false;
 
-        // One PreTradeChecks and PostTradeControls per shard
-        PreTradeChecks pretrade_checks_[NUM_SHARDS];
-        PostTradeControls posttrade_controls_[NUM_SHARDS];
+        // One PreTradeChecks and PostTradeControls per shard, sized in initialize()
+        std::vector<PreTradeChecks> pretrade_checks_;
+        std::vector<PostTradeControls> posttrade_controls_;
+        // Spread and volatility checks; reads the shared l1_table
+        std::vector<VCMModule> vcm_;
+        VCMModule md_vcm_;
+        MarketDataConflator md_conflator_;
+        // Batch lanes, owned by the shard thread that drains them
+        std::vector<PreTradeBatch> pretrade_batch_;
+        // Replay detection on order_id, confirmed against open_order_store
+        std::vector<DuplicateOrderFilter> dup_filter_;
+        OpenOrderTracker open_orders_;
 
         // Messaging instance (wraps Aeron pub/sub)
         Messaging messaging_;
@@ -0,0 +1,94 @@
+//
+// Created by muhammad-abdullah on 6/26/25.
+//
+
+// File: include/rms/rule_engine.hpp
+#pragma once
+#include <string>
+#include <vector>
+#include "data_types.h"
+
+namespace rms {
+    constexpr int RULE_MAX_STACK = 16;
+
+    // Fields a rule expression may reference
+    enum class RuleVar : uint8_t {
+        OrderQty, OrderPrice, OrderNotional, OrderIsBuy,
+        PositionNetQty, PositionOpenBuy, PositionOpenSell,
+        LimitMaxOrderQty, LimitMaxOrderNotional, LimitMaxDailyPosition, LimitPriceTolerancePct,
+        AccountMaxLeverage, AccountMaxDrawdownPct, AccountEquity, AccountScenarioMargin, AccountVar,
+        Count
+    };
+
+    enum class RuleOp : uint8_t {
+        PushConst, PushVar,
+        Add, Sub, Mul, Div, Neg,
+        Lt, Le, Gt, Ge, Eq, Ne,
+        And, Or, Not,
+        Abs, Min, Max
+    };
+
+    struct RuleInstr {
+        RuleOp  op;
+        RuleVar var;
+        double  value;
+    };
+
+    // Values of every RuleVar for one order, filled once and shared by all rules
+    struct RuleContext {
+        double vars[(int)RuleVar::Count];
+    };
+
+    struct CompiledRule {
+        std::string name;
+        std::string source;
+        std::vector<RuleInstr> code;
+    };
+
+    struct RuleStats {
+        uint64_t evaluations = 0;
+        uint64_t rejects = 0;
+        uint64_t sampled = 0;         // evaluations that were timed
+        uint64_t sampled_cycles = 0;
+    };
+
+    // Custom pre-trade rules from config, e.g.
+    //   reject_if: "order.qty * order.price > 0.2 * limit.max_order_notional"
+    // compiled at load time to a postfix program run on a fixed stack, so
+    // evaluation never allocates. Stats are kept per shard; one in
+    // RULE_TIMING_SAMPLE evaluations is timed with the TSC.
+    class RuleSet {
+    public:
+        static constexpr uint32_t RULE_TIMING_SAMPLE = 16;
+
+        /// Compile and append a rule; on failure returns false and sets error.
+        bool addRule(const std::string &name, const std::string &expr, std::string &error);
+        void clear();
+        /// Stats for shard_layout's shard count; drops the counts. Not safe while shards run.
+        void resize(uint32_t shards);
+
+        /// Index of the first rule rejecting the order, -1 if all pass. Shard thread only.
+        int evaluate(const Order &order, int shard);
+
+        void bind(const Order &order, RuleContext &ctx) const;
+        static double run(const CompiledRule &rule, const RuleContext &ctx);
+        static bool compile(const std::string &expr, std::vector<RuleInstr> &code, std::string &error);
+
+        size_t size() const { return rules_.size(); }
+        const CompiledRule &rule(size_t idx) const { return rules_[idx]; }
+        /// Stats for one rule summed over all shards; read while shards run is approximate.
+        RuleStats stats(size_t idx) const;
+
+    private:
+        struct alignas(64) ShardStats {
+            std::vector<RuleStats> rules;
+            uint32_t tick = 0;
+        };
+
+        std::vector<CompiledRule> rules_;
+        uint32_t used_vars_ = 0;      // bitmask of RuleVar the rules read
+        std::vector<ShardStats> stats_ = std::vector<ShardStats>(ShardLayout::DEFAULT_SHARDS);
+    };
+
+    extern RuleSet custom_rules;
+}
@@ -0,0 +1,76 @@
+//
+// Created by muhammad-abdullah on 7/23/25.
+//
+
+// File: include/rms/scenario_margin.hpp
+#pragma once
+#include <vector>
+#include "data_types.h"
+
+namespace rms {
+    // SPAN-style portfolio margin: each instrument carries a precomputed vector
+    // of the P&L of one long unit under a fixed grid of price/volatility
+    // scenarios, and an account's risk array is the qty-weighted sum of those
+    // vectors over its positions, so offsetting positions net out scenario by
+    // scenario. The margin is the worst loss across the grid.
+    //
+    // A fill adds (new qty - old qty) times the instrument vector to the
+    // account's risk array, one 16-wide axpy. Positions are also kept per
+    // shard as (qty, account) columns by instrument, so recompute() rebuilds
+    // every risk array of a shard in one pass, and recomputeAll() does all
+    // shards in parallel after the vectors are reloaded.
+    class ScenarioMarginEngine {
+    public:
+        static constexpr int SCENARIOS = 16;
+
+        ScenarioMarginEngine();
+
+        /// P&L of one long unit under each of the SCENARIOS scenarios.
+        /// Not safe while shards run; follow with recomputeAll().
+        void setScenarios(uint32_t instrument_id, const double *pnl);
+        /// The standard 16 scenarios of a linear instrument: price moves of 0, +-1/3,
+        /// +-2/3 and +-1 price_scan, each with volatility up and down, then +-3 price_scan
+        /// with 35% of the loss covered. price_scan is per unit, in price terms.
+        void setLinearScenarios(uint32_t instrument_id, double price_scan);
+        const double *scenarios(uint32_t instrument_id) const { return vectors_[instrument_id].pnl; }
+
+        /// Shard thread: the fill changed pos.
+        void onPosition(uint32_t account_id, uint32_t instrument_id, Position &pos);
+        /// Shard thread: rebuild the shard's risk arrays from its positions.
+        void recompute(int shard);
+        /// Every shard's recompute() on its own thread. Not safe while shards run.
+        void recomputeAll();
+        /// Drop every position, e.g. at session start. Not safe while shards run.
+        void clear();
+        /// Re-carve the risk arrays for shard_layout's capacities, dropping every
+        /// position. Not safe while shards run.
+        void resize(uint32_t shards, uint32_t accounts_per_shard);
+
+        /// Worst-case loss over the scenario grid, 0 if no scenario loses. Shard thread.
+        double scenarioMargin(uint32_t account_id) const;
+        /// The account's P&L under each scenario; all zero for an account without a slot.
+        const double *riskArray(uint32_t account_id) const;
+        size_t positions(int shard) const;
+
+    private:
+        struct alignas(64) Vector {
+            double pnl[SCENARIOS];
+        };
+        struct Columns {
+            std::vector<double> qty;
+            std::vector<uint16_t> account;   // the account's slot in the shard
+        };
+        struct alignas(64) Shard {
+            std::vector<Columns> columns;
+            ShardArena arena;
+            uint32_t accounts = 0;
+            Vector *risk = nullptr;          // by slot, carved from arena
+        };
+
+        std::vector<Vector> vectors_;
+        std::vector<Shard> shards_;
+        Vector no_risk_{};
+    };
+
+    extern ScenarioMarginEngine scenario_margin;
+}
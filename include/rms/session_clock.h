@@ -0,0 +1,41 @@
+//
+// Created by muhammad-abdullah on 7/31/25.
+//
+
+// File: include/rms/session_clock.hpp
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace rms {
+    struct SessionParams {
+        bool     daily = false;        // false: one engine run is one session
+        uint32_t start_utc_ms = 0;     // offset into the UTC day at which a session starts
+    };
+
+    // Numbers trading sessions so each thread can notice a boundary on its own
+    // loop and reset the session state it owns: the market-data thread its
+    // VWAP and last-trade sums, every shard the high-water marks of its
+    // accounts. A session runs from start_utc on one day to start_utc on the
+    // next. Read-only once the threads start.
+    class SessionClock {
+    public:
+        static constexpr uint64_t DAY_MS = 24ull * 3600 * 1000;
+
+        void init(const SessionParams &params) { params_ = params; }
+        /// Session of wall-clock time wall_ms (ms since the epoch); always 0 unless daily.
+        uint64_t session(uint64_t wall_ms) const {
+            if (!params_.daily) return 0;
+            return (wall_ms + DAY_MS - params_.start_utc_ms) / DAY_MS;
+        }
+        const SessionParams &params() const { return params_; }
+
+        /// "HH:MM" or "HH:MM:SS" to ms into the day; false if malformed.
+        static bool parseTimeOfDay(const std::string &text, uint32_t &ms);
+
+    private:
+        SessionParams params_;
+    };
+
+    extern SessionClock session_clock;
+}
@@ -0,0 +1,99 @@
+//
+// Created by muhammad-abdullah on 7/30/25.
+//
+
+// File: include/rms/shard_layout.hpp
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+#include <folly/container/F14Map.h>
+
+namespace rms {
+    // One shard's per-account columns of a module carved from a single
+    // allocation sized at startup. Dropped and re-carved as a whole, never
+    // freed piecemeal.
+    class ShardArena {
+    public:
+        static constexpr size_t ALIGN = 64;
+
+        /// Drops everything carved so far and allocates one block of at least bytes.
+        void reset(size_t bytes);
+        /// n zeroed Ts, 64-byte aligned; nullptr once the block is used up.
+        template <typename T>
+        T *take(size_t n) {
+            size_t bytes = (n * sizeof(T) + ALIGN - 1) & ~(ALIGN - 1);
+            if (used_ + bytes > size_) return nullptr;
+            T *p = reinterpret_cast<T *>(block_.get() + used_);
+            used_ += bytes;
+            return p;
+        }
+        /// Bytes reset() needs for n Ts of each of the given sizes.
+        static size_t bytesFor(size_t n, std::initializer_list<size_t> sizes) {
+            size_t bytes = 0;
+            for (size_t size : sizes) bytes += (n * size + ALIGN - 1) & ~(ALIGN - 1);
+            return bytes;
+        }
+        size_t used() const { return used_; }
+        size_t capacity() const { return size_; }
+
+    private:
+        struct Free {
+            void operator()(std::byte *p) const { std::free(p); }
+        };
+        std::unique_ptr<std::byte[], Free> block_;
+        size_t size_ = 0;
+        size_t used_ = 0;
+    };
+
+    // Shard count and per-shard account capacity, from the engine config's
+    // sharding section (ConfigLoader::configureShards) before the shards start.
+    // An account lives on shard account_id % shards() and gets the next free
+    // dense slot there the first time it is assigned, so per-account columns
+    // are indexed by slot and two accounts never share one. A shard's accounts
+    // are assigned by config load and that shard's thread only.
+    class ShardLayout {
+    public:
+        static constexpr uint32_t DEFAULT_SHARDS = 4;
+        static constexpr uint32_t DEFAULT_ACCOUNTS_PER_SHARD = 256;
+        static constexpr uint32_t MAX_SHARDS = 64;
+        // module columns keep the slot in 16 bits
+        static constexpr uint32_t MAX_ACCOUNTS_PER_SHARD = 65536;
+        static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+        ShardLayout() { configure(DEFAULT_SHARDS, DEFAULT_ACCOUNTS_PER_SHARD); }
+
+        /// Forgets every assigned slot; false if a count is 0 or above its maximum.
+        bool configure(uint32_t shards, uint32_t accounts_per_shard);
+
+        uint32_t shards() const { return shards_; }
+        uint32_t accountsPerShard() const { return accounts_per_shard_; }
+        uint32_t shardOf(uint32_t account_id) const { return account_id % shards_; }
+
+        /// The account's slot in its shard, NO_SLOT if it has none yet.
+        uint32_t slot(uint32_t account_id) const {
+            const auto &slots = directories_[shardOf(account_id)].slots;
+            auto it = slots.find(account_id);
+            return it == slots.end() ? NO_SLOT : it->second;
+        }
+        /// slot(), giving the account the next free one first; NO_SLOT when its shard is full.
+        uint32_t assign(uint32_t account_id);
+        uint32_t accountAt(int shard, uint32_t slot) const { return directories_[shard].accounts[slot]; }
+        uint32_t assigned(int shard) const { return (uint32_t)directories_[shard].accounts.size(); }
+
+    private:
+        struct Directory {
+            folly::F14FastMap<uint32_t, uint32_t> slots;    // account_id -> slot
+            std::vector<uint32_t> accounts;                 // slot -> account_id
+        };
+
+        uint32_t shards_ = 0;
+        uint32_t accounts_per_shard_ = 0;
+        std::vector<Directory> directories_;
+    };
+
+    extern ShardLayout shard_layout;
+}
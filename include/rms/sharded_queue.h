@@ -14,12 +14,25 @@
 
 #endif //SHARDED_QUEUE_H
 
+// Type byte leading an inbound trade, correction or cancel frame; the struct
+// follows it. Orders arrive as SBE instead.
+constexpr uint8_t TRADE_MSG_TYPE = 2;
+constexpr uint8_t TRADE_CORRECTION_MSG_TYPE = 6;
+constexpr uint8_t ORDER_CANCEL_MSG_TYPE = 7;
+
+using InboundMessage = std::variant<Order, TradeExecution, TradeCorrection, OrderCancel>;
+
+// True for an SBE Order this build can decode: the Order template of our schema, at the
+// schema version the codec was generated from, and long enough for the fixed block. A
+// frame of another version is dropped, never read with this version's field layout.
+bool isCurrentOrderFrame(const aeron::concurrent::AtomicBuffer &buffer, int32_t offset, int32_t length);
+
 class ShardedQueue {
     public:
     ShardedQueue();
     ~ShardedQueue();
     void enqueue(aeron::concurrent::AtomicBuffer, int32_t, int32_t);
-    std::optional<std::variant<Order, TradeExecution>> dequeue();
+    std::optional<InboundMessage> dequeue();
     int size();
     private:
     std::array<uint8_t, MAX_RING_BUFFER_SIZE + aeron::concurrent::ringbuffer::RingBufferDescriptor::TRAILER_LENGTH> buffer;
@@ -0,0 +1,60 @@
+//
+// Created by muhammad-abdullah on 7/25/25.
+//
+
+// File: include/rms/trade_dedupe.hpp
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace rms {
+    struct TradeDedupeParams {
+        uint32_t window = 1u << 16;      // trade ids per venue tracked by the bitmap (power of two)
+    };
+
+    enum class TradeSeen : uint8_t {
+        New,            // inside the window and not seen: apply
+        Duplicate,      // inside the window and seen: drop
+        Unknown         // below the window, or an untracked venue: ask the ledger
+    };
+
+    // Drops trades already applied, so a drop-copy replayed after a reconnect
+    // or at startup cannot double positions. Each venue numbers its trades, so
+    // trade_id is read as a per-venue sequence: a bitmap over the most recent
+    // `window` ids answers in one bit test, which covers a replay of the
+    // recent tail. One instance per shard, so it only sees the ids of its own
+    // accounts and the window has holes where other shards' trades went; that
+    // is why nothing is inferred from a hole once the window has passed it.
+    // Below the window the answer is Unknown and the caller checks the exact
+    // set of the day's trade ids in its TradeLedger: a trade is never dropped
+    // unless it was seen. trade_id 0 means the source assigns no ids and is
+    // always New.
+    class TradeDeduplicator {
+    public:
+        static constexpr uint32_t MAX_VENUES = 256;
+
+        explicit TradeDeduplicator(const TradeDedupeParams &params = TradeDedupeParams{});
+
+        /// Records (venue_id, trade_id) unless it is a Duplicate.
+        TradeSeen check(uint16_t venue_id, uint64_t trade_id);
+        void clear();
+
+        uint64_t duplicates() const { return duplicates_; }
+        /// Trades below the window or from venue ids >= MAX_VENUES, left to the ledger.
+        uint64_t unknown() const { return unknown_; }
+
+    private:
+        struct Venue {
+            std::vector<uint64_t> bits;  // ring over [base, base + window), indexed by id & (window - 1)
+            uint64_t base = 0;
+        };
+
+        void slide(Venue &venue, uint64_t new_base);
+
+        TradeDedupeParams params_;
+        std::vector<Venue> venues_;
+        uint64_t duplicates_ = 0;
+        uint64_t unknown_ = 0;
+    };
+}
@@ -0,0 +1,82 @@
+//
+// Created by muhammad-abdullah on 7/26/25.
+//
+
+// File: include/rms/trade_ledger.hpp
+#pragma once
+#include <deque>
+#include <vector>
+#include "data_types.h"
+
+namespace rms {
+    // The lots behind each position of a shard, kept so a venue bust or
+    // correction can take back one trade without replaying the day.
+    //
+    // A fill closes the oldest opposite lots first (FIFO) and opens a lot with
+    // what is left; each trade remembers the lot pieces it closed, with the PnL
+    // they realized, and each lot remembers the trades that closed parts of
+    // it. Busting a trade drops what is left of its own lot, puts back the
+    // pieces it closed at the front of the queue, and re-applies the trades
+    // that had closed its lot as if it had never existed. The cost is the
+    // lots and pieces touched, not the number of trades of the day. Costs and
+    // PnL are summed in FixedPrice units, exactly; the position's net_qty,
+    // avg_entry_price (of the open lots) and realized_pnl are derived from
+    // them after every change. One instance per shard.
+    class TradeLedger {
+    public:
+        /// Apply the fill to pos.
+        void onFill(const TradeExecution &trade, Position &pos);
+        /// Reverse the trade's effect on pos; false if the trade is unknown, already busted,
+        /// or belongs to another position.
+        bool bust(uint16_t venue_id, uint64_t trade_id, uint32_t account_id, uint32_t instrument_id, Position &pos);
+        /// Bust the trade, then apply it again at quantity and price on its original side.
+        bool correct(uint16_t venue_id, uint64_t trade_id, uint32_t account_id, uint32_t instrument_id,
+                     int64_t quantity, FixedPrice price, Position &pos);
+        /// Forget every lot and trade, e.g. at session start.
+        void clear();
+
+        /// True if a fill with this (venue_id, trade_id) was applied since the last clear().
+        bool applied(uint16_t venue_id, uint64_t trade_id) const { return ids_.contains(idKey(venue_id, trade_id)); }
+        size_t openLots(uint32_t account_id, uint32_t instrument_id) const;
+        size_t trades() const { return records_.size(); }
+
+    private:
+        struct Lot {
+            uint32_t record;            // trade that opened it
+            int64_t  qty;               // signed, what is still open
+            FixedPrice price;
+        };
+        struct Piece {
+            uint32_t lot;               // record of the lot closed
+            int64_t  qty;               // signed like the lot
+            FixedPrice lot_price;
+            int64_t  pnl;               // units of qty * price
+        };
+        struct Book {
+            std::deque<Lot> lots;       // oldest first, all on one side
+            int64_t net = 0;
+            int64_t cost = 0;           // sum of qty * price over the lots
+            int64_t realized = 0;       // units of qty * price, since the book opened
+            double  realized_base = 0.0;    // the position's realized_pnl when the book opened
+        };
+        struct Record {
+            uint64_t position;          // positionKey(account_id, instrument_id)
+            int64_t  qty;               // signed
+            FixedPrice price;
+            std::vector<Piece> closed;
+            std::vector<std::pair<uint32_t, int64_t>> closed_by;   // (closing record, qty of this lot)
+            bool     busted = false;
+        };
+
+        Book &bookFor(uint32_t account_id, uint32_t instrument_id, Position &pos);
+        uint32_t addRecord(uint64_t position, int64_t qty, FixedPrice price);
+        void apply(Book &book, uint32_t record, int64_t qty, FixedPrice price, bool reopen);
+        void unwind(Book &book, uint32_t record);
+        static void sync(const Book &book, uint32_t instrument_id, Position &pos);
+        static uint64_t idKey(uint16_t venue_id, uint64_t trade_id) { return (uint64_t)venue_id << 48 | trade_id; }
+
+        folly::F14FastMap<uint64_t, Book> books_;          // by positionKey
+        folly::F14FastMap<uint64_t, uint32_t> ids_;        // (venue_id, trade_id) -> record
+        std::vector<Record> records_;
+    };
+}
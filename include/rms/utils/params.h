@@ -8,4 +8,16 @@
 #endif //PARAMS_H
 
 #define MAX_RING_BUFFER_SIZE 4096
-#define MAX_FRAGMENT_BATCH_SIZE 10
\ No newline at end of file
+#define MAX_FRAGMENT_BATCH_SIZE 10
+// upper bound of orders screened together; reject masks are one bit per order
+#define MAX_PRETRADE_BATCH_SIZE 64
+// market-data fragments drained per poll before the conflated state is published
+#define MAX_MD_FRAGMENT_BATCH_SIZE 256
+// full mark-to-market recompute per shard, on top of the per-tick repricing
+#define MTM_SWEEP_INTERVAL_MS 1000
+// per-shard ring of liquidation orders waiting for the publisher (power of two)
+#define LIQUIDATION_RING_BUFFER_SIZE 65536
+// historical VaR: a shard starts a rebuild at current marks this often...
+#define VAR_RECOMPUTE_INTERVAL_MS 5000
+// ...and rebuilds about this many positions between bursts of orders
+#define VAR_RECOMPUTE_SLICE 256
@@ -5,10 +5,26 @@
 // File: include/rms/utils/time_utils.hpp
 #pragma once
 #include <chrono>
+#include <ctime>
 
 namespace rms::utils {
     inline uint64_t nowMs() {
         return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
             std::chrono::high_resolution_clock::now().time_since_epoch()).count();
     }
-}
\ No newline at end of file
+
+    // Monotonic, tick-resolution (1-4 ms) clock read from the vDSO without a
+    // hardware timer access; good enough for bucketing and expiry.
+    inline uint64_t coarseNowMs() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+        return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+    }
+
+    // Monotonic nanoseconds, comparable across threads; for latency metrics.
+    inline uint64_t nowNs() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+    }
+}
@@ -10,8 +10,16 @@
 namespace rms {
     class VCMModule {
     public:
+        /// Market-data thread only: publishes the quote to l1_table.
         void onMarketData(uint32_t instrument_id, double best_bid, double best_ask);
+        void onLastTrade(uint32_t instrument_id, double price);
+        /// Market-data thread only: advance VCM cooling-off timers.
+        void onTimer(uint64_t now_ms);
+        /// Quoted spread in whole ticks is within max_spread_ticks; passes with no two-sided quote.
         bool checkSpread(const Order &order);
+        /// Instrument's tick volatility and short-window range are inside their bands.
         bool checkVolatility(const Order &order);
+        /// Rejects while the instrument's VCM is triggered, and outside the band while cooling off.
+        bool checkTradingState(const Order &order);
     };
 }
\ No newline at end of file
@@ -0,0 +1,74 @@
+//
+// Created by muhammad-abdullah on 7/10/25.
+//
+
+// File: include/rms/vcm_state.hpp
+#pragma once
+#include <atomic>
+#include <functional>
+#include <vector>
+#include "data_types.h"
+#include "volatility.h"
+
+namespace rms {
+    enum class VcmState : uint8_t { Normal = 0, Triggered = 1, CoolingOff = 2, Resumed = 3 };
+
+    struct VcmParams {
+        uint32_t halt_ms = 30000;           // Triggered: no orders accepted
+        uint32_t cooling_ms = 120000;       // CoolingOff: orders only near the reference price
+        uint32_t resumed_ms = 60000;        // Resumed: normal trading, back to Normal if calm
+        double   cooling_band_pct = 0.02;
+    };
+
+    // Wire format of a state change on the VCM outbound stream
+    struct VcmTransition {
+        uint64_t ts_ms;
+        uint32_t instrument_id;
+        VcmState from;
+        VcmState to;
+        double   reference_price;
+    };
+
+    using VcmTransitionHandler = std::function<void(const VcmTransition &)>;
+
+    // Exchange-style volatility control per instrument:
+    //   Normal -> Triggered     volatility band breached
+    //   Triggered -> CoolingOff halt_ms elapsed
+    //   CoolingOff -> Resumed   cooling_ms elapsed (a mid outside the band re-triggers)
+    //   Resumed -> Normal       resumed_ms elapsed (a breach re-triggers)
+    // Driven from the market-data thread by quotes and a coarse timer; that thread
+    // is the only writer. The state is published as one byte per instrument so a
+    // shard rejects orders in a halted instrument with a single load.
+    class VcmStateMachine {
+    public:
+        VcmStateMachine() { init(VcmParams{}); }
+
+        void init(const VcmParams &params);
+        /// Called for every transition on the market-data thread; keep it short.
+        void setTransitionHandler(VcmTransitionHandler handler) { handler_ = std::move(handler); }
+
+        void onMarketData(uint32_t instrument_id, double mid, VolState vol, uint64_t now_ms);
+        /// Fire expired timers; cost is proportional to instruments outside Normal.
+        void onTimer(uint64_t now_ms);
+
+        VcmState state(uint32_t instrument_id) const {
+            return (VcmState)state_[instrument_id].load(std::memory_order_acquire);
+        }
+        double referencePrice(uint32_t instrument_id) const {
+            return ref_price_[instrument_id].load(std::memory_order_relaxed);
+        }
+        double coolingBandPct() const { return params_.cooling_band_pct; }
+
+    private:
+        void transition(uint32_t instrument_id, VcmState to, double ref, uint64_t now_ms);
+
+        VcmParams params_;
+        VcmTransitionHandler handler_;
+        std::atomic<uint8_t> state_[NUM_INSTRUMENTS];
+        std::atomic<double> ref_price_[NUM_INSTRUMENTS];
+        uint64_t deadline_[NUM_INSTRUMENTS];
+        std::vector<uint32_t> active_;      // instruments not in Normal
+    };
+
+    extern VcmStateMachine vcm_states;
+}
@@ -0,0 +1,61 @@
+//
+// Created by muhammad-abdullah on 7/8/25.
+//
+
+// File: include/rms/volatility.hpp
+#pragma once
+#include <atomic>
+#include "data_types.h"
+
+namespace rms {
+    enum class VolState : uint8_t { Normal = 0, Breach = 1 };
+
+    struct VolatilityParams {
+        double   ewma_lambda = 0.94;    // per-tick decay of squared log returns
+        uint32_t range_ms = 1000;       // high/low window is 1-2x this long
+    };
+
+    // Per-instrument volatility estimators updated in O(1) on every quote:
+    //   - EWMA of squared mid log returns (per-tick volatility)
+    //   - high/low range of the mid over a short window, relative to the mid
+    // Estimator state and bands are stored column-wise so recompute() over all
+    // instruments vectorizes. The market-data thread is the only writer; shard
+    // threads read just the published one-byte state.
+    class VolatilityTable {
+    public:
+        VolatilityTable();
+
+        void init(const VolatilityParams &params);
+        /// 0 disables a band.
+        void setBands(uint32_t instrument_id, double max_tick_vol, double max_range_pct);
+
+        /// Market-data thread only.
+        void onQuote(uint32_t instrument_id, double mid, uint64_t now_ms);
+        /// Re-derive every instrument's state from its estimators, e.g. after the bands change.
+        void recompute();
+
+        VolState state(uint32_t instrument_id) const {
+            return (VolState)state_[instrument_id].load(std::memory_order_relaxed);
+        }
+        double tickVol(uint32_t instrument_id) const;
+        double rangePct(uint32_t instrument_id) const;
+
+    private:
+        static bool breached(double ewma_var, double max_var, double range, double max_range);
+
+        double lambda_ = 0.94;
+        uint32_t range_ms_ = 1000;
+        alignas(64) double last_mid_[NUM_INSTRUMENTS];
+        alignas(64) double ewma_var_[NUM_INSTRUMENTS];
+        alignas(64) double cur_high_[NUM_INSTRUMENTS];
+        alignas(64) double cur_low_[NUM_INSTRUMENTS];
+        alignas(64) double prev_high_[NUM_INSTRUMENTS];
+        alignas(64) double prev_low_[NUM_INSTRUMENTS];
+        alignas(64) uint64_t bucket_[NUM_INSTRUMENTS];
+        alignas(64) double max_var_[NUM_INSTRUMENTS];     // squared tick-vol band
+        alignas(64) double max_range_[NUM_INSTRUMENTS];
+        alignas(64) std::atomic<uint8_t> state_[NUM_INSTRUMENTS];
+    };
+
+    extern VolatilityTable volatility_table;
+}
@@ -0,0 +1,78 @@
+//
+// Created by muhammad-abdullah on 7/2/25.
+//
+
+// File: include/rms/volume_windows.hpp
+#pragma once
+#include <memory>
+#include <vector>
+#include "data_types.h"
+
+namespace rms {
+    struct VolumeWindowParams {
+        uint32_t window_ms = 300000;      // 5 minutes
+        uint32_t buckets = 30;            // 10 s resolution
+        uint32_t rings_per_block = 256;   // pool growth step per shard
+    };
+
+    struct WindowVolume {
+        int64_t qty = 0;
+        double  notional = 0.0;
+    };
+
+    // Traded volume per (account, instrument) over a rolling window, kept as a
+    // ring of fixed time buckets that is advanced lazily on access. Rings are
+    // handed out from a per-shard pool on the first trade of a pair and returned
+    // by reclaim() once they have been idle for a whole window, so memory tracks
+    // the pairs active in the window rather than every pair ever traded.
+    // Each shard's rings are only touched by that shard's thread.
+    class VolumeWindows {
+    public:
+        VolumeWindows() { init(VolumeWindowParams{}); }
+
+        /// Drop all rings and re-size buckets.
+        void init(const VolumeWindowParams &params);
+        /// One ring pool per shard of shard_layout; drops all rings.
+        void resize(uint32_t shards);
+
+        void onTrade(uint32_t account_id, uint32_t instrument_id, int64_t qty, double notional, uint64_t now_ms);
+        /// Volume traded inside the window ending at now_ms; zero if the pair has no ring.
+        WindowVolume volume(uint32_t account_id, uint32_t instrument_id, uint64_t now_ms);
+        /// Return idle rings to the pool, scanning at most max_rings. Shard thread only.
+        size_t reclaim(int shard, uint64_t now_ms, size_t max_rings);
+
+        size_t ringsInUse(int shard) const { return shards_[shard].index.size(); }
+        size_t ringsAllocated(int shard) const { return shards_[shard].headers.size(); }
+        uint32_t bucketMs() const { return bucket_ms_; }
+
+    private:
+        struct Bucket {
+            int64_t qty;
+            double  notional;
+        };
+        struct RingHeader {
+            uint64_t key;
+            uint64_t last_bucket;    // absolute bucket number of the newest slot
+            WindowVolume total;
+            bool     in_use;
+        };
+        struct alignas(64) Shard {
+            folly::F14FastMap<uint64_t, uint32_t> index;
+            std::vector<RingHeader> headers;
+            std::vector<std::unique_ptr<Bucket[]>> blocks;
+            std::vector<uint32_t> free;
+            size_t cursor = 0;
+        };
+
+        uint32_t acquire(Shard &shard, uint64_t key, uint64_t bucket);
+        Bucket *slots(Shard &shard, uint32_t ring) const;
+        void advance(Shard &shard, uint32_t ring, uint64_t bucket);
+
+        uint32_t buckets_ = 0;
+        uint32_t bucket_ms_ = 0;
+        uint32_t rings_per_block_ = 0;
+        std::vector<Shard> shards_ = std::vector<Shard>(ShardLayout::DEFAULT_SHARDS);
+    };
+
+    extern VolumeWindows volume_windows;
+}
@@ -5,15 +5,264 @@
 #include "config_loader.h"
 #include <yaml-cpp/yaml.h>
 #include "data_types.h"
+#include "limit_tree.h"
+#include "credit_manager.h"
+#include "rule_engine.h"
+#include "instrument_lists.h"
+#include "volume_windows.h"
+#include "liquidation.h"
+#include "session_clock.h"
+#include "l1_table.h"
+#include "volatility.h"
+#include "vcm_state.h"
+#include "reference_price.h"
+#include "scenario_margin.h"
+#include "historical_var.h"
+#include "price_scale.h"
+#include "mark_to_market.h"
+#include <cmath>
 #include <iostream>
 
+namespace {
+    bool loadLimitTree(const YAML::Node &nodes) {
+        rms::limit_tree.clear();
+        for (const auto &node : nodes) {
+            std::string name = node["name"].as<std::string>();
+            rms::LimitLevel level;
+            if (!rms::LimitTree::parseLevel(node["level"].as<std::string>("desk"), level)) {
+                std::cerr << "Unknown limit level for node " << name << std::endl;
+                return false;
+            }
+            int32_t parent = -1;
+            if (node["parent"]) {
+                parent = rms::limit_tree.findNode(node["parent"].as<std::string>());
+                if (parent < 0) {
+                    std::cerr << "Limit node " << name << " references an undefined parent" << std::endl;
+                    return false;
+                }
+            }
+            int32_t idx = rms::limit_tree.addNode(name, level, parent, node["max_gross_notional"].as<double>());
+            if (idx < 0) {
+                std::cerr << "Limit node " << name << " exceeds depth " << rms::MAX_LIMIT_DEPTH << std::endl;
+                return false;
+            }
+            for (const auto &account : node["accounts"]) {
+                rms::limit_tree.assignAccount(account.as<uint32_t>(), idx);
+            }
+        }
+        rms::limit_tree.finalize();
+        return true;
+    }
+
+    bool loadCreditLines(const YAML::Node &lines) {
+        rms::credit_manager.clear();
+        for (const auto &line : lines) {
+            std::string name = line["name"].as<std::string>();
+            double limit = line["limit"].as<double>();
+            int32_t idx = rms::credit_manager.addLine(name, limit, line["slice"].as<double>(limit / (4.0 * rms::shard_layout.shards())));
+            for (const auto &account : line["accounts"]) {
+                rms::credit_manager.assignAccount(account.as<uint32_t>(), idx);
+            }
+        }
+        rms::credit_manager.finalize();
+        return true;
+    }
+
+    bool loadRules(const YAML::Node &rules) {
+        rms::custom_rules.clear();
+        for (const auto &rule : rules) {
+            std::string name = rule["name"].as<std::string>();
+            std::string error;
+            if (!rms::custom_rules.addRule(name, rule["reject_if"].as<std::string>(), error)) {
+                std::cerr << "Rule " << name << ": " << error << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
 bool rms::ConfigLoader::loadConfig(const std::string &filepath) {
     try {
         YAML::Node config = YAML::LoadFile(filepath);
         std::cout << "Loaded config from " << filepath << std::endl;
+        if (const auto &sharding = config["sharding"]) {
+            if (!configureShards(sharding["count"].as<uint32_t>(ShardLayout::DEFAULT_SHARDS),
+                                 sharding["accounts_per_shard"].as<uint32_t>(ShardLayout::DEFAULT_ACCOUNTS_PER_SHARD))) {
+                return false;
+            }
+        }
+        if (config["risk_limits"] && config["risk_limits"]["limits_file"]) {
+            return loadRiskConfig(config["risk_limits"]["limits_file"].as<std::string>());
+        }
         return true;
     } catch (const std::exception &e) {
         std::cerr << "Failed to load config: " << e.what() << std::endl;
         return false;
     }
 }
+
+bool rms::ConfigLoader::configureShards(uint32_t shards, uint32_t accounts_per_shard) {
+    if (!shard_layout.configure(shards, accounts_per_shard)) {
+        std::cerr << "sharding.count must be 1.." << ShardLayout::MAX_SHARDS << " and accounts_per_shard 1.."
+                  << ShardLayout::MAX_ACCOUNTS_PER_SHARD << std::endl;
+        return false;
+    }
+    resizeShardTables(shards, accounts_per_shard);
+    mark_to_market.resize(shards, accounts_per_shard);
+    scenario_margin.resize(shards, accounts_per_shard);
+    historical_var.resize(shards, accounts_per_shard);
+    liquidations.resize(shards, accounts_per_shard);
+    volume_windows.resize(shards);
+    custom_rules.resize(shards);
+    std::cout << "Sharding: " << shards << " shards of " << accounts_per_shard << " accounts" << std::endl;
+    return true;
+}
+
+bool rms::ConfigLoader::loadRiskConfig(const std::string &filepath) {
+    try {
+        YAML::Node config = YAML::LoadFile(filepath);
+        for (const auto &inst : config["instruments"]) {
+            uint32_t id = inst["id"].as<uint32_t>();
+            if (id >= NUM_INSTRUMENTS) {
+                std::cerr << "Instrument id " << id << " out of range" << std::endl;
+                continue;
+            }
+            InstrumentLimits lim;
+            lim.max_order_qty = inst["max_order_qty"].as<uint32_t>(lim.max_order_qty);
+            lim.max_order_notional = inst["max_order_notional"].as<double>(lim.max_order_notional);
+            lim.price_tolerance_pct = inst["price_tolerance_pct"].as<double>(lim.price_tolerance_pct);
+            lim.max_spread_ticks = inst["max_spread_ticks"].as<double>(lim.max_spread_ticks);
+            // spreads are measured in whole ticks; 0.10 would be a price from before that
+            if (lim.max_spread_ticks < 0.0 || lim.max_spread_ticks != std::floor(lim.max_spread_ticks)) {
+                std::cerr << "max_spread_ticks of instrument " << id << " must be a whole number of ticks" << std::endl;
+                return false;
+            }
+            lim.init_margin_pct = inst["init_margin_pct"].as<double>(lim.init_margin_pct);
+            lim.maint_margin_pct = inst["maint_margin_pct"].as<double>(lim.maint_margin_pct);
+            lim.max_daily_position = inst["max_daily_position"].as<uint32_t>(lim.max_daily_position);
+            lim.max_window_qty = inst["max_window_qty"].as<uint32_t>(lim.max_window_qty);
+            lim.max_window_notional = inst["max_window_notional"].as<double>(lim.max_window_notional);
+            instrument_limits.set(id, lim);
+            auto decimals = inst["price_decimals"].as<uint32_t>(PriceScales::DEFAULT_DECIMALS);
+            if (decimals > PriceScales::MAX_DECIMALS) {
+                std::cerr << "price_decimals of instrument " << id << " above " << (int)PriceScales::MAX_DECIMALS << std::endl;
+                return false;
+            }
+            price_scales.setDecimals(id, (uint8_t)decimals);
+            if (inst["tick_size"]) {
+                double tick_size = inst["tick_size"].as<double>();
+                if (!price_scales.setTickSize(id, tick_size)) {
+                    std::cerr << "tick_size of instrument " << id << " is not a whole number of price units" << std::endl;
+                    return false;
+                }
+                l1_table.setTickSize(id, tick_size);
+            }
+            if (inst["reference_price"]) {
+                RefPricePolicy policy;
+                if (!ReferencePriceEngine::parsePolicy(inst["reference_price"].as<std::string>(), policy)) {
+                    std::cerr << "Unknown reference_price policy for instrument " << id << std::endl;
+                    return false;
+                }
+                reference_prices.setPolicy(id, policy);
+            }
+            if (inst["settlement_price"]) {
+                reference_prices.setSettlement(id, inst["settlement_price"].as<double>());
+            }
+            volatility_table.setBands(id, inst["max_tick_vol"].as<double>(0.0), inst["max_range_pct"].as<double>(0.0));
+            if (const auto &pnl = inst["scenario_pnl"]) {
+                if (pnl.size() != ScenarioMarginEngine::SCENARIOS) {
+                    std::cerr << "scenario_pnl of instrument " << id << " needs "
+                              << ScenarioMarginEngine::SCENARIOS << " values" << std::endl;
+                    return false;
+                }
+                double values[ScenarioMarginEngine::SCENARIOS];
+                for (int s = 0; s < ScenarioMarginEngine::SCENARIOS; ++s) values[s] = pnl[s].as<double>();
+                scenario_margin.setScenarios(id, values);
+            } else if (inst["price_scan"]) {
+                scenario_margin.setLinearScenarios(id, inst["price_scan"].as<double>());
+            }
+        }
+        if (const auto &vol = config["volatility"]) {
+            VolatilityParams params;
+            params.ewma_lambda = vol["ewma_lambda"].as<double>(params.ewma_lambda);
+            params.range_ms = vol["range_ms"].as<uint32_t>(params.range_ms);
+            volatility_table.init(params);
+        }
+        volatility_table.recompute();
+        if (const auto &vcm = config["vcm"]) {
+            VcmParams params;
+            params.halt_ms = vcm["halt_ms"].as<uint32_t>(params.halt_ms);
+            params.cooling_ms = vcm["cooling_ms"].as<uint32_t>(params.cooling_ms);
+            params.resumed_ms = vcm["resumed_ms"].as<uint32_t>(params.resumed_ms);
+            params.cooling_band_pct = vcm["cooling_band_pct"].as<double>(params.cooling_band_pct);
+            vcm_states.init(params);
+        }
+        for (const auto &acct : config["accounts"]) {
+            uint32_t id = acct["id"].as<uint32_t>();
+            AccountLimits lim;
+            lim.max_order_rate_per_sec = acct["max_order_rate_per_sec"].as<uint32_t>(lim.max_order_rate_per_sec);
+            lim.max_concurrent_orders = acct["max_concurrent_orders"].as<uint32_t>(lim.max_concurrent_orders);
+            lim.max_leverage = acct["max_leverage"].as<double>(lim.max_leverage);
+            lim.max_drawdown_pct = acct["max_drawdown_pct"].as<double>(lim.max_drawdown_pct);
+            lim.initial_equity = acct["initial_equity"].as<double>(lim.initial_equity);
+            lim.kill_switch = acct["kill_switch"].as<bool>(lim.kill_switch);
+            uint32_t slot = shard_layout.assign(id);
+            if (slot == ShardLayout::NO_SLOT) {
+                std::cerr << "Account " << id << ": shard " << shardOf(id) << " already holds "
+                          << shard_layout.accountsPerShard() << " accounts" << std::endl;
+                return false;
+            }
+            account_limits[shardOf(id)].set(slot, lim);
+        }
+        if (config["limit_tree"] && !loadLimitTree(config["limit_tree"])) {
+            return false;
+        }
+        if (config["credit_lines"] && !loadCreditLines(config["credit_lines"])) {
+            return false;
+        }
+        if (const auto &window = config["volume_window"]) {
+            VolumeWindowParams params;
+            params.window_ms = window["window_ms"].as<uint32_t>(params.window_ms);
+            params.buckets = window["buckets"].as<uint32_t>(params.buckets);
+            volume_windows.init(params);
+        }
+        if (const auto &session = config["session"]) {
+            SessionParams params;
+            if (session["start_utc"]) {
+                const std::string start = session["start_utc"].as<std::string>();
+                if (!SessionClock::parseTimeOfDay(start, params.start_utc_ms)) {
+                    std::cerr << "session start_utc must be HH:MM or HH:MM:SS, got " << start << std::endl;
+                    return false;
+                }
+                params.daily = true;
+            }
+            session_clock.init(params);
+        }
+        if (const auto &var = config["var"]) {
+            VarParams params;
+            params.confidence = var["confidence"].as<double>(params.confidence);
+            historical_var.init(params);
+            // after the limit tree: desk and firm VaR are kept per node
+            if (var["returns_file"] && !historical_var.load(var["returns_file"].as<std::string>())) {
+                return false;
+            }
+        }
+        if (config["rules"] && !loadRules(config["rules"])) {
+            return false;
+        }
+        if (const auto &lists = config["instrument_lists"]) {
+            if (lists["restricted"] && !instrument_lists.loadFile(InstrumentListKind::Restricted, lists["restricted"].as<std::string>())) {
+                return false;
+            }
+            if (lists["hard_to_borrow"] && !instrument_lists.loadFile(InstrumentListKind::HardToBorrow, lists["hard_to_borrow"].as<std::string>())) {
+                return false;
+            }
+        }
+        std::cout << "Loaded risk limits from " << filepath << std::endl;
+        return true;
+    } catch (const std::exception &e) {
+        std::cerr << "Failed to load risk limits: " << e.what() << std::endl;
+        return false;
+    }
+}
@@ -0,0 +1,202 @@
+//
+// Created by muhammad-abdullah on 6/23/25.
+//
+
+// File: src/credit_manager.cpp
+#include "credit_manager.h"
+#include <algorithm>
+#include <cmath>
+
+rms::CreditManager rms::credit_manager;
+
+int64_t rms::CreditManager::toUnits(double notional) {
+    return std::llround(notional * CREDIT_UNITS_PER_CCY);
+}
+
+int32_t rms::CreditManager::addLine(const std::string &name, double limit, double chunk) {
+    int64_t limit_units = toUnits(limit);
+    int64_t chunk_units = std::max<int64_t>(toUnits(chunk), 1);
+    lines_.push_back(CreditLine{name, limit_units, chunk_units});
+    return (int32_t)lines_.size() - 1;
+}
+
+int32_t rms::CreditManager::findLine(const std::string &name) const {
+    for (size_t i = 0; i < lines_.size(); ++i) {
+        if (lines_[i].name == name) return (int32_t)i;
+    }
+    return -1;
+}
+
+bool rms::CreditManager::assignAccount(uint32_t account_id, int32_t line) {
+    if (line < 0 || line >= (int32_t)lines_.size()) return false;
+    account_lines_[account_id] = line;
+    return true;
+}
+
+void rms::CreditManager::finalize() {
+    lines_per_shard_ = (lines_.size() + 7) / 8;
+    shards_ = shard_layout.shards();
+    slices_ = std::vector<SliceLine>(lines_per_shard_ * shards_);
+    used_ = std::vector<SliceLine>(lines_per_shard_ * shards_);
+    pools_ = std::vector<Pool>(lines_.size());
+    for (size_t line = 0; line < lines_.size(); ++line) {
+        int64_t free = lines_[line].limit;
+        for (uint32_t shard = 0; shard < shards_; ++shard) {
+            int64_t give = std::min(free, lines_[line].chunk);
+            sliceRef((int32_t)line, shard).store(give, std::memory_order_relaxed);
+            free -= give;
+        }
+        pools_[line].free.store(free, std::memory_order_relaxed);
+    }
+}
+
+void rms::CreditManager::clear() {
+    lines_.clear();
+    account_lines_.clear();
+    slices_.clear();
+    used_.clear();
+    pools_.clear();
+    lines_per_shard_ = 0;
+    shards_ = 0;
+}
+
+bool rms::CreditManager::tryConsume(uint32_t account_id, double notional) {
+    int32_t line = lineFor(account_id);
+    if (line < 0) return true;
+    int64_t units = toUnits(std::abs(notional));
+    int shard = shardOf(account_id);
+    auto &slice = sliceRef(line, shard);
+
+    // hot path: the slice lives on a line only this shard writes, except while a sweep runs
+    int64_t cur = slice.load(std::memory_order_relaxed);
+    while (cur >= units) {
+        if (slice.compare_exchange_weak(cur, cur - units, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            auto &used = usedRef(line, shard);
+            used.store(used.load(std::memory_order_relaxed) + units, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return refillAndConsume(line, shard, units);
+}
+
+void rms::CreditManager::adjust(uint32_t account_id, double notional) {
+    int32_t line = lineFor(account_id);
+    if (line < 0) return;
+    int64_t units = toUnits(notional);
+    int shard = shardOf(account_id);
+    auto &used = usedRef(line, shard);
+    int64_t was = used.load(std::memory_order_relaxed);
+    // a release gives back no more than the shard took, so the line never grows past its limit
+    if (units < 0) units = -std::min(-units, was);
+    if (units == 0) return;
+    used.store(was + units, std::memory_order_relaxed);
+    // fills cannot be refused, so a slice may go negative until the next rebalance
+    sliceRef(line, shard).fetch_sub(units, std::memory_order_acq_rel);
+}
+
+void rms::CreditManager::rebalance(int shard) {
+    for (size_t line = 0; line < lines_.size(); ++line) {
+        auto &pool = pools_[line];
+        // a sweep or another shard's refill is running: try again next idle pass
+        if (pool.sweeping.test_and_set(std::memory_order_acquire)) continue;
+        auto &slice = sliceRef((int32_t)line, shard);
+        int64_t chunk = lines_[line].chunk;
+        int64_t cur = slice.load(std::memory_order_relaxed);
+        if (cur < chunk / 2) {
+            int64_t got = takeFromPool((int32_t)line, chunk - cur);
+            if (got > 0) slice.fetch_add(got, std::memory_order_acq_rel);
+        }
+        else if (cur > 2 * chunk) {
+            int64_t surplus = cur - chunk;
+            if (slice.compare_exchange_strong(cur, cur - surplus, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                pool.free.fetch_add(surplus, std::memory_order_acq_rel);
+            }
+        }
+        pool.sweeping.clear(std::memory_order_release);
+    }
+}
+
+int64_t rms::CreditManager::available(int32_t line) const {
+    int64_t total = pools_[line].free.load(std::memory_order_acquire);
+    for (uint32_t shard = 0; shard < shards_; ++shard) {
+        total += sliceRef(line, shard).load(std::memory_order_acquire);
+    }
+    return total;
+}
+
+int64_t rms::CreditManager::slice(int32_t line, int shard) const {
+    return sliceRef(line, shard).load(std::memory_order_acquire);
+}
+
+int64_t rms::CreditManager::used(int32_t line) const {
+    int64_t total = 0;
+    for (uint32_t shard = 0; shard < shards_; ++shard) {
+        total += usedRef(line, shard).load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::atomic<int64_t> &rms::CreditManager::sliceRef(int32_t line, int shard) const {
+    return slices_[shard * lines_per_shard_ + line / 8].v[line % 8];
+}
+
+std::atomic<int64_t> &rms::CreditManager::usedRef(int32_t line, int shard) const {
+    return used_[shard * lines_per_shard_ + line / 8].v[line % 8];
+}
+
+int32_t rms::CreditManager::lineFor(uint32_t account_id) const {
+    if (slices_.empty()) return -1;
+    auto it = account_lines_.find(account_id);
+    return it == account_lines_.end() ? -1 : it->second;
+}
+
+int64_t rms::CreditManager::takeFromPool(int32_t line, int64_t want) {
+    auto &pool = pools_[line].free;
+    int64_t cur = pool.load(std::memory_order_relaxed);
+    while (cur > 0) {
+        int64_t take = std::min(cur, want);
+        if (pool.compare_exchange_weak(cur, cur - take, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            return take;
+        }
+    }
+    return 0;
+}
+
+bool rms::CreditManager::refillAndConsume(int32_t line, int shard, int64_t units) {
+    auto &pool = pools_[line];
+    // only one shard moves a line's credit between pool and slices at a time, so a
+    // sweeper never runs while credit is taken from the pool but not yet in a slice.
+    // The order path does not wait for it: the order is rejected and the slice is
+    // topped up by rebalance() on the next idle pass.
+    if (pool.sweeping.test_and_set(std::memory_order_acquire)) return false;
+    auto &slice = sliceRef(line, shard);
+    int64_t cur = slice.load(std::memory_order_relaxed);
+    int64_t got = takeFromPool(line, std::max(units - cur, lines_[line].chunk));
+    cur = slice.fetch_add(got, std::memory_order_acq_rel) + got;
+    bool ok = false;
+    while (cur >= units && !ok) {
+        ok = slice.compare_exchange_weak(cur, cur - units, std::memory_order_acq_rel, std::memory_order_relaxed);
+    }
+    if (!ok) ok = sweepAndConsume(line, shard, units);
+    pool.sweeping.clear(std::memory_order_release);
+    if (ok) {
+        auto &used = usedRef(line, shard);
+        used.store(used.load(std::memory_order_relaxed) + units, std::memory_order_relaxed);
+    }
+    return ok;
+}
+
+bool rms::CreditManager::sweepAndConsume(int32_t line, int shard, int64_t units) {
+    auto &pool = pools_[line];
+    int64_t collected = pool.free.exchange(0, std::memory_order_acq_rel);
+    for (uint32_t s = 0; s < shards_; ++s) {
+        collected += sliceRef(line, s).exchange(0, std::memory_order_acq_rel);
+    }
+    bool ok = collected >= units;
+    if (ok) collected -= units;
+    // the sweeper keeps a working chunk, the rest goes back to the pool for the others
+    int64_t keep = std::clamp<int64_t>(collected, 0, lines_[line].chunk);
+    sliceRef(line, shard).fetch_add(keep, std::memory_order_acq_rel);
+    pool.free.fetch_add(collected - keep, std::memory_order_acq_rel);
+    return ok;
+}
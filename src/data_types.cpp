@@ -5,6 +5,80 @@
 // File: src/data_types.cpp
 #include "data_types.h"
 
-InstrumentLimitsShard instrument_limits_shards[NUM_SHARDS];
-AccountLimitsShard account_limits_shards[NUM_SHARDS];
-std::array<folly::F14FastMap<uint32_t, Position>, NUM_SHARDS> position_store;
\ No newline at end of file
+namespace {
+    std::vector<AccountLimitTable> makeAccountLimits(uint32_t shards, uint32_t accounts_per_shard) {
+        std::vector<AccountLimitTable> tables;
+        tables.reserve(shards);
+        for (uint32_t s = 0; s < shards; ++s) tables.emplace_back(accounts_per_shard);
+        return tables;
+    }
+}
+
+InstrumentLimitTable instrument_limits;
+std::vector<AccountLimitTable> account_limits =
+    makeAccountLimits(rms::ShardLayout::DEFAULT_SHARDS, rms::ShardLayout::DEFAULT_ACCOUNTS_PER_SHARD);
+std::vector<PositionTable> position_store(rms::ShardLayout::DEFAULT_SHARDS);
+std::vector<folly::F14FastMap<uint64_t, OpenOrder>> open_order_store(rms::ShardLayout::DEFAULT_SHARDS);
+std::vector<folly::F14FastMap<uint64_t, OpenExposure>> open_exposure_store(rms::ShardLayout::DEFAULT_SHARDS);
+
+void resizeShardTables(uint32_t shards, uint32_t accounts_per_shard) {
+    account_limits = makeAccountLimits(shards, accounts_per_shard);
+    position_store = std::vector<PositionTable>(shards);
+    open_order_store = std::vector<folly::F14FastMap<uint64_t, OpenOrder>>(shards);
+    open_exposure_store = std::vector<folly::F14FastMap<uint64_t, OpenExposure>>(shards);
+}
+
+InstrumentLimitTable::InstrumentLimitTable() {
+    for (uint32_t i = 0; i < NUM_INSTRUMENTS; ++i) set(i, InstrumentLimits{});
+}
+
+void InstrumentLimitTable::set(uint32_t instrument_id, const InstrumentLimits &lim) {
+    max_order_qty[instrument_id] = lim.max_order_qty;
+    max_daily_position[instrument_id] = lim.max_daily_position;
+    max_window_qty[instrument_id] = lim.max_window_qty;
+    max_order_notional[instrument_id] = lim.max_order_notional;
+    price_tolerance_pct[instrument_id] = lim.price_tolerance_pct;
+    max_window_notional[instrument_id] = lim.max_window_notional;
+    init_margin_pct[instrument_id] = lim.init_margin_pct;
+    maint_margin_pct[instrument_id] = lim.maint_margin_pct;
+    max_spread_ticks[instrument_id] = lim.max_spread_ticks;
+}
+
+InstrumentLimits InstrumentLimitTable::get(uint32_t instrument_id) const {
+    InstrumentLimits lim;
+    lim.max_order_qty = max_order_qty[instrument_id];
+    lim.max_daily_position = max_daily_position[instrument_id];
+    lim.max_window_qty = max_window_qty[instrument_id];
+    lim.max_order_notional = max_order_notional[instrument_id];
+    lim.price_tolerance_pct = price_tolerance_pct[instrument_id];
+    lim.max_window_notional = max_window_notional[instrument_id];
+    lim.init_margin_pct = init_margin_pct[instrument_id];
+    lim.maint_margin_pct = maint_margin_pct[instrument_id];
+    lim.max_spread_ticks = max_spread_ticks[instrument_id];
+    return lim;
+}
+
+AccountLimitTable::AccountLimitTable(uint32_t accounts) {
+    arena_.reset(rms::ShardArena::bytesFor(accounts, {sizeof(double), sizeof(double), sizeof(Cold)}));
+    initial_equity = arena_.take<double>(accounts);
+    max_drawdown_pct = arena_.take<double>(accounts);
+    cold = arena_.take<Cold>(accounts);
+    for (uint32_t a = 0; a < accounts; ++a) set(a, AccountLimits{});
+}
+
+void AccountLimitTable::set(uint32_t slot, const AccountLimits &lim) {
+    initial_equity[slot] = lim.initial_equity;
+    max_drawdown_pct[slot] = lim.max_drawdown_pct;
+    cold[slot] = Cold{lim.max_order_rate_per_sec, lim.max_concurrent_orders, lim.max_leverage, lim.kill_switch};
+}
+
+AccountLimits AccountLimitTable::get(uint32_t slot) const {
+    AccountLimits lim;
+    lim.max_order_rate_per_sec = cold[slot].max_order_rate_per_sec;
+    lim.max_concurrent_orders = cold[slot].max_concurrent_orders;
+    lim.max_leverage = cold[slot].max_leverage;
+    lim.max_drawdown_pct = max_drawdown_pct[slot];
+    lim.initial_equity = initial_equity[slot];
+    lim.kill_switch = cold[slot].kill_switch;
+    return lim;
+}
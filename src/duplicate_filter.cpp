@@ -0,0 +1,116 @@
+//
+// Created by muhammad-abdullah on 6/16/25.
+//
+
+// File: src/duplicate_filter.cpp
+#include "duplicate_filter.h"
+#include <algorithm>
+
+namespace {
+    // Odd multipliers spreading the low hash word over the eight block words
+    constexpr uint32_t kSalt[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                   0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+    uint64_t mix(uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    // one bit in each of the eight words of the block
+    void blockMask(uint32_t h, uint64_t (&mask)[8]) {
+        for (int i = 0; i < 8; ++i) {
+            mask[i] = 1ULL << ((h * kSalt[i]) >> 26);
+        }
+    }
+}
+
+void rms::DuplicateOrderFilter::init(const DuplicateFilterParams &params, uint64_t now_ms) {
+    generations_ = std::max<uint32_t>(params.generations, 2);
+    slots_ = generations_ + 1;
+    capacity_ = std::max<uint32_t>(params.ids_per_generation, 1);
+    uint64_t bits = (uint64_t)capacity_ * params.bits_per_id;
+    blocks_per_gen_ = (uint32_t)std::max<uint64_t>((bits + 511) / 512, 1);
+    blocks_.assign((size_t)slots_ * blocks_per_gen_, Block{});
+    // the newest generation is always partial, so n-1 full slices cover the window
+    slice_ms_ = std::max<uint64_t>(params.window_ms / (generations_ - 1), 1);
+    slice_start_ms_ = now_ms;
+    last_now_ms_ = now_ms;
+    current_ = 0;
+    spare_ = 1;
+    cleared_ = blocks_per_gen_;
+    // enough that inserts alone finish the spare before the generation fills, with one to spare
+    clear_step_ = (blocks_per_gen_ + capacity_ - 1) / capacity_ + 1;
+    inserted_ = 0;
+    rotations_ = 0;
+}
+
+void rms::DuplicateOrderFilter::advance(uint64_t now_ms) {
+    last_now_ms_ = now_ms;
+    if (now_ms - slice_start_ms_ >= slice_ms_) {
+        rotate(now_ms);
+    }
+    clearSpare(clear_step_);
+}
+
+size_t rms::DuplicateOrderFilter::blockIndex(uint64_t hash) const {
+    return (size_t)(((hash >> 32) * (uint64_t)blocks_per_gen_) >> 32);
+}
+
+bool rms::DuplicateOrderFilter::mayContain(uint64_t order_id) const {
+    if (blocks_.empty()) return false;
+    uint64_t h = mix(order_id);
+    size_t idx = blockIndex(h);
+    uint64_t mask[8];
+    blockMask((uint32_t)h, mask);
+    for (uint32_t g = 0; g < slots_; ++g) {
+        // the spare holds ids older than the window, partly wiped
+        if (g == spare_) continue;
+        const Block &b = blocks_[idx * slots_ + g];
+        uint64_t miss = 0;
+        for (int i = 0; i < 8; ++i) {
+            miss |= mask[i] & ~b.words[i];
+        }
+        if (miss == 0) return true;
+    }
+    return false;
+}
+
+void rms::DuplicateOrderFilter::insert(uint64_t order_id) {
+    if (blocks_.empty()) return;
+    if (inserted_ >= capacity_) {
+        // a burst filled the generation early; the window shrinks, the false-positive rate doesn't
+        rotate(last_now_ms_);
+    }
+    uint64_t h = mix(order_id);
+    uint64_t mask[8];
+    blockMask((uint32_t)h, mask);
+    Block &b = blocks_[blockIndex(h) * slots_ + current_];
+    for (int i = 0; i < 8; ++i) {
+        b.words[i] |= mask[i];
+    }
+    ++inserted_;
+    clearSpare(clear_step_);
+}
+
+void rms::DuplicateOrderFilter::clearSpare(uint32_t n) {
+    uint32_t end = std::min(cleared_ + n, blocks_per_gen_);
+    for (; cleared_ < end; ++cleared_) {
+        blocks_[(size_t)cleared_ * slots_ + spare_] = Block{};
+    }
+}
+
+void rms::DuplicateOrderFilter::rotate(uint64_t now_ms) {
+    // only left over if the slice passed with too few calls to wipe it, i.e. while quiet
+    clearSpare(blocks_per_gen_);
+    current_ = spare_;
+    // the oldest generation leaves the window and is wiped from here on
+    spare_ = (current_ + 1) % slots_;
+    cleared_ = 0;
+    inserted_ = 0;
+    slice_start_ms_ = now_ms;
+    ++rotations_;
+}
@@ -0,0 +1,272 @@
+//
+// Created by muhammad-abdullah on 7/24/25.
+//
+
+// File: src/historical_var.cpp
+#include "historical_var.h"
+#include "limit_tree.h"
+#include "reference_price.h"
+#include <immintrin.h>
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+rms::HistoricalVarEngine rms::historical_var;
+
+namespace {
+    constexpr char kMagic[8] = "RMSVAR1";
+
+    // y[s] += a * x[s]
+    void axpyScalar(double a, const double *x, double *y, size_t n) {
+        for (size_t s = 0; s < n; ++s) y[s] += a * x[s];
+    }
+
+    __attribute__((target("avx2")))
+    void axpyAvx2(double a, const double *x, double *y, size_t n) {
+        const __m256d va = _mm256_set1_pd(a);
+        size_t s = 0;
+        for (; s + 4 <= n; s += 4) {
+            __m256d vy = _mm256_loadu_pd(y + s);
+            _mm256_storeu_pd(y + s, _mm256_add_pd(vy, _mm256_mul_pd(va, _mm256_loadu_pd(x + s))));
+        }
+        axpyScalar(a, x + s, y + s, n - s);
+    }
+
+    using AxpyKernel = void (*)(double, const double *, double *, size_t);
+
+    AxpyKernel axpyKernel() {
+        static const AxpyKernel kernel = [] {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") ? axpyAvx2 : axpyScalar;
+        }();
+        return kernel;
+    }
+}
+
+rms::HistoricalVarEngine::~HistoricalVarEngine() {
+    unload();
+}
+
+bool rms::HistoricalVarEngine::writeFile(const std::string &path, uint32_t num_instruments, uint32_t num_scenarios,
+                                         const double *columns) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Cannot write VaR returns file " << path << std::endl;
+        return false;
+    }
+    VarFileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(header.magic));
+    header.num_instruments = num_instruments;
+    header.num_scenarios = num_scenarios;
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(columns), (std::streamsize)num_instruments * num_scenarios * sizeof(double));
+    return (bool)out;
+}
+
+void rms::HistoricalVarEngine::resize(uint32_t shards, uint32_t accounts_per_shard) {
+    unload();
+    accounts_per_shard_ = accounts_per_shard;
+    shards_ = std::vector<Shard>(shards);
+}
+
+bool rms::HistoricalVarEngine::load(const std::string &path) {
+    unload();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Cannot open VaR returns file " << path << std::endl;
+        return false;
+    }
+    struct stat st{};
+    VarFileHeader header{};
+    if (::fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(header)
+        || ::pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)
+        || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0
+        || header.num_scenarios == 0
+        || (size_t)st.st_size != sizeof(header) + (size_t)header.num_instruments * header.num_scenarios * sizeof(double)) {
+        std::cerr << "Malformed VaR returns file " << path << std::endl;
+        ::close(fd);
+        return false;
+    }
+    void *map = ::mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        std::cerr << "Cannot map VaR returns file " << path << std::endl;
+        return false;
+    }
+    // every fill reads a column: fault it all in now rather than on the shard threads
+    ::madvise(map, (size_t)st.st_size, MADV_WILLNEED);
+    map_ = map;
+    map_size_ = (size_t)st.st_size;
+    columns_ = reinterpret_cast<const double *>(static_cast<const char *>(map) + sizeof(header));
+    num_instruments_ = std::min<uint32_t>(header.num_instruments, NUM_INSTRUMENTS);
+    num_scenarios_ = header.num_scenarios;
+    num_nodes_ = limit_tree.size();
+    for (auto &shard : shards_) {
+        shard.columns.assign(NUM_INSTRUMENTS, Columns{});
+        shard.account_pnl.assign((size_t)accounts_per_shard_ * num_scenarios_, 0.0);
+        shard.shadow_account_pnl.assign((size_t)accounts_per_shard_ * num_scenarios_, 0.0);
+        shard.node_pnl.assign(num_nodes_ * num_scenarios_, 0.0);
+        shard.shadow_node_pnl.assign(num_nodes_ * num_scenarios_, 0.0);
+        shard.scratch.assign(num_scenarios_, 0.0);
+        shard.cursor = 0;
+        shard.in_pass = false;
+    }
+    return true;
+}
+
+void rms::HistoricalVarEngine::unload() {
+    if (map_ != nullptr) ::munmap(map_, map_size_);
+    map_ = nullptr;
+    map_size_ = 0;
+    columns_ = nullptr;
+    num_instruments_ = 0;
+    num_scenarios_ = 0;
+    for (auto &shard : shards_) shard = Shard{};
+}
+
+const double *rms::HistoricalVarEngine::returns(uint32_t instrument_id) const {
+    if (columns_ == nullptr || instrument_id >= num_instruments_) return nullptr;
+    return columns_ + (size_t)instrument_id * num_scenarios_;
+}
+
+void rms::HistoricalVarEngine::addExposure(Shard &shard, uint32_t account_id, uint16_t acct, const double *ret,
+                                            double delta) {
+    AxpyKernel axpy = axpyKernel();
+    axpy(delta, ret, shard.account_pnl.data() + (size_t)acct * num_scenarios_, num_scenarios_);
+    const LimitPath *path = limit_tree.pathFor(account_id);
+    if (path == nullptr) return;
+    for (uint8_t d = 0; d < path->depth; ++d) {
+        if ((size_t)path->nodes[d] >= num_nodes_) continue;
+        axpy(delta, ret, shard.node_pnl.data() + (size_t)path->nodes[d] * num_scenarios_, num_scenarios_);
+    }
+}
+
+void rms::HistoricalVarEngine::onPosition(uint32_t account_id, uint32_t instrument_id, Position &pos, double fallback_mark) {
+    const double *ret = returns(instrument_id);
+    if (ret == nullptr) return;
+    Shard &shard = shards_[shardOf(account_id)];
+    Columns &cols = shard.columns[instrument_id];
+    uint32_t slot = shard_layout.assign(account_id);
+    if (slot == ShardLayout::NO_SLOT || slot >= accounts_per_shard_) return;
+    uint16_t acct = (uint16_t)slot;
+    if (pos.var_slot == NO_MARK_SLOT) {
+        pos.var_slot = (uint32_t)cols.qty.size();
+        cols.qty.push_back(0.0);
+        cols.exposure.push_back(0.0);
+        cols.pending.push_back(0.0);
+        cols.account.push_back(acct);
+    }
+    double mark = reference_prices.reference(instrument_id);
+    if (mark <= 0.0) mark = cols.mark > 0.0 ? cols.mark : fallback_mark;
+    cols.mark = mark;
+    uint32_t k = pos.var_slot;
+    double exposure = (double)pos.net_qty * mark;
+    addExposure(shard, account_id, acct, ret, exposure - cols.exposure[k]);
+    // the running pass already summed this instrument into the shadow vectors
+    if (shard.in_pass && instrument_id < shard.cursor) {
+        axpyKernel()(exposure - cols.pending[k], ret,
+                     shard.shadow_account_pnl.data() + (size_t)acct * num_scenarios_, num_scenarios_);
+    }
+    cols.qty[k] = (double)pos.net_qty;
+    cols.exposure[k] = exposure;
+    cols.pending[k] = exposure;
+}
+
+void rms::HistoricalVarEngine::rebuildNodes(int shard_id, std::vector<double> &node_pnl,
+                                            const std::vector<double> &account_pnl) const {
+    std::fill(node_pnl.begin(), node_pnl.end(), 0.0);
+    if (num_nodes_ == 0) return;
+    AxpyKernel axpy = axpyKernel();
+    uint32_t assigned = std::min(shard_layout.assigned(shard_id), accounts_per_shard_);
+    for (uint32_t acct = 0; acct < assigned; ++acct) {
+        const LimitPath *path = limit_tree.pathFor(shard_layout.accountAt(shard_id, acct));
+        if (path == nullptr) continue;
+        const double *pnl = account_pnl.data() + (size_t)acct * num_scenarios_;
+        for (uint8_t d = 0; d < path->depth; ++d) {
+            if ((size_t)path->nodes[d] >= num_nodes_) continue;
+            axpy(1.0, pnl, node_pnl.data() + (size_t)path->nodes[d] * num_scenarios_, num_scenarios_);
+        }
+    }
+}
+
+bool rms::HistoricalVarEngine::recomputeStep(int shard_id, size_t max_positions) {
+    if (columns_ == nullptr) return false;
+    Shard &shard = shards_[shard_id];
+    if (!shard.in_pass) {
+        std::fill(shard.shadow_account_pnl.begin(), shard.shadow_account_pnl.end(), 0.0);
+        shard.cursor = 0;
+        shard.in_pass = true;
+    }
+    AxpyKernel axpy = axpyKernel();
+    size_t done = 0;
+    while (shard.cursor < num_instruments_ && done < max_positions) {
+        uint32_t i = shard.cursor++;
+        Columns &cols = shard.columns[i];
+        if (cols.qty.empty()) continue;
+        const double *ret = returns(i);
+        double mark = reference_prices.reference(i);
+        if (mark > 0.0) cols.mark = mark;
+        for (size_t k = 0; k < cols.qty.size(); ++k) {
+            cols.pending[k] = cols.qty[k] * cols.mark;
+            axpy(cols.pending[k], ret,
+                 shard.shadow_account_pnl.data() + (size_t)cols.account[k] * num_scenarios_, num_scenarios_);
+        }
+        done += cols.qty.size();
+    }
+    if (shard.cursor < num_instruments_) return false;
+
+    rebuildNodes(shard_id, shard.shadow_node_pnl, shard.shadow_account_pnl);
+    std::swap(shard.account_pnl, shard.shadow_account_pnl);
+    std::swap(shard.node_pnl, shard.shadow_node_pnl);
+    for (auto &cols : shard.columns) std::swap(cols.exposure, cols.pending);
+    shard.in_pass = false;
+    return true;
+}
+
+void rms::HistoricalVarEngine::recomputeAll() {
+    if (columns_ == nullptr) return;
+    auto pass = [this](int s) {
+        while (!recomputeStep(s, SIZE_MAX)) {}
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(shards_.size() - 1);
+    for (int s = 1; s < (int)shards_.size(); ++s) threads.emplace_back(pass, s);
+    pass(0);
+    for (auto &t : threads) t.join();
+}
+
+double rms::HistoricalVarEngine::quantileLoss(double *pnl) const {
+    size_t n = num_scenarios_;
+    size_t k = std::min(n - 1, (size_t)((1.0 - params_.confidence) * (double)n));
+    std::nth_element(pnl, pnl + k, pnl + n);
+    return pnl[k] < 0.0 ? -pnl[k] : 0.0;
+}
+
+double rms::HistoricalVarEngine::var(uint32_t account_id) {
+    const double *account_pnl = pnl(account_id);
+    if (account_pnl == nullptr) return 0.0;
+    Shard &shard = shards_[shardOf(account_id)];
+    std::copy_n(account_pnl, num_scenarios_, shard.scratch.data());
+    return quantileLoss(shard.scratch.data());
+}
+
+double rms::HistoricalVarEngine::nodeVar(int32_t node, std::vector<double> &scratch) const {
+    if (columns_ == nullptr || node < 0 || (size_t)node >= num_nodes_) return 0.0;
+    scratch.assign(num_scenarios_, 0.0);
+    for (const auto &shard : shards_) {
+        axpyKernel()(1.0, shard.node_pnl.data() + (size_t)node * num_scenarios_, scratch.data(), num_scenarios_);
+    }
+    return quantileLoss(scratch.data());
+}
+
+const double *rms::HistoricalVarEngine::pnl(uint32_t account_id) const {
+    uint32_t acct = shard_layout.slot(account_id);
+    if (columns_ == nullptr || acct == ShardLayout::NO_SLOT || acct >= accounts_per_shard_) return nullptr;
+    return shards_[shardOf(account_id)].account_pnl.data() + (size_t)acct * num_scenarios_;
+}
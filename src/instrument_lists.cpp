@@ -0,0 +1,121 @@
+//
+// Created by muhammad-abdullah on 6/30/25.
+//
+
+// File: src/instrument_lists.cpp
+#include "instrument_lists.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <thread>
+
+rms::InstrumentLists rms::instrument_lists;
+
+rms::InstrumentSet::InstrumentSet(const std::vector<uint32_t> &ids) {
+    uint32_t max_id = ids.empty() ? 0 : *std::max_element(ids.begin(), ids.end());
+    words_.assign(ids.empty() ? 0 : max_id / 64 + 1, 0);
+    for (uint32_t id : ids) {
+        uint64_t bit = 1ULL << (id & 63);
+        count_ += (words_[id >> 6] & bit) == 0;
+        words_[id >> 6] |= bit;
+    }
+}
+
+rms::InstrumentLists::~InstrumentLists() {
+    // no reader outlives the lists
+    for (auto &slot : slots_) delete slot.current.load(std::memory_order_relaxed);
+}
+
+size_t rms::InstrumentLists::size(InstrumentListKind kind) const {
+    const InstrumentSet *set = slots_[(int)kind].current.load(std::memory_order_acquire);
+    return set == nullptr ? 0 : set->size();
+}
+
+void rms::InstrumentLists::online(uint32_t reader) {
+    // seq_cst pairs with the publisher's swap and scan: either it sees this reader
+    // online, or the reader's first load sees the new set
+    readers_[reader].epoch.store(epoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+}
+
+void rms::InstrumentLists::offline(uint32_t reader) {
+    readers_[reader].epoch.store(0, std::memory_order_release);
+}
+
+void rms::InstrumentLists::retire(const InstrumentSet *old) {
+    if (old == nullptr) return;
+    // a reader that has seen the new epoch loads the new set from then on
+    uint64_t target = epoch_.fetch_add(1, std::memory_order_seq_cst) + 1;
+    for (auto &reader : readers_) {
+        for (;;) {
+            uint64_t seen = reader.epoch.load(std::memory_order_seq_cst);
+            if (seen == 0 || seen >= target) break;
+            std::this_thread::yield();
+        }
+    }
+    delete old;
+}
+
+bool rms::InstrumentLists::publish(InstrumentListKind kind, const std::vector<uint32_t> &ids) {
+    for (uint32_t id : ids) {
+        if (id >= InstrumentSet::MAX_INSTRUMENT_ID) {
+            std::cerr << "Instrument id " << id << " out of range for instrument list" << std::endl;
+            return false;
+        }
+    }
+    auto *fresh = new InstrumentSet(ids);
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+    retire(slots_[(int)kind].current.exchange(fresh, std::memory_order_seq_cst));
+    return true;
+}
+
+bool rms::InstrumentLists::loadFile(InstrumentListKind kind, const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Failed to open instrument list " << path << std::endl;
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::vector<uint32_t> ids;
+    std::string error;
+    if (!parseIds(data.data(), data.size(), ids, error)) {
+        std::cerr << "Instrument list " << path << ": " << error << std::endl;
+        return false;
+    }
+    return publish(kind, ids);
+}
+
+void rms::InstrumentLists::clear() {
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+    for (auto &slot : slots_) retire(slot.current.exchange(nullptr, std::memory_order_seq_cst));
+}
+
+bool rms::InstrumentLists::parseIds(const char *data, size_t len, std::vector<uint32_t> &ids, std::string &error) {
+    ids.clear();
+    ids.reserve(len / 6);
+    size_t i = 0;
+    size_t line = 1;
+    while (i < len) {
+        char c = data[i];
+        if (c == '\n') { ++line; ++i; }
+        else if (c == ' ' || c == '\t' || c == '\r' || c == ',') ++i;
+        else if (c == '#') { while (i < len && data[i] != '\n') ++i; }
+        else if (c >= '0' && c <= '9') {
+            uint64_t v = 0;
+            while (i < len && data[i] >= '0' && data[i] <= '9') {
+                v = v * 10 + (data[i] - '0');
+                if (v > UINT32_MAX) {
+                    error = "id too large on line " + std::to_string(line);
+                    return false;
+                }
+                ++i;
+            }
+            ids.push_back((uint32_t)v);
+        }
+        else {
+            error = std::string("unexpected '") + c + "' on line " + std::to_string(line);
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,63 @@
+//
+// Created by muhammad-abdullah on 7/5/25.
+//
+
+// File: src/l1_table.cpp
+#include "l1_table.h"
+
+rms::L1Table rms::l1_table;
+
+rms::L1Table::Entry &rms::L1Table::beginWrite(uint32_t instrument_id) {
+    Entry &e = entries_[instrument_id];
+    // odd sequence marks the entry as being written
+    e.seq.store(e.seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return e;
+}
+
+void rms::L1Table::endWrite(Entry &e) {
+    e.seq.store(e.seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void rms::L1Table::updateQuote(uint32_t instrument_id, double bid, double ask) {
+    if (instrument_id >= NUM_INSTRUMENTS) return;
+    Entry &e = beginWrite(instrument_id);
+    e.bid.store(bid, std::memory_order_relaxed);
+    e.ask.store(ask, std::memory_order_relaxed);
+    endWrite(e);
+}
+
+void rms::L1Table::updateLast(uint32_t instrument_id, double last) {
+    if (instrument_id >= NUM_INSTRUMENTS) return;
+    Entry &e = beginWrite(instrument_id);
+    e.last.store(last, std::memory_order_relaxed);
+    endWrite(e);
+}
+
+void rms::L1Table::setTickSize(uint32_t instrument_id, double tick_size) {
+    if (instrument_id >= NUM_INSTRUMENTS || tick_size <= 0.0) return;
+    Entry &e = beginWrite(instrument_id);
+    e.tick_size.store(tick_size, std::memory_order_relaxed);
+    endWrite(e);
+}
+
+bool rms::L1Table::read(uint32_t instrument_id, L1Snapshot &out) const {
+    if (instrument_id >= NUM_INSTRUMENTS) return false;
+    const Entry &e = entries_[instrument_id];
+    while (true) {
+        uint32_t before = e.seq.load(std::memory_order_acquire);
+        if (before & 1) {
+            __builtin_ia32_pause();
+            continue;
+        }
+        out.bid = e.bid.load(std::memory_order_relaxed);
+        out.ask = e.ask.load(std::memory_order_relaxed);
+        out.last = e.last.load(std::memory_order_relaxed);
+        out.tick_size = e.tick_size.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (e.seq.load(std::memory_order_relaxed) == before) {
+            out.seq = before;
+            return true;
+        }
+    }
+}
@@ -0,0 +1,100 @@
+//
+// Created by muhammad-abdullah on 6/20/25.
+//
+
+// File: src/limit_tree.cpp
+#include "limit_tree.h"
+
+rms::LimitTree rms::limit_tree;
+
+int32_t rms::LimitTree::addNode(const std::string &name, LimitLevel level, int32_t parent, double max_gross_notional) {
+    uint8_t depth = 0;
+    if (parent >= 0) {
+        if (parent >= (int32_t)nodes_.size()) return -1;
+        depth = nodes_[parent].depth + 1;
+        if (depth >= MAX_LIMIT_DEPTH) return -1;
+    }
+    nodes_.push_back(LimitNode{name, level, parent, depth, max_gross_notional});
+    return (int32_t)nodes_.size() - 1;
+}
+
+int32_t rms::LimitTree::findNode(const std::string &name) const {
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        if (nodes_[i].name == name) return (int32_t)i;
+    }
+    return -1;
+}
+
+bool rms::LimitTree::assignAccount(uint32_t account_id, int32_t node) {
+    if (node < 0 || node >= (int32_t)nodes_.size()) return false;
+    LimitPath path;
+    for (int32_t n = node; n >= 0; n = nodes_[n].parent) {
+        path.nodes[path.depth++] = n;
+    }
+    account_paths_[account_id] = path;
+    return true;
+}
+
+void rms::LimitTree::finalize() {
+    lines_per_shard_ = (nodes_.size() + 7) / 8;
+    shards_ = shard_layout.shards();
+    usage_ = std::vector<UsageLine>(lines_per_shard_ * shards_);
+    for (auto &line : usage_) {
+        for (auto &v : line.v) v.store(0.0, std::memory_order_relaxed);
+    }
+}
+
+void rms::LimitTree::clear() {
+    nodes_.clear();
+    account_paths_.clear();
+    usage_.clear();
+    lines_per_shard_ = 0;
+    shards_ = 0;
+}
+
+bool rms::LimitTree::check(uint32_t account_id, double notional) const {
+    const LimitPath *path = pathFor(account_id);
+    if (path == nullptr || usage_.empty()) return true;
+    for (uint8_t i = 0; i < path->depth; ++i) {
+        int32_t n = path->nodes[i];
+        if (usage(n) + notional > nodes_[n].max_gross_notional) return false;
+    }
+    return true;
+}
+
+void rms::LimitTree::addUsage(uint32_t account_id, double delta) {
+    const LimitPath *path = pathFor(account_id);
+    if (path == nullptr || usage_.empty() || delta == 0.0) return;
+    int shard = shardOf(account_id);
+    for (uint8_t i = 0; i < path->depth; ++i) {
+        // single writer per partial: a plain load/store pair, no locked RMW
+        auto &p = partial(shard, path->nodes[i]);
+        p.store(p.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+}
+
+double rms::LimitTree::usage(int32_t node) const {
+    double total = 0.0;
+    for (uint32_t shard = 0; shard < shards_; ++shard) {
+        total += partial(shard, node).load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+const rms::LimitPath *rms::LimitTree::pathFor(uint32_t account_id) const {
+    auto it = account_paths_.find(account_id);
+    return it == account_paths_.end() ? nullptr : &it->second;
+}
+
+bool rms::LimitTree::parseLevel(const std::string &name, LimitLevel &level) {
+    if (name == "firm") level = LimitLevel::Firm;
+    else if (name == "desk") level = LimitLevel::Desk;
+    else if (name == "trader") level = LimitLevel::Trader;
+    else if (name == "account") level = LimitLevel::Account;
+    else return false;
+    return true;
+}
+
+std::atomic<double> &rms::LimitTree::partial(int shard, int32_t node) const {
+    return usage_[shard * lines_per_shard_ + node / 8].v[node % 8];
+}
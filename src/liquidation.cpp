@@ -0,0 +1,183 @@
+//
+// Created by muhammad-abdullah on 7/21/25.
+//
+
+// File: src/liquidation.cpp
+#include "liquidation.h"
+#include "mark_to_market.h"
+#include "reference_price.h"
+#include "price_scale.h"
+#include "utils/time_utils.h"
+#include <algorithm>
+#include <cmath>
+
+rms::LiquidationEngine rms::liquidations;
+
+void rms::LiquidationLatency::record(uint64_t ns) {
+    int b = std::min(63 - __builtin_clzll(ns | 1), BUCKETS - 1);
+    buckets[b].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    if (ns > max_ns.load(std::memory_order_relaxed)) max_ns.store(ns, std::memory_order_relaxed);
+}
+
+uint64_t rms::LiquidationLatency::percentileNs(double p) const {
+    uint64_t n = count.load(std::memory_order_relaxed);
+    if (n == 0) return 0;
+    uint64_t target = std::max<uint64_t>(1, (uint64_t)std::ceil(p * (double)n));
+    uint64_t seen = 0;
+    for (int b = 0; b < BUCKETS; ++b) {
+        seen += buckets[b].load(std::memory_order_relaxed);
+        if (seen >= target) return 2ULL << b;
+    }
+    return max_ns.load(std::memory_order_relaxed);
+}
+
+rms::LiquidationEngine::Shard::Shard()
+    : atomic_buffer(buffer.data(), buffer.size()), ring(atomic_buffer) {}
+
+rms::LiquidationEngine::LiquidationEngine() {
+    resize(ShardLayout::DEFAULT_SHARDS, ShardLayout::DEFAULT_ACCOUNTS_PER_SHARD);
+}
+
+void rms::LiquidationEngine::resize(uint32_t shards, uint32_t accounts_per_shard) {
+    // Shard's ring points into its own buffer, so the vector is rebuilt rather than resized
+    shards_ = std::vector<Shard>(shards);
+    for (auto &shard : shards_) shard.in_flight.reserve(accounts_per_shard);
+}
+
+bool rms::LiquidationEngine::checkAccount(uint32_t account_id, uint64_t now_ms) {
+    const auto &acct_lim = account_limits[shardOf(account_id)];
+    uint32_t slot = shard_layout.slot(account_id);
+    if (slot == ShardLayout::NO_SLOT) return false;
+    if (acct_lim.initial_equity[slot] <= 0.0) return false;
+    if (mark_to_market.updateDrawdown(account_id) > acct_lim.max_drawdown_pct[slot]) {
+        onBreach(account_id, LiquidationReason::Drawdown, now_ms);
+        return true;
+    }
+    if (mark_to_market.equity(account_id) >= mark_to_market.maintMargin(account_id)) return false;
+    onBreach(account_id, LiquidationReason::MaintenanceMargin, now_ms);
+    return true;
+}
+
+size_t rms::LiquidationEngine::onBreach(uint32_t account_id, LiquidationReason reason, uint64_t now_ms) {
+    int shard_id = shardOf(account_id);
+    Shard &shard = shards_[shard_id];
+    uint64_t breach_ns = utils::nowNs();
+
+    auto &candidates = shard.candidates;
+    candidates.clear();
+    position_store[shard_id].forEachOfAccount(account_id, [&](uint32_t instrument_id, Position &pos) {
+        if (pos.net_qty == 0 || instrument_id >= NUM_INSTRUMENTS) return;
+        double mark = mark_to_market.mark(shard_id, instrument_id);
+        if (mark <= 0.0) mark = reference_prices.reference(instrument_id);
+        if (mark <= 0.0) mark = pos.avg_entry_price;
+        double margin = std::abs((double)pos.net_qty) * mark * instrument_limits.init_margin_pct[instrument_id];
+        auto out = shard.in_flight.find(positionKey(account_id, instrument_id));
+        candidates.push_back(Candidate{instrument_id, pos.net_qty, mark, margin,
+                                       out == shard.in_flight.end() ? 0 : out->second});
+    });
+    if (candidates.empty()) return 0;
+
+    // margin to release so equity covers initial margin again
+    double shortfall = mark_to_market.initMargin(account_id) - mark_to_market.equity(account_id);
+    bool flatten = reason == LiquidationReason::Drawdown || mark_to_market.equity(account_id) <= 0.0;
+    if (!flatten) {
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const Candidate &a, const Candidate &b) { return a.margin > b.margin; });
+        // orders already out free their margin once they fill
+        for (const Candidate &c : candidates) {
+            shortfall -= (double)c.in_flight * c.mark * instrument_limits.init_margin_pct[c.instrument_id];
+        }
+    }
+
+    size_t queued = 0, dropped = 0;
+    for (const Candidate &c : candidates) {
+        int64_t qty = std::abs(c.net_qty) - c.in_flight;
+        if (qty <= 0) continue;
+        if (!flatten) {
+            if (shortfall <= 0.0) break;
+            double per_unit = c.mark * instrument_limits.init_margin_pct[c.instrument_id];
+            if (per_unit <= 0.0) continue;   // closing it frees no margin
+            qty = std::min<int64_t>(qty, (int64_t)std::ceil(shortfall / per_unit));
+            shortfall -= (double)qty * per_unit;
+        }
+        LiquidationOrder order{};
+        order.liquidation_id = ((uint64_t)shard_id << 56) | ++shard.next_id;
+        order.breach_ns = breach_ns;
+        order.account_id = account_id;
+        order.instrument_id = c.instrument_id;
+        order.quantity = qty;
+        order.price = price_scales.toFixed(c.instrument_id, c.mark);
+        order.is_buy = c.net_qty < 0;
+        order.reason = reason;
+        if (!enqueue(shard, order)) {
+            ++dropped;
+            continue;
+        }
+        uint64_t key = positionKey(account_id, c.instrument_id);
+        shard.orders.emplace(order.liquidation_id, InFlight{key, qty});
+        shard.in_flight[key] += qty;
+        ++queued;
+    }
+    if (queued > 0) shard.issued.fetch_add(queued, std::memory_order_relaxed);
+    else if (dropped == 0) shard.suppressed.fetch_add(1, std::memory_order_relaxed);   // all already in flight
+    return queued;
+}
+
+void rms::LiquidationEngine::release(Shard &shard, folly::F14FastMap<uint64_t, InFlight>::iterator it, int64_t qty) {
+    auto out = shard.in_flight.find(it->second.position);
+    if (out != shard.in_flight.end() && (out->second -= qty) <= 0) shard.in_flight.erase(out);
+    it->second.leaves_qty -= qty;
+    if (it->second.leaves_qty <= 0) shard.orders.erase(it);
+}
+
+void rms::LiquidationEngine::onFill(const TradeExecution &trade) {
+    Shard &shard = shards_[shardOf(trade.account_id)];
+    auto it = shard.orders.find(trade.order_id);
+    if (it == shard.orders.end() || it->second.position != positionKey(trade.account_id, trade.instrument_id)) return;
+    release(shard, it, std::min<int64_t>(trade.quantity, it->second.leaves_qty));
+}
+
+bool rms::LiquidationEngine::onCancel(uint32_t account_id, uint64_t order_id) {
+    Shard &shard = shards_[shardOf(account_id)];
+    auto it = shard.orders.find(order_id);
+    if (it == shard.orders.end() || (uint32_t)(it->second.position >> 32) != account_id) return false;
+    release(shard, it, it->second.leaves_qty);
+    return true;
+}
+
+int64_t rms::LiquidationEngine::inFlight(uint32_t account_id, uint32_t instrument_id) const {
+    const Shard &shard = shards_[shardOf(account_id)];
+    auto it = shard.in_flight.find(positionKey(account_id, instrument_id));
+    return it == shard.in_flight.end() ? 0 : it->second;
+}
+
+bool rms::LiquidationEngine::enqueue(Shard &shard, const LiquidationOrder &order) {
+    aeron::concurrent::AtomicBuffer src(reinterpret_cast<uint8_t *>(const_cast<LiquidationOrder *>(&order)), sizeof(order));
+    if (shard.ring.write(1, src, 0, sizeof(order))) return true;
+    // the account stays in breach, so it is re-detected once the publisher catches up
+    shard.ring_full.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void rms::LiquidationEngine::onPublished(const LiquidationOrder &order, uint64_t now_ns) {
+    latency_.record(now_ns > order.breach_ns ? now_ns - order.breach_ns : 0);
+}
+
+uint64_t rms::LiquidationEngine::issued() const {
+    uint64_t n = 0;
+    for (const auto &shard : shards_) n += shard.issued.load(std::memory_order_relaxed);
+    return n;
+}
+
+uint64_t rms::LiquidationEngine::suppressed() const {
+    uint64_t n = 0;
+    for (const auto &shard : shards_) n += shard.suppressed.load(std::memory_order_relaxed);
+    return n;
+}
+
+uint64_t rms::LiquidationEngine::ringFull() const {
+    uint64_t n = 0;
+    for (const auto &shard : shards_) n += shard.ring_full.load(std::memory_order_relaxed);
+    return n;
+}
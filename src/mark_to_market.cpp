@@ -0,0 +1,273 @@
+//
+// Created by muhammad-abdullah on 7/18/25.
+//
+
+// File: src/mark_to_market.cpp
+#include "mark_to_market.h"
+#include "reference_price.h"
+#include <immintrin.h>
+#include <algorithm>
+#include <cmath>
+
+rms::MarkToMarketEngine rms::mark_to_market;
+
+namespace {
+    // unrealized[k] = (mark - entry[k]) * qty[k], gross[k] = |qty[k]| * mark,
+    // and the change of each into delta / delta_gross
+    void repriceScalar(double mark, const double *qty, const double *entry, double *unrealized, double *gross,
+                       double *delta, double *delta_gross, size_t n) {
+        for (size_t k = 0; k < n; ++k) {
+            double u = (mark - entry[k]) * qty[k];
+            double g = std::abs(qty[k]) * mark;
+            delta[k] = u - unrealized[k];
+            delta_gross[k] = g - gross[k];
+            unrealized[k] = u;
+            gross[k] = g;
+        }
+    }
+
+    __attribute__((target("avx2")))
+    void repriceAvx2(double mark, const double *qty, const double *entry, double *unrealized, double *gross,
+                     double *delta, double *delta_gross, size_t n) {
+        const __m256d m = _mm256_set1_pd(mark);
+        const __m256d abs_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffLL));
+        size_t k = 0;
+        for (; k + 4 <= n; k += 4) {
+            __m256d q = _mm256_loadu_pd(qty + k);
+            __m256d u = _mm256_mul_pd(_mm256_sub_pd(m, _mm256_loadu_pd(entry + k)), q);
+            __m256d g = _mm256_mul_pd(_mm256_and_pd(q, abs_mask), m);
+            _mm256_storeu_pd(delta + k, _mm256_sub_pd(u, _mm256_loadu_pd(unrealized + k)));
+            _mm256_storeu_pd(delta_gross + k, _mm256_sub_pd(g, _mm256_loadu_pd(gross + k)));
+            _mm256_storeu_pd(unrealized + k, u);
+            _mm256_storeu_pd(gross + k, g);
+        }
+        repriceScalar(mark, qty + k, entry + k, unrealized + k, gross + k, delta + k, delta_gross + k, n - k);
+    }
+
+    using RepriceKernel = void (*)(double, const double *, const double *, double *, double *, double *, double *, size_t);
+
+    RepriceKernel repriceKernel() {
+        static const RepriceKernel kernel = [] {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") ? repriceAvx2 : repriceScalar;
+        }();
+        return kernel;
+    }
+}
+
+rms::MarkToMarketEngine::MarkToMarketEngine() {
+    resize(ShardLayout::DEFAULT_SHARDS, ShardLayout::DEFAULT_ACCOUNTS_PER_SHARD);
+}
+
+void rms::MarkToMarketEngine::resize(uint32_t shards, uint32_t accounts_per_shard) {
+    // Shard holds atomics, so the vector is rebuilt rather than resized
+    shards_ = std::vector<Shard>(shards);
+    for (auto &shard : shards_) {
+        for (auto &word : shard.dirty) word.store(0, std::memory_order_relaxed);
+        shard.columns.resize(NUM_INSTRUMENTS);
+        carve(shard, accounts_per_shard);
+    }
+}
+
+void rms::MarkToMarketEngine::carve(Shard &shard, uint32_t accounts) {
+    shard.accounts = accounts;
+    shard.account_words = (accounts + 63) / 64;
+    shard.arena.reset(ShardArena::bytesFor(accounts, {sizeof(double), sizeof(double), sizeof(double), sizeof(double),
+                                                      sizeof(double)})
+                      + ShardArena::bytesFor(shard.account_words, {sizeof(uint64_t)}));
+    shard.account_unrealized = shard.arena.take<double>(accounts);
+    shard.account_realized = shard.arena.take<double>(accounts);
+    shard.account_init_margin = shard.arena.take<double>(accounts);
+    shard.account_maint_margin = shard.arena.take<double>(accounts);
+    shard.account_peak = shard.arena.take<double>(accounts);
+    shard.repriced = shard.arena.take<uint64_t>(shard.account_words);
+}
+
+void rms::MarkToMarketEngine::resetTotals(Shard &shard) {
+    std::fill_n(shard.account_unrealized, shard.accounts, 0.0);
+    std::fill_n(shard.account_realized, shard.accounts, 0.0);
+    std::fill_n(shard.account_init_margin, shard.accounts, 0.0);
+    std::fill_n(shard.account_maint_margin, shard.accounts, 0.0);
+}
+
+void rms::MarkToMarketEngine::onPosition(uint32_t account_id, uint32_t instrument_id, Position &pos, double fallback_mark) {
+    if (instrument_id >= NUM_INSTRUMENTS) return;
+    int shard_id = shardOf(account_id);
+    Shard &shard = shards_[shard_id];
+    Columns &cols = shard.columns[instrument_id];
+    uint32_t slot = shard_layout.assign(account_id);
+    if (slot == ShardLayout::NO_SLOT || slot >= shard.accounts) return;
+    uint16_t acct = (uint16_t)slot;
+    if (pos.mark_slot == NO_MARK_SLOT) {
+        pos.mark_slot = (uint32_t)cols.qty.size();
+        cols.qty.push_back(0.0);
+        cols.entry.push_back(0.0);
+        cols.unrealized.push_back(0.0);
+        cols.gross.push_back(0.0);
+        cols.realized.push_back(0.0);
+        cols.account.push_back(acct);
+    }
+    double mark = reference_prices.reference(instrument_id);
+    if (mark <= 0.0) mark = cols.mark > 0.0 ? cols.mark : fallback_mark;
+    uint32_t k = pos.mark_slot;
+    double unrealized = (mark - pos.avg_entry_price) * (double)pos.net_qty;
+    double gross = std::abs((double)pos.net_qty) * mark;
+    shard.account_unrealized[acct] += unrealized - cols.unrealized[k];
+    shard.account_realized[acct] += pos.realized_pnl - cols.realized[k];
+    shard.account_init_margin[acct] += (gross - cols.gross[k]) * instrument_limits.init_margin_pct[instrument_id];
+    shard.account_maint_margin[acct] += (gross - cols.gross[k]) * instrument_limits.maint_margin_pct[instrument_id];
+    cols.qty[k] = (double)pos.net_qty;
+    cols.entry[k] = pos.avg_entry_price;
+    cols.unrealized[k] = unrealized;
+    cols.gross[k] = gross;
+    cols.realized[k] = pos.realized_pnl;
+}
+
+void rms::MarkToMarketEngine::onMarkChanged(uint32_t instrument_id) {
+    if (instrument_id >= NUM_INSTRUMENTS) return;
+    uint64_t bit = 1ULL << (instrument_id & 63);
+    for (auto &shard : shards_) {
+        shard.dirty[instrument_id >> 6].fetch_or(bit, std::memory_order_release);
+    }
+}
+
+void rms::MarkToMarketEngine::repriceColumns(int shard_id, uint32_t instrument_id, double mark) {
+    Shard &shard = shards_[shard_id];
+    Columns &cols = shard.columns[instrument_id];
+    size_t n = cols.qty.size();
+    cols.mark = mark;
+    if (n == 0) return;
+    if (shard.delta.size() < n) {
+        shard.delta.resize(n);
+        shard.delta_gross.resize(n);
+    }
+    double *delta = shard.delta.data();
+    double *delta_gross = shard.delta_gross.data();
+    repriceKernel()(mark, cols.qty.data(), cols.entry.data(), cols.unrealized.data(), cols.gross.data(),
+                    delta, delta_gross, n);
+    const double init_pct = instrument_limits.init_margin_pct[instrument_id];
+    const double maint_pct = instrument_limits.maint_margin_pct[instrument_id];
+    const uint16_t *account = cols.account.data();
+    for (size_t k = 0; k < n; ++k) {
+        shard.account_unrealized[account[k]] += delta[k];
+        shard.account_init_margin[account[k]] += delta_gross[k] * init_pct;
+        shard.account_maint_margin[account[k]] += delta_gross[k] * maint_pct;
+        shard.repriced[account[k] >> 6] |= 1ULL << (account[k] & 63);
+    }
+}
+
+size_t rms::MarkToMarketEngine::reprice(int shard_id) {
+    Shard &shard = shards_[shard_id];
+    size_t repriced = 0;
+    for (int w = 0; w < DIRTY_WORDS; ++w) {
+        if (shard.dirty[w].load(std::memory_order_relaxed) == 0) continue;
+        uint64_t bits = shard.dirty[w].exchange(0, std::memory_order_acquire);
+        while (bits) {
+            uint32_t i = (uint32_t)(w * 64 + __builtin_ctzll(bits));
+            bits &= bits - 1;
+            double mark = reference_prices.reference(i);
+            if (mark <= 0.0) continue;
+            repriceColumns(shard_id, i, mark);
+            ++repriced;
+        }
+    }
+    return repriced;
+}
+
+void rms::MarkToMarketEngine::sweep(int shard_id) {
+    Shard &shard = shards_[shard_id];
+    for (uint32_t i = 0; i < NUM_INSTRUMENTS; ++i) {
+        double mark = reference_prices.reference(i);
+        if (mark > 0.0) repriceColumns(shard_id, i, mark);
+    }
+    resetTotals(shard);
+    for (uint32_t i = 0; i < NUM_INSTRUMENTS; ++i) {
+        const Columns &cols = shard.columns[i];
+        const double init_pct = instrument_limits.init_margin_pct[i];
+        const double maint_pct = instrument_limits.maint_margin_pct[i];
+        for (size_t k = 0; k < cols.qty.size(); ++k) {
+            uint16_t acct = cols.account[k];
+            shard.account_unrealized[acct] += cols.unrealized[k];
+            shard.account_realized[acct] += cols.realized[k];
+            shard.account_init_margin[acct] += cols.gross[k] * init_pct;
+            shard.account_maint_margin[acct] += cols.gross[k] * maint_pct;
+        }
+    }
+}
+
+void rms::MarkToMarketEngine::clear() {
+    for (auto &shard : shards_) {
+        for (auto &word : shard.dirty) word.store(0, std::memory_order_relaxed);
+        for (auto &cols : shard.columns) cols = Columns{};
+        std::fill_n(shard.repriced, shard.account_words, 0);
+        std::fill_n(shard.account_peak, shard.accounts, 0.0);
+        resetTotals(shard);
+    }
+}
+
+double rms::MarkToMarketEngine::equityAt(int shard_id, uint32_t acct) const {
+    const Shard &shard = shards_[shard_id];
+    return account_limits[shard_id].initial_equity[acct]
+        + shard.account_realized[acct] + shard.account_unrealized[acct];
+}
+
+double rms::MarkToMarketEngine::equity(uint32_t account_id) const {
+    uint32_t acct = shard_layout.slot(account_id);
+    return acct == ShardLayout::NO_SLOT ? 0.0 : equityAt(shardOf(account_id), acct);
+}
+
+double rms::MarkToMarketEngine::updateDrawdown(uint32_t account_id) {
+    int shard_id = shardOf(account_id);
+    uint32_t acct = shard_layout.slot(account_id);
+    if (acct == ShardLayout::NO_SLOT) return 0.0;
+    double eq = equityAt(shard_id, acct);
+    double &peak = shards_[shard_id].account_peak[acct];
+    if (eq > peak) peak = eq;
+    return peak > 0.0 ? (peak - eq) / peak : 0.0;
+}
+
+double rms::MarkToMarketEngine::highWaterMark(uint32_t account_id) const {
+    return accountValue(account_id, &Shard::account_peak);
+}
+
+void rms::MarkToMarketEngine::resetHighWaterMarks() {
+    for (int s = 0; s < (int)shards_.size(); ++s) resetHighWaterMarks(s);
+}
+
+void rms::MarkToMarketEngine::resetHighWaterMarks(int shard) {
+    for (uint32_t acct = 0; acct < shards_[shard].accounts; ++acct) {
+        shards_[shard].account_peak[acct] = equityAt(shard, acct);
+    }
+}
+
+double rms::MarkToMarketEngine::accountValue(uint32_t account_id, double *Shard::*column) const {
+    uint32_t acct = shard_layout.slot(account_id);
+    return acct == ShardLayout::NO_SLOT ? 0.0 : (shards_[shardOf(account_id)].*column)[acct];
+}
+
+double rms::MarkToMarketEngine::unrealizedPnl(uint32_t account_id) const {
+    return accountValue(account_id, &Shard::account_unrealized);
+}
+
+double rms::MarkToMarketEngine::realizedPnl(uint32_t account_id) const {
+    return accountValue(account_id, &Shard::account_realized);
+}
+
+double rms::MarkToMarketEngine::initMargin(uint32_t account_id) const {
+    return accountValue(account_id, &Shard::account_init_margin);
+}
+
+double rms::MarkToMarketEngine::maintMargin(uint32_t account_id) const {
+    return accountValue(account_id, &Shard::account_maint_margin);
+}
+
+double rms::MarkToMarketEngine::unrealizedPnl(uint32_t account_id, uint32_t instrument_id, const Position &pos) const {
+    if (instrument_id >= NUM_INSTRUMENTS || pos.mark_slot == NO_MARK_SLOT) return 0.0;
+    return shards_[shardOf(account_id)].columns[instrument_id].unrealized[pos.mark_slot];
+}
+
+size_t rms::MarkToMarketEngine::positions(int shard) const {
+    size_t n = 0;
+    for (const auto &cols : shards_[shard].columns) n += cols.qty.size();
+    return n;
+}
@@ -0,0 +1,69 @@
+//
+// Created by muhammad-abdullah on 7/12/25.
+//
+
+// File: src/market_data.cpp
+#include "market_data.h"
+#include "reference_price.h"
+#include "mark_to_market.h"
+#include <algorithm>
+
+rms::MarketDataConflator::MarketDataConflator() {
+    std::fill_n(last_seq_, NUM_INSTRUMENTS, 0);
+    std::fill_n(dirty_, DIRTY_WORDS, 0);
+}
+
+bool rms::MarketDataConflator::offer(const MarketDataUpdate &update) {
+    uint32_t i = update.instrument_id;
+    if (i >= NUM_INSTRUMENTS) return false;
+    if (update.seq <= last_seq_[i]) {
+        ++stale_;
+        return false;
+    }
+    last_seq_[i] = update.seq;
+    if (update.flags & MD_HAS_LAST) {
+        reference_prices.onTrade(i, update.last, update.last_qty);
+    }
+    uint64_t bit = 1ULL << (i & 63);
+    if (dirty_[i >> 6] & bit) {
+        // keep fields the newer update does not carry
+        MarketDataUpdate &p = pending_[i];
+        ++conflated_;
+        p.seq = update.seq;
+        if (update.flags & MD_HAS_QUOTE) {
+            p.bid = update.bid;
+            p.ask = update.ask;
+        }
+        if (update.flags & MD_HAS_LAST) {
+            p.last = update.last;
+        }
+        p.flags |= update.flags;
+        return true;
+    }
+    pending_[i] = update;
+    dirty_[i >> 6] |= bit;
+    return true;
+}
+
+size_t rms::MarketDataConflator::drain(VCMModule &vcm) {
+    size_t published = 0;
+    for (int w = 0; w < DIRTY_WORDS; ++w) {
+        uint64_t bits = dirty_[w];
+        dirty_[w] = 0;
+        while (bits) {
+            uint32_t i = (uint32_t)(w * 64 + __builtin_ctzll(bits));
+            bits &= bits - 1;
+            const MarketDataUpdate &u = pending_[i];
+            if (u.flags & MD_HAS_QUOTE) {
+                vcm.onMarketData(i, u.bid, u.ask);
+                reference_prices.onQuote(i, u.bid, u.ask);
+            }
+            if (u.flags & MD_HAS_LAST) vcm.onLastTrade(i, u.last);
+            double before = reference_prices.reference(i);
+            reference_prices.publish(i);
+            if (reference_prices.reference(i) != before) mark_to_market.onMarkChanged(i);
+            ++published;
+        }
+    }
+    return published;
+}
@@ -1,9 +1,13 @@
 // File: src/messaging.cpp
 #include "messaging.h"
 #include <iostream>
+#include <cstddef>
 #include <cstring>
 #include <FragmentAssembler.h>
 #include <chrono>
+#include "baseline/MessageHeader.h"
+#include "baseline/Order.h"
+#include "utils/time_utils.h"
 
 using namespace rms;
 
@@ -11,6 +15,12 @@ static constexpr const char *CHANNEL_IN  = "aeron:udp?endpoint=localhost:40123";
 static constexpr const char *CHANNEL_OUT = "aeron:udp?endpoint=localhost:40124"; // where trade confirmations go
 static constexpr const char *CHANNEL_IPC  = "aeron:ipc"; // where orders arrive
 static constexpr std::int32_t STREAM_ID = 1001;
+static constexpr std::int32_t VCM_STREAM_ID = 1002;   // VCM state transitions out
+static constexpr std::int32_t MD_STREAM_ID = 1003;    // market data in
+static constexpr std::int32_t LIQUIDATION_STREAM_ID = 1004;   // liquidation orders out
+static constexpr std::uint8_t VCM_MSG_TYPE = 3;
+static constexpr std::uint8_t MD_MSG_TYPE = 4;
+static constexpr std::uint8_t LIQUIDATION_MSG_TYPE = 5;
 static constexpr std::chrono::duration<long, std::milli> SLEEP_IDLE_MS(1);
 
 Messaging::Messaging(){
@@ -23,6 +33,8 @@ Messaging::~Messaging() {
 bool Messaging::initialize(std::unique_ptr<LoggerWrapper>& logWrapper_) {
     try {
         logWrapper = logWrapper_.get();
+        log_id_ = logWrapper->messagingId();
+        sharded_queue = std::vector<ShardedQueue>(shard_layout.shards());
         aeron::Context context;
         aeron_ = aeron::Aeron::connect(context);
 
@@ -36,8 +48,35 @@ bool Messaging::initialize(std::unique_ptr<LoggerWrapper>& logWrapper_) {
             std::this_thread::yield();
             subscription_ = aeron_->findSubscription(id);
         }
-        logWrapper->debug(4, "[Messaging] Subscribed. Sub Id: {}", id);
+        logWrapper->debug(log_id_, "[Messaging] Subscribed. Sub Id: {}", id);
         //utils::logInfo("[Messaging] Subscribed. Sub Id: " + std::to_string(id));
+        // Market data gets its own subscription, polled by the market-data thread
+        id = aeron_->addSubscription(CHANNEL_IPC, MD_STREAM_ID);
+        md_subscription_ = aeron_->findSubscription(id);
+        while (!md_subscription_)
+        {
+            std::this_thread::yield();
+            md_subscription_ = aeron_->findSubscription(id);
+        }
+        logWrapper->debug(log_id_, "[Messaging] Market data subscribed. Sub Id: {}", id);
+
+        id = aeron_->addPublication(CHANNEL_IPC, VCM_STREAM_ID);
+        vcm_publication_ = aeron_->findPublication(id);
+        while (!vcm_publication_)
+        {
+            std::this_thread::yield();
+            vcm_publication_ = aeron_->findPublication(id);
+        }
+        logWrapper->debug(log_id_, "[Messaging] VCM publication ready. Pub Id: {}", id);
+
+        id = aeron_->addPublication(CHANNEL_IPC, LIQUIDATION_STREAM_ID);
+        liquidation_publication_ = aeron_->findPublication(id);
+        while (!liquidation_publication_)
+        {
+            std::this_thread::yield();
+            liquidation_publication_ = aeron_->findPublication(id);
+        }
+        logWrapper->debug(log_id_, "[Messaging] Liquidation publication ready. Pub Id: {}", id);
         // // Create a publication for outgoing messages (trade confirmations)
         // id = aeron_->addPublication(CHANNEL_OUT, STREAM_ID);
         //
@@ -51,13 +90,13 @@ bool Messaging::initialize(std::unique_ptr<LoggerWrapper>& logWrapper_) {
 
     }
     catch (const std::exception &ex) {
-        logWrapper->error(4, "[Messaging] Aeron initialization failed: {}", ex.what());
+        logWrapper->error(log_id_, "[Messaging] Aeron initialization failed: {}", ex.what());
         return false;
     }
 
     running_ = true;
     listenerThread_ = std::thread(&Messaging::listenerLoop, this);
-    logWrapper->debug(4, "[Messaging] Aeron initialized and listener thread started");
+    logWrapper->debug(log_id_, "[Messaging] Aeron initialized and listener thread started");
     return true;
 }
 
@@ -69,17 +108,50 @@ aeron::fragment_handler_t Messaging::fragHandler() {
         if (length < sizeof(std::uint8_t)) {
             return; // too small to read any header
         }
-        logWrapper->debug(4, "-----Got New Message-----");
-        //dangerous, it will overflow after
-        uint8_t shardId = (++_shard_counter) % (NUM_SHARDS);
-        logWrapper->debug(4, "enqueued, shardId: {}", shardId);
+        logWrapper->debug(log_id_, "-----Got New Message-----");
+        int shardId = shardFor(buffer, offset, length);
+        if (shardId < 0) {
+            logWrapper->error(log_id_, "[Messaging] Dropped inbound frame of {} bytes: type byte {}, not a trade, correction, cancel or version {} Order",
+                              length, buffer.getUInt8(offset), baseline::Order::sbeSchemaVersion());
+            return;
+        }
+        logWrapper->debug(log_id_, "enqueued, shardId: {}", shardId);
         sharded_queue[shardId].enqueue(buffer, offset, length);
     };
 }
 
 
+int Messaging::shardFor(const aeron::AtomicBuffer &buffer, std::int32_t offset, std::int32_t length) {
+    // Orders, trades, corrections and cancels are pinned to their account's shard so per-shard
+    // state has a single writer
+    std::uint8_t wireType = buffer.getUInt8(offset);
+    std::uint32_t account_id;
+    if (wireType == TRADE_MSG_TYPE && length == (std::int32_t)(1 + sizeof(TradeExecution))) {
+        std::memcpy(&account_id, buffer.buffer() + offset + 1 + offsetof(TradeExecution, account_id), sizeof(account_id));
+        return shardOf(account_id);
+    }
+    if (wireType == TRADE_CORRECTION_MSG_TYPE && length == (std::int32_t)(1 + sizeof(TradeCorrection))) {
+        std::memcpy(&account_id, buffer.buffer() + offset + 1 + offsetof(TradeCorrection, account_id), sizeof(account_id));
+        return shardOf(account_id);
+    }
+    if (wireType == ORDER_CANCEL_MSG_TYPE && length == (std::int32_t)(1 + sizeof(OrderCancel))) {
+        std::memcpy(&account_id, buffer.buffer() + offset + 1 + offsetof(OrderCancel, account_id), sizeof(account_id));
+        return shardOf(account_id);
+    }
+    if (isCurrentOrderFrame(buffer, offset, length)) {
+        char *data = reinterpret_cast<char *>(buffer.buffer());
+        baseline::MessageHeader header;
+        header.wrap(data, offset, 0, buffer.capacity());
+        baseline::Order decoder;
+        decoder.wrapForDecode(data, offset + header.encodedLength(), header.blockLength(), header.version(), buffer.capacity());
+        return shardOf(decoder.account_id());
+    }
+    // another schema version or an unknown template: its fields cannot be trusted
+    return -1;
+}
+
 void Messaging::listenerLoop() {
-    logWrapper->debug(4, "[Messaging] listenerLoop started");
+    logWrapper->debug(log_id_, "[Messaging] listenerLoop started");
     aeron::FragmentAssembler fragmentAssembler(fragHandler());
     aeron::fragment_handler_t handler = fragmentAssembler.handler();
     aeron::SleepingIdleStrategy sleepStrategy(SLEEP_IDLE_MS);
@@ -88,12 +160,12 @@ void Messaging::listenerLoop() {
         std::int32_t fragmentsRead = subscription_->poll(handler, MAX_FRAGMENT_BATCH_SIZE);
         sleepStrategy.idle(fragmentsRead);
     }
-    logWrapper->debug(4, "[Messaging] Listener thread exiting");
+    logWrapper->debug(log_id_, "[Messaging] Listener thread exiting");
 }
 
 bool Messaging::sendTradeExecution(const TradeExecution &trade) {
     // Serialize: 1 byte for type, then struct bytes
-    std::uint8_t msgType = 2;
+    std::uint8_t msgType = TRADE_MSG_TYPE;
     std::uint8_t bufferData[1 + sizeof(TradeExecution)];
     bufferData[0] = msgType;
     std::memcpy(bufferData + 1, &trade, sizeof(TradeExecution));
@@ -101,13 +173,76 @@ bool Messaging::sendTradeExecution(const TradeExecution &trade) {
     aeron::AtomicBuffer srcBuffer(bufferData, sizeof(bufferData));
     std::int64_t result = publication_->offer(srcBuffer, 0, sizeof(bufferData));
     if (result < 0) {
-        logWrapper->error(4, "[Messaging] Failed to send trade execution; offer returned {}", result);
+        logWrapper->error(log_id_, "[Messaging] Failed to send trade execution; offer returned {}", result);
         return false;
     }
     return true;
 }
 
-std::array<ShardedQueue, NUM_SHARDS>& Messaging::getQueue() {
+int Messaging::pollMarketData(MarketDataConflator &conflator) {
+    if (!md_subscription_) return 0;
+    return md_subscription_->poll(
+        [&conflator](const aeron::AtomicBuffer &buffer, std::int32_t offset, std::int32_t length, const aeron::Header &) {
+            // fixed-size frames: anything else is not a market-data update
+            if (length != (std::int32_t)(1 + sizeof(MarketDataUpdate)) || buffer.getUInt8(offset) != MD_MSG_TYPE) {
+                return;
+            }
+            MarketDataUpdate update;
+            std::memcpy(&update, buffer.buffer() + offset + 1, sizeof(MarketDataUpdate));
+            conflator.offer(update);
+        },
+        MAX_MD_FRAGMENT_BATCH_SIZE);
+}
+
+bool Messaging::sendVcmTransition(const VcmTransition &transition) {
+    // Same framing as trades: 1 byte for type, then struct bytes
+    std::uint8_t msgType = VCM_MSG_TYPE;
+    std::uint8_t bufferData[1 + sizeof(VcmTransition)];
+    bufferData[0] = msgType;
+    std::memcpy(bufferData + 1, &transition, sizeof(VcmTransition));
+
+    if (!vcm_publication_) {
+        return false;
+    }
+    aeron::AtomicBuffer srcBuffer(bufferData, sizeof(bufferData));
+    std::int64_t result = vcm_publication_->offer(srcBuffer, 0, sizeof(bufferData));
+    if (result < 0) {
+        logWrapper->error(log_id_, "[Messaging] Failed to send VCM transition; offer returned {}", result);
+        return false;
+    }
+    return true;
+}
+
+int Messaging::publishLiquidations(LiquidationEngine &engine) {
+    if (!liquidation_publication_) return 0;
+    for (uint32_t shard = 0; shard < shard_layout.shards(); ++shard) {
+        engine.drain(shard, [this](const LiquidationOrder &order) { liquidation_backlog_.push_back(order); });
+    }
+    int published = 0;
+    size_t kept = 0;
+    std::uint8_t bufferData[1 + sizeof(LiquidationOrder)];
+    bufferData[0] = LIQUIDATION_MSG_TYPE;
+    for (size_t i = 0; i < liquidation_backlog_.size(); ++i) {
+        const LiquidationOrder &order = liquidation_backlog_[i];
+        std::memcpy(bufferData + 1, &order, sizeof(LiquidationOrder));
+        aeron::AtomicBuffer srcBuffer(bufferData, sizeof(bufferData));
+        std::int64_t result = liquidation_publication_->offer(srcBuffer, 0, sizeof(bufferData));
+        if (result < 0) {
+            // back pressure or not connected: keep it, in order
+            liquidation_backlog_[kept++] = order;
+            continue;
+        }
+        engine.onPublished(order, utils::nowNs());
+        ++published;
+    }
+    if (kept > 0 && published == 0) {
+        logWrapper->error(log_id_, "[Messaging] Liquidation publication refusing offers; {} orders pending", kept);
+    }
+    liquidation_backlog_.resize(kept);
+    return published;
+}
+
+std::vector<ShardedQueue>& Messaging::getQueue() {
         return  sharded_queue;
 }
 
@@ -119,7 +254,10 @@ void Messaging::shutdown() {
         listenerThread_.join();
     }
     publication_.reset();
+    vcm_publication_.reset();
+    liquidation_publication_.reset();
     subscription_.reset();
+    md_subscription_.reset();
     aeron_.reset();
-    logWrapper->debug(4, "[Messaging] Shutdown complete");
+    logWrapper->debug(log_id_, "[Messaging] Shutdown complete");
 }
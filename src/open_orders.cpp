@@ -0,0 +1,68 @@
+//
+// Created by muhammad-abdullah on 6/18/25.
+//
+
+// File: src/open_orders.cpp
+#include "open_orders.h"
+#include "limit_tree.h"
+#include "credit_manager.h"
+#include "price_scale.h"
+#include <algorithm>
+#include <cmath>
+
+bool rms::OpenOrderTracker::onAccepted(const Order &order) {
+    int shard = shardOf(order.account_id);
+    OpenOrder open{order.account_id, order.instrument_id, order.quantity, order.price, isBuy(order)};
+    if (!open_order_store[shard].emplace(order.order_id, open).second) {
+        return false;
+    }
+    auto &exp = open_exposure_store[shard][positionKey(order.account_id, order.instrument_id)];
+    if (open.is_buy) exp.buy_qty += order.quantity;
+    else exp.sell_qty += order.quantity;
+    limit_tree.addUsage(order.account_id, std::abs(price_scales.notional(order.instrument_id, order.quantity, order.price)));
+    return true;
+}
+
+void rms::OpenOrderTracker::onFill(const TradeExecution &trade) {
+    int shard = shardOf(trade.account_id);
+    auto &open_orders = open_order_store[shard];
+    auto it = open_orders.find(trade.order_id);
+    if (it == open_orders.end()) return;
+    int64_t filled = std::min<int64_t>(trade.quantity, it->second.leaves_qty);
+    release(shard, it->second, filled);
+    it->second.leaves_qty -= filled;
+    if (it->second.leaves_qty <= 0) open_orders.erase(it);
+}
+
+bool rms::OpenOrderTracker::onCancel(uint32_t account_id, uint64_t order_id) {
+    int shard = shardOf(account_id);
+    auto &open_orders = open_order_store[shard];
+    auto it = open_orders.find(order_id);
+    if (it == open_orders.end()) return false;
+    release(shard, it->second, it->second.leaves_qty);
+    open_orders.erase(it);
+    return true;
+}
+
+bool rms::OpenOrderTracker::isOpen(uint32_t account_id, uint64_t order_id) const {
+    return open_order_store[shardOf(account_id)].contains(order_id);
+}
+
+OpenExposure rms::OpenOrderTracker::exposure(uint32_t account_id, uint32_t instrument_id) const {
+    const auto &exp_map = open_exposure_store[shardOf(account_id)];
+    auto it = exp_map.find(positionKey(account_id, instrument_id));
+    return it == exp_map.end() ? OpenExposure{} : it->second;
+}
+
+void rms::OpenOrderTracker::release(int shard, const OpenOrder &open, int64_t qty) {
+    double notional = std::abs(price_scales.notional(open.instrument_id, qty, open.price));
+    limit_tree.addUsage(open.account_id, -notional);
+    credit_manager.adjust(open.account_id, -notional);
+    auto &exp_map = open_exposure_store[shard];
+    auto it = exp_map.find(positionKey(open.account_id, open.instrument_id));
+    if (it == exp_map.end()) return;
+    if (open.is_buy) it->second.buy_qty -= qty;
+    else it->second.sell_qty -= qty;
+    // drop idle entries so accounts cycling through many instruments stay bounded
+    if (it->second.buy_qty == 0 && it->second.sell_qty == 0) exp_map.erase(it);
+}
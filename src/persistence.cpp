@@ -3,6 +3,7 @@
 //
 // File: src/persistence.cpp
 #include "persistence.h"
+#include "price_scale.h"
 #include <folly/json.h>
 #include <sstream>
 #include <filesystem>
@@ -192,13 +193,14 @@ void PersistenceManager::loadPositions(int shard_id, folly::F14FastMap<uint32_t,
     }
 }
 
-void PersistenceManager::saveAccountLimits(int shard_id, const AccountLimitsShard& limits) {
+void PersistenceManager::saveAccountLimits(int shard_id, const AccountLimitTable& limits) {
     try {
         rocksdb::WriteBatch batch;
 
-        for (size_t i = 0; i < limits.size(); ++i) {
-            auto key = makeAccountLimitsKey(shard_id, i);
-            auto value = serializeAccountLimits(limits[i]);
+        // keyed by account_id: slots are handed out in arrival order and differ across restarts
+        for (uint32_t slot = 0; slot < rms::shard_layout.assigned(shard_id); ++slot) {
+            auto key = makeAccountLimitsKey(shard_id, rms::shard_layout.accountAt(shard_id, slot));
+            auto value = serializeAccountLimits(limits.get(slot));
             batch.Put(account_limits_cf_, key, value);
         }
 
@@ -213,7 +215,7 @@ void PersistenceManager::saveAccountLimits(int shard_id, const AccountLimitsShar
     }
 }
 
-void PersistenceManager::loadAccountLimits(int shard_id, AccountLimitsShard& limits) {
+void PersistenceManager::loadAccountLimits(int shard_id, AccountLimitTable& limits) {
     try {
         rocksdb::ReadOptions read_options;
         read_options.fill_cache = false;
@@ -221,9 +223,13 @@ void PersistenceManager::loadAccountLimits(int shard_id, AccountLimitsShard& lim
         auto prefix = std::to_string(shard_id) + ":acc:";
         auto it = db_->NewIterator(read_options, account_limits_cf_);
         for (it->Seek(prefix); it->Valid() && it->key().starts_with(prefix); it->Next()) {
-            auto account_id = std::stoul(it->key().ToString().substr(prefix.length()));
-            auto account_limits = deserializeAccountLimits(it->value().ToString());
-            limits[account_id] = account_limits;
+            auto account_id = (uint32_t)std::stoul(it->key().ToString().substr(prefix.length()));
+            uint32_t slot = rms::shard_layout.assign(account_id);
+            if (slot == rms::ShardLayout::NO_SLOT) {
+                std::cout << "No slot for account " << account_id << " on shard " << shard_id << std::endl;
+                continue;
+            }
+            limits.set(slot, deserializeAccountLimits(it->value().ToString()));
         }
         delete it;
     } catch (const std::exception& e) {
@@ -231,13 +237,15 @@ void PersistenceManager::loadAccountLimits(int shard_id, AccountLimitsShard& lim
     }
 }
 
-void PersistenceManager::saveInstrumentLimits(int shard_id, const InstrumentLimitsShard& limits) {
+// Instrument limits are one table for all shards, kept under shard 0's keys
+void PersistenceManager::saveInstrumentLimits(const InstrumentLimitTable& limits) {
+    const int shard_id = 0;
     try {
         rocksdb::WriteBatch batch;
 
-        for (size_t i = 0; i < limits.size(); ++i) {
+        for (uint32_t i = 0; i < NUM_INSTRUMENTS; ++i) {
             auto key = makeInstrumentLimitsKey(shard_id, i);
-            auto value = serializeInstrumentLimits(limits[i]);
+            auto value = serializeInstrumentLimits(limits.get(i));
             batch.Put(instrument_limits_cf_, key, value);
         }
 
@@ -252,7 +260,8 @@ void PersistenceManager::saveInstrumentLimits(int shard_id, const InstrumentLimi
     }
 }
 
-void PersistenceManager::loadInstrumentLimits(int shard_id, InstrumentLimitsShard& limits) {
+void PersistenceManager::loadInstrumentLimits(InstrumentLimitTable& limits) {
+    const int shard_id = 0;
     try {
         rocksdb::ReadOptions read_options;
         read_options.fill_cache = false;
@@ -261,8 +270,9 @@ void PersistenceManager::loadInstrumentLimits(int shard_id, InstrumentLimitsShar
         auto it = db_->NewIterator(read_options, instrument_limits_cf_);
         for (it->Seek(prefix); it->Valid() && it->key().starts_with(prefix); it->Next()) {
             auto instrument_id = std::stoul(it->key().ToString().substr(prefix.length()));
-            auto instrument_limits = deserializeInstrumentLimits(it->value().ToString());
-            limits[instrument_id] = instrument_limits;
+            if (instrument_id < NUM_INSTRUMENTS) {
+                limits.set(instrument_id, deserializeInstrumentLimits(it->value().ToString()));
+            }
         }
         delete it;
     } catch (const std::exception& e) {
@@ -329,8 +339,7 @@ std::string PersistenceManager::serializePosition(const Position& pos) {
         ("net_qty", pos.net_qty)
         ("avg_entry_price", pos.avg_entry_price)
         ("realized_pnl", pos.realized_pnl)
-        ("unrealized_pnl", pos.unrealized_pnl)
-        ("peak_equity", pos.peak_equity);
+        ("unrealized_pnl", pos.unrealized_pnl);
     return folly::toJson(json);
 }
 
@@ -341,7 +350,6 @@ Position PersistenceManager::deserializePosition(const std::string& data) {
     pos.avg_entry_price = json["avg_entry_price"].asDouble();
     pos.realized_pnl = json["realized_pnl"].asDouble();
     pos.unrealized_pnl = json["unrealized_pnl"].asDouble();
-    pos.peak_equity = json["peak_equity"].asDouble();
     return pos;
 }
 
@@ -391,6 +399,11 @@ InstrumentLimits PersistenceManager::deserializeInstrumentLimits(const std::stri
     return limits;
 }
 
+// Records written before prices were fixed-point hold a double
+static FixedPrice deserializePrice(const folly::dynamic& value, uint32_t instrument_id) {
+    return value.isDouble() ? price_scales.toFixed(instrument_id, value.asDouble()) : value.asInt();
+}
+
 std::string PersistenceManager::serializeOrder(const Order& order) {
     folly::dynamic json = folly::dynamic::object
         ("order_id", order.order_id)
@@ -410,7 +423,7 @@ Order PersistenceManager::deserializeOrder(const std::string& data) {
     order.account_id = json["account_id"].asInt();
     order.instrument_id = json["instrument_id"].asInt();
     order.quantity = json["quantity"].asInt();
-    order.price = json["price"].asDouble();
+    order.price = deserializePrice(json["price"], order.instrument_id);
     //strncpy(order.symbol, json["symbol"].asString().c_str(), sizeof(order.symbol) - 1);
     //strncpy(order.side, json["side"].asString().c_str(), sizeof(order.side) - 1);
     return order;
@@ -425,6 +438,7 @@ std::string PersistenceManager::serializeTrade(const TradeExecution& trade) {
         ("price", trade.price)
         ("symbol", trade.symbol)
         ("is_buy", trade.is_buy)
+        ("venue_id", trade.venue_id)
         ("trade_id", trade.trade_id);
     return folly::toJson(json);
 }
@@ -436,9 +450,10 @@ TradeExecution PersistenceManager::deserializeTrade(const std::string& data) {
     trade.account_id = json["account_id"].asInt();
     trade.instrument_id = json["instrument_id"].asInt();
     trade.quantity = json["quantity"].asInt();
-    trade.price = json["price"].asDouble();
+    trade.price = deserializePrice(json["price"], trade.instrument_id);
     strncpy(trade.symbol, json["symbol"].asString().c_str(), sizeof(trade.symbol) - 1);
     trade.is_buy = json["is_buy"].asBool();
+    trade.venue_id = json.getDefault("venue_id", 0).asInt();
     trade.trade_id = json["trade_id"].asInt();
     return trade;
 }
@@ -5,44 +5,73 @@
 // File: src/posttrade_controls.cpp
 #include "posttrade_controls.h"
 #include "data_types.h"
+#include "limit_tree.h"
+#include "credit_manager.h"
+#include "volume_windows.h"
+#include "mark_to_market.h"
+#include "scenario_margin.h"
+#include "historical_var.h"
+#include "liquidation.h"
+#include "price_scale.h"
+#include "utils/time_utils.h"
 #include <algorithm>
 
-void rms::PostTradeControls::onTrade(const TradeExecution &trade) {
-    int shard = trade.account_id % NUM_SHARDS;
-    auto &pos_map = position_store[shard];
-    auto &pos = pos_map[trade.instrument_id];
-    int64_t signed_qty = trade.is_buy ? trade.quantity : -trade.quantity;
-    if ((pos.net_qty > 0 && signed_qty < 0) || (pos.net_qty < 0 && signed_qty > 0)) {
-        int64_t close_qty = std::min<int64_t>(std::abs(pos.net_qty), std::abs(signed_qty));
-        double exit_price = trade.price;
-        double pnl = (pos.net_qty > 0)
-            ? (exit_price - pos.avg_entry_price) * close_qty
-            : (pos.avg_entry_price - exit_price) * close_qty;
-        pos.realized_pnl += pnl;
-        pos.net_qty += signed_qty;
-        if (pos.net_qty == 0) pos.avg_entry_price = 0;
-    } else {
-        int64_t new_qty = pos.net_qty + signed_qty;
-        if (new_qty != 0) {
-            double new_avg = ((pos.avg_entry_price * pos.net_qty) + (trade.price * signed_qty)) / (double)new_qty;
-            pos.avg_entry_price = new_avg;
-        }
-        pos.net_qty = new_qty;
-    }
-    double mark_price = trade.price; // stub
-    pos.unrealized_pnl = (mark_price - pos.avg_entry_price) * pos.net_qty;
-    double equity = pos.realized_pnl + pos.unrealized_pnl;
-    pos.peak_equity = std::max(pos.peak_equity, equity);
-    const auto &acct_lim = account_limits_shards[shard][trade.account_id % ACCOUNTS_PER_SHARD];
-    //double used_margin = std::abs(pos.net_qty) * pos.avg_entry_price * acct_lim.init_margin_pct;
-    //double maint_margin = std::abs(pos.net_qty) * pos.avg_entry_price * acct_lim.maint_margin_pct;
-    //testing purpose
-    double maint_margin = 5;
-    if (equity < maint_margin) {
-        // stub auto square-off
-    }
-    double drawdown_pct = (pos.peak_equity - equity) / pos.peak_equity;
-    if (drawdown_pct > acct_lim.max_drawdown_pct) {
-        // stub MDD liquidation
-    }
-}
\ No newline at end of file
+bool rms::PostTradeControls::onTrade(const TradeExecution &trade) {
+    // instrument_id indexes the price scales, position and ledger keys: check it before any of them
+    if (trade.instrument_id >= NUM_INSTRUMENTS) return false;
+    TradeSeen seen = dedupe_.check(trade.venue_id, trade.trade_id);
+    // below the window the bitmap cannot tell; the ledger holds every id of the day
+    if (seen == TradeSeen::Duplicate ||
+        (seen == TradeSeen::Unknown && ledger_.applied(trade.venue_id, trade.trade_id))) return false;
+    int shard = shardOf(trade.account_id);
+    auto &pos = position_store[shard].findOrInsert(trade.account_id, trade.instrument_id);
+    open_orders_.onFill(trade);
+    // before the position moves, so re-checking the account does not count the fill twice
+    liquidations.onFill(trade);
+    uint64_t now_ms = utils::coarseNowMs();
+    volume_windows.onTrade(trade.account_id, trade.instrument_id, trade.quantity,
+                           std::abs(price_scales.notional(trade.instrument_id, trade.quantity, trade.price)), now_ms);
+    double gross_before = std::abs((double)pos.net_qty) * pos.avg_entry_price;
+    // FIFO: closes the oldest opposite lots first, realizing PnL against their prices
+    ledger_.onFill(trade, pos);
+    onPositionChanged(trade.account_id, trade.instrument_id, pos, gross_before,
+                      price_scales.toDouble(trade.instrument_id, trade.price), now_ms);
+    return true;
+}
+
+bool rms::PostTradeControls::onCorrection(const TradeCorrection &correction) {
+    if (correction.instrument_id >= NUM_INSTRUMENTS) return false;
+    int shard = shardOf(correction.account_id);
+    auto &pos = position_store[shard].findOrInsert(correction.account_id, correction.instrument_id);
+    double gross_before = std::abs((double)pos.net_qty) * pos.avg_entry_price;
+    bool applied = correction.kind == TradeCorrectionKind::Bust
+        ? ledger_.bust(correction.venue_id, correction.trade_id, correction.account_id, correction.instrument_id, pos)
+        : ledger_.correct(correction.venue_id, correction.trade_id, correction.account_id, correction.instrument_id,
+                          correction.quantity, correction.price, pos);
+    if (!applied) return false;
+    onPositionChanged(correction.account_id, correction.instrument_id, pos, gross_before,
+                      pos.avg_entry_price > 0.0 ? pos.avg_entry_price
+                                                : price_scales.toDouble(correction.instrument_id, correction.price),
+                      utils::coarseNowMs());
+    return true;
+}
+
+void rms::PostTradeControls::resetSession() {
+    // the ledger rebuilds each book from its position on the next fill
+    ledger_.clear();
+    dedupe_.clear();
+}
+
+void rms::PostTradeControls::onPositionChanged(uint32_t account_id, uint32_t instrument_id, Position &pos,
+                                               double gross_before, double mark, uint64_t now_ms) {
+    double gross_delta = std::abs((double)pos.net_qty) * pos.avg_entry_price - gross_before;
+    limit_tree.addUsage(account_id, gross_delta);
+    credit_manager.adjust(account_id, gross_delta);
+    // marks at the reference price, or the given price until the instrument has one
+    mark_to_market.onPosition(account_id, instrument_id, pos, mark);
+    pos.unrealized_pnl = mark_to_market.unrealizedPnl(account_id, instrument_id, pos);
+    scenario_margin.onPosition(account_id, instrument_id, pos);
+    historical_var.onPosition(account_id, instrument_id, pos, mark);
+    // account drawdown from its high-water mark, then equity below maintenance margin
+    liquidations.checkAccount(account_id, now_ms);
+}
@@ -0,0 +1,159 @@
+//
+// Created by muhammad-abdullah on 6/12/25.
+//
+
+// File: src/pretrade_batch.cpp
+#include "pretrade_batch.h"
+#include "pretrade_checks.h"
+#include "price_scale.h"
+#include <immintrin.h>
+#include <cstdlib>
+
+namespace {
+    using rms::BatchRejects;
+    using rms::PreTradeLanes;
+
+    uint64_t validMask(uint32_t count) {
+        return count >= 64 ? ~0ULL : (1ULL << count) - 1;
+    }
+
+    // Reference kernel. All lanes are integers, so the compares are exact and the
+    // SIMD kernels agree with it bit for bit.
+    void evaluateScalar(const PreTradeLanes &l, BatchRejects &r) {
+        for (uint32_t i = 0; i < l.count; ++i) {
+            uint64_t bit = 1ULL << i;
+            if (l.qty[i] > l.max_qty[i]) r.max_qty |= bit;
+            if (std::abs(l.notional[i]) > l.max_notional[i]) r.notional |= bit;
+            if (l.ref_price[i] > 0 && std::abs(l.price[i] - l.ref_price[i]) > l.band[i]) r.price_band |= bit;
+            if (std::abs(l.position[i]) > l.max_position[i]) r.position |= bit;
+        }
+    }
+
+    // |x| > limit for limit >= 0; no 64-bit abs before AVX-512, so test both sides
+    __attribute__((target("avx2")))
+    inline __m256i outsideAvx2(__m256i x, __m256i limit) {
+        __m256i neg_limit = _mm256_sub_epi64(_mm256_setzero_si256(), limit);
+        return _mm256_or_si256(_mm256_cmpgt_epi64(x, limit), _mm256_cmpgt_epi64(neg_limit, x));
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i loadAvx2(const int64_t *lane, uint32_t i) {
+        return _mm256_load_si256(reinterpret_cast<const __m256i *>(lane + i));
+    }
+
+    __attribute__((target("avx2")))
+    inline uint64_t maskAvx2(__m256i m) {
+        return _mm256_movemask_pd(_mm256_castsi256_pd(m));
+    }
+
+    // Lanes past count hold whatever the previous batch left there; the
+    // kernels read them (arrays are full width) and the caller masks them off.
+    __attribute__((target("avx2")))
+    void evaluateAvx2(const PreTradeLanes &l, BatchRejects &r) {
+        const __m256i zero = _mm256_setzero_si256();
+        for (uint32_t i = 0; i < l.count; i += 4) {
+            uint64_t qty_bits = maskAvx2(_mm256_cmpgt_epi64(loadAvx2(l.qty, i), loadAvx2(l.max_qty, i)));
+            uint64_t notional_bits = maskAvx2(outsideAvx2(loadAvx2(l.notional, i), loadAvx2(l.max_notional, i)));
+
+            __m256i ref = loadAvx2(l.ref_price, i);
+            __m256i dev = _mm256_sub_epi64(loadAvx2(l.price, i), ref);
+            __m256i has_ref = _mm256_cmpgt_epi64(ref, zero);
+            uint64_t band_bits = maskAvx2(_mm256_and_si256(outsideAvx2(dev, loadAvx2(l.band, i)), has_ref));
+
+            uint64_t pos_bits = maskAvx2(outsideAvx2(loadAvx2(l.position, i), loadAvx2(l.max_position, i)));
+
+            r.max_qty |= qty_bits << i;
+            r.notional |= notional_bits << i;
+            r.price_band |= band_bits << i;
+            r.position |= pos_bits << i;
+        }
+    }
+
+    __attribute__((target("avx512f")))
+    void evaluateAvx512(const PreTradeLanes &l, BatchRejects &r) {
+        const __m512i zero = _mm512_setzero_si512();
+        for (uint32_t i = 0; i < l.count; i += 8) {
+            uint64_t qty_bits = _mm512_cmpgt_epi64_mask(_mm512_load_si512(l.qty + i), _mm512_load_si512(l.max_qty + i));
+
+            __m512i notional = _mm512_abs_epi64(_mm512_load_si512(l.notional + i));
+            uint64_t notional_bits = _mm512_cmpgt_epi64_mask(notional, _mm512_load_si512(l.max_notional + i));
+
+            __m512i ref = _mm512_load_si512(l.ref_price + i);
+            __m512i dev = _mm512_abs_epi64(_mm512_sub_epi64(_mm512_load_si512(l.price + i), ref));
+            __mmask8 has_ref = _mm512_cmpgt_epi64_mask(ref, zero);
+            uint64_t band_bits = _mm512_mask_cmpgt_epi64_mask(has_ref, dev, _mm512_load_si512(l.band + i));
+
+            __m512i worst = _mm512_abs_epi64(_mm512_load_si512(l.position + i));
+            uint64_t pos_bits = _mm512_cmpgt_epi64_mask(worst, _mm512_load_si512(l.max_position + i));
+
+            r.max_qty |= qty_bits << i;
+            r.notional |= notional_bits << i;
+            r.price_band |= band_bits << i;
+            r.position |= pos_bits << i;
+        }
+    }
+}
+
+void rms::PreTradeBatch::gather(const Order &order, double reference_price) {
+    uint32_t i = lanes_.count++;
+    const auto &lim = instrument_limits;
+    uint32_t inst = order.instrument_id;
+
+    lanes_.qty[i] = order.quantity;
+    lanes_.max_qty[i] = (int64_t)lim.max_order_qty[inst];
+    FixedPrice ref = price_scales.toFixed(order.instrument_id, reference_price);
+    lanes_.notional[i] = PriceScales::notionalUnits(order.quantity, order.price);
+    lanes_.max_notional[i] = price_scales.toUnits(order.instrument_id, lim.max_order_notional[inst]);
+    lanes_.price[i] = order.price;
+    lanes_.ref_price[i] = ref;
+    lanes_.band[i] = PriceScales::fraction(ref, lim.price_tolerance_pct[inst]);
+    lanes_.position[i] = PreTradeChecks::worstCasePosition(order);
+    lanes_.max_position[i] = (int64_t)lim.max_daily_position[inst];
+}
+
+rms::BatchRejects rms::PreTradeBatch::evaluate() const {
+    return evaluate(detectIsa());
+}
+
+rms::BatchRejects rms::PreTradeBatch::evaluate(BatchIsa isa) const {
+    BatchRejects rejects;
+    if (lanes_.count == 0) return rejects;
+    if (!isaSupported(isa)) isa = BatchIsa::Scalar;
+    switch (isa) {
+        case BatchIsa::Avx512: evaluateAvx512(lanes_, rejects); break;
+        case BatchIsa::Avx2:   evaluateAvx2(lanes_, rejects); break;
+        default:               evaluateScalar(lanes_, rejects); break;
+    }
+    uint64_t valid = validMask(lanes_.count);
+    rejects.max_qty &= valid;
+    rejects.notional &= valid;
+    rejects.price_band &= valid;
+    rejects.position &= valid;
+    return rejects;
+}
+
+rms::BatchIsa rms::PreTradeBatch::detectIsa() {
+    static const BatchIsa isa = [] {
+        if (isaSupported(BatchIsa::Avx512)) return BatchIsa::Avx512;
+        if (isaSupported(BatchIsa::Avx2)) return BatchIsa::Avx2;
+        return BatchIsa::Scalar;
+    }();
+    return isa;
+}
+
+bool rms::PreTradeBatch::isaSupported(BatchIsa isa) {
+    __builtin_cpu_init();
+    switch (isa) {
+        case BatchIsa::Avx512: return __builtin_cpu_supports("avx512f");
+        case BatchIsa::Avx2:   return __builtin_cpu_supports("avx2");
+        default:               return true;
+    }
+}
+
+const char *rms::PreTradeBatch::isaName(BatchIsa isa) {
+    switch (isa) {
+        case BatchIsa::Avx512: return "avx512";
+        case BatchIsa::Avx2:   return "avx2";
+        default:               return "scalar";
+    }
+}
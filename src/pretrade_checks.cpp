@@ -3,27 +3,94 @@
 //
 // File: src/pretrade_checks.cpp
 #include "pretrade_checks.h"
+#include "limit_tree.h"
+#include "instrument_lists.h"
+#include "volume_windows.h"
+#include "reference_price.h"
+#include "mark_to_market.h"
+#include "price_scale.h"
 
 #include <iostream>
 
 bool rms::PreTradeChecks::checkMaxOrderQty(const Order &order) {
-    int shard = order.account_id % NUM_SHARDS;
-    const auto &lim = instrument_limits_shards[shard][order.instrument_id];
-    return order.quantity <= (int64_t)lim.max_order_qty;
+    return order.quantity <= (int64_t)instrument_limits.max_order_qty[order.instrument_id];
+}
+
+bool rms::PreTradeChecks::checkMaxOrderNotional(const Order &order) {
+    return std::abs(PriceScales::notionalUnits(order.quantity, order.price))
+        <= price_scales.toUnits(order.instrument_id, instrument_limits.max_order_notional[order.instrument_id]);
 }
 
 bool rms::PreTradeChecks::checkPriceBand(const Order &order, double reference_price) {
-    int shard = order.instrument_id % NUM_SHARDS;
-    const auto &lim = instrument_limits_shards[shard][order.instrument_id];
-    double tol = lim.price_tolerance_pct * reference_price;
-    return std::abs(order.price - reference_price) <= tol;
+    FixedPrice ref = price_scales.toFixed(order.instrument_id, reference_price);
+    return std::abs(order.price - ref)
+        <= PriceScales::fraction(ref, instrument_limits.price_tolerance_pct[order.instrument_id]);
+}
+
+bool rms::PreTradeChecks::checkTickSize(const Order &order) {
+    return order.price > 0 && price_scales.onTick(order.instrument_id, order.price);
+}
+
+bool rms::PreTradeChecks::checkPriceBand(const Order &order) {
+    double ref = reference_prices.reference(order.instrument_id);
+    return ref <= 0.0 || checkPriceBand(order, ref);
 }
 
 bool rms::PreTradeChecks::checkPositionLimit(const Order &order) {
-    int shard = order.account_id % NUM_SHARDS;
-    auto &pos_map = position_store[shard];
-    auto it = pos_map.find(order.instrument_id);
-    int64_t curr_pos = (it == pos_map.end() ? 0LL : it->second.net_qty);
-    const auto &lim = instrument_limits_shards[shard][order.instrument_id];
-    return std::abs(curr_pos + order.quantity) <= (int64_t)lim.max_daily_position;
+    return std::abs(worstCasePosition(order)) <= (int64_t)instrument_limits.max_daily_position[order.instrument_id];
+}
+
+bool rms::PreTradeChecks::checkLimitTree(const Order &order) {
+    return limit_tree.check(order.account_id, std::abs(price_scales.notional(order.instrument_id, order.quantity, order.price)));
+}
+
+bool rms::PreTradeChecks::checkRestricted(const Order &order) {
+    return !instrument_lists.contains(InstrumentListKind::Restricted, order.instrument_id);
+}
+
+bool rms::PreTradeChecks::checkShortSell(const Order &order) {
+    if (isBuy(order) || !instrument_lists.contains(InstrumentListKind::HardToBorrow, order.instrument_id)) {
+        return true;
+    }
+    return worstCasePosition(order) >= 0;
+}
+
+bool rms::PreTradeChecks::checkWindowVolume(const Order &order, uint64_t now_ms) {
+    uint32_t max_qty = instrument_limits.max_window_qty[order.instrument_id];
+    double max_notional = instrument_limits.max_window_notional[order.instrument_id];
+    if (max_qty == 0 && max_notional <= 0.0) return true;
+    WindowVolume traded = volume_windows.volume(order.account_id, order.instrument_id, now_ms);
+    if (max_qty != 0 && traded.qty + order.quantity > (int64_t)max_qty) {
+        return false;
+    }
+    return max_notional <= 0.0
+        || traded.notional + std::abs(price_scales.notional(order.instrument_id, order.quantity, order.price)) <= max_notional;
+}
+
+bool rms::PreTradeChecks::checkInitialMargin(const Order &order) {
+    int shard = shardOf(order.account_id);
+    uint32_t slot = shard_layout.slot(order.account_id);
+    if (slot == ShardLayout::NO_SLOT || account_limits[shard].initial_equity[slot] <= 0.0) return true;
+    const Position *pos = position_store[shard].find(order.account_id, order.instrument_id);
+    int64_t curr_pos = (pos == nullptr ? 0LL : pos->net_qty);
+    // only the gross the order adds needs margin; a reducing order always passes
+    int64_t added_qty = std::abs(worstCasePosition(order)) - std::abs(curr_pos);
+    if (added_qty <= 0) return true;
+    double mark = reference_prices.reference(order.instrument_id);
+    if (mark <= 0.0) mark = price_scales.toDouble(order.instrument_id, order.price);
+    double added_margin = (double)added_qty * mark * instrument_limits.init_margin_pct[order.instrument_id];
+    return mark_to_market.initMargin(order.account_id) + added_margin <= mark_to_market.equity(order.account_id);
+}
+
+int64_t rms::PreTradeChecks::worstCasePosition(const Order &order) {
+    int shard = shardOf(order.account_id);
+    const Position *pos = position_store[shard].find(order.account_id, order.instrument_id);
+    int64_t curr_pos = (pos == nullptr ? 0LL : pos->net_qty);
+    auto &exp_map = open_exposure_store[shard];
+    auto eit = exp_map.find(positionKey(order.account_id, order.instrument_id));
+    OpenExposure open = (eit == exp_map.end() ? OpenExposure{} : eit->second);
+    // every working order on the order's side fills, none on the other side do
+    return isBuy(order)
+        ? curr_pos + open.buy_qty + order.quantity
+        : curr_pos - open.sell_qty - order.quantity;
 }
\ No newline at end of file
@@ -0,0 +1,36 @@
+//
+// Created by muhammad-abdullah on 7/28/25.
+//
+
+// File: src/price_scale.cpp
+#include "price_scale.h"
+#include <cmath>
+
+rms::PriceScales rms::price_scales;
+
+rms::PriceScales::PriceScales() {
+    clear();
+}
+
+bool rms::PriceScales::setDecimals(uint32_t instrument_id, uint8_t decimals) {
+    if (instrument_id >= NUM_INSTRUMENTS || decimals > MAX_DECIMALS) return false;
+    int64_t scale = 1;
+    for (uint8_t d = 0; d < decimals; ++d) scale *= 10;
+    decimals_[instrument_id] = decimals;
+    scale_[instrument_id] = scale;
+    tick_[instrument_id] = 1;
+    return true;
+}
+
+bool rms::PriceScales::setTickSize(uint32_t instrument_id, double tick_size) {
+    if (instrument_id >= NUM_INSTRUMENTS || !(tick_size > 0.0)) return false;
+    FixedPrice tick = toFixed(instrument_id, tick_size);
+    // 0.05 at two decimals is 5 units; 0.005 is not representable there
+    if (tick <= 0 || std::abs(toDouble(instrument_id, tick) - tick_size) > 1e-9 * tick_size) return false;
+    tick_[instrument_id] = tick;
+    return true;
+}
+
+void rms::PriceScales::clear() {
+    for (uint32_t i = 0; i < NUM_INSTRUMENTS; ++i) setDecimals(i, DEFAULT_DECIMALS);
+}
@@ -0,0 +1,82 @@
+//
+// Created by muhammad-abdullah on 7/14/25.
+//
+
+// File: src/reference_price.cpp
+#include "reference_price.h"
+#include <algorithm>
+
+rms::ReferencePriceEngine rms::reference_prices;
+
+rms::ReferencePriceEngine::ReferencePriceEngine() {
+    std::fill_n(policy_, NUM_INSTRUMENTS, RefPricePolicy::Mid);
+    std::fill_n(mid_, NUM_INSTRUMENTS, 0.0);
+    std::fill_n(settlement_, NUM_INSTRUMENTS, 0.0);
+    resetSession();
+}
+
+void rms::ReferencePriceEngine::setPolicy(uint32_t instrument_id, RefPricePolicy policy) {
+    if (instrument_id >= NUM_INSTRUMENTS) return;
+    policy_[instrument_id] = policy;
+    publish(instrument_id);
+}
+
+void rms::ReferencePriceEngine::setSettlement(uint32_t instrument_id, double price) {
+    if (instrument_id >= NUM_INSTRUMENTS) return;
+    settlement_[instrument_id] = price;
+    publish(instrument_id);
+}
+
+void rms::ReferencePriceEngine::resetSession() {
+    std::fill_n(last_, NUM_INSTRUMENTS, 0.0);
+    std::fill_n(pv_sum_, NUM_INSTRUMENTS, 0.0);
+    std::fill_n(qty_sum_, NUM_INSTRUMENTS, 0.0);
+    for (uint32_t i = 0; i < NUM_INSTRUMENTS; ++i) publish(i);
+}
+
+void rms::ReferencePriceEngine::onTrade(uint32_t instrument_id, double price, int64_t qty) {
+    if (instrument_id >= NUM_INSTRUMENTS || !(price > 0.0)) return;
+    last_[instrument_id] = price;
+    if (qty > 0) {
+        pv_sum_[instrument_id] += price * (double)qty;
+        qty_sum_[instrument_id] += (double)qty;
+    }
+}
+
+void rms::ReferencePriceEngine::onQuote(uint32_t instrument_id, double bid, double ask) {
+    if (instrument_id >= NUM_INSTRUMENTS) return;
+    mid_[instrument_id] = (bid > 0.0 && ask > 0.0) ? 0.5 * (bid + ask) : 0.0;
+}
+
+void rms::ReferencePriceEngine::publish(uint32_t i) {
+    if (i >= NUM_INSTRUMENTS) return;
+    double ref = 0.0;
+    switch (policy_[i]) {
+        case RefPricePolicy::Mid:
+            ref = mid_[i] > 0.0 ? mid_[i] : last_[i];
+            break;
+        case RefPricePolicy::Last:
+            ref = last_[i] > 0.0 ? last_[i] : mid_[i];
+            break;
+        case RefPricePolicy::Vwap:
+            ref = qty_sum_[i] > 0.0 ? pv_sum_[i] / qty_sum_[i] : (last_[i] > 0.0 ? last_[i] : mid_[i]);
+            break;
+        case RefPricePolicy::Settlement:
+            ref = settlement_[i];
+            break;
+    }
+    ref_[i].store(ref, std::memory_order_relaxed);
+}
+
+double rms::ReferencePriceEngine::vwap(uint32_t instrument_id) const {
+    return qty_sum_[instrument_id] > 0.0 ? pv_sum_[instrument_id] / qty_sum_[instrument_id] : 0.0;
+}
+
+bool rms::ReferencePriceEngine::parsePolicy(const std::string &name, RefPricePolicy &policy) {
+    if (name == "mid") policy = RefPricePolicy::Mid;
+    else if (name == "last") policy = RefPricePolicy::Last;
+    else if (name == "vwap") policy = RefPricePolicy::Vwap;
+    else if (name == "settlement") policy = RefPricePolicy::Settlement;
+    else return false;
+    return true;
+}
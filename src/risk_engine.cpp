@@ -1,7 +1,20 @@
 // File: src/risk_engine.cpp
 #include "risk_engine.h"
 #include "config_loader.h"
+#include "credit_manager.h"
+#include "rule_engine.h"
+#include "volume_windows.h"
+#include "vcm_state.h"
+#include "reference_price.h"
+#include "mark_to_market.h"
+#include "scenario_margin.h"
+#include "historical_var.h"
+#include "price_scale.h"
+#include "liquidation.h"
+#include "session_clock.h"
+#include "instrument_lists.h"
 #include "logger.h"
+#include "utils/time_utils.h"
 #include <iostream>
 
 using namespace rms;
@@ -19,13 +32,33 @@ bool RiskEngine::initialize(const std::string &config_path) {
     }
     std::cout << "initializing the logger: " << config_path << std::endl;
     //initializing logger
-    logger_wrapper_ = std::make_unique<LoggerWrapper>(4, "../log/risk_engine/risk_engine"); 
+    const uint32_t shards = shard_layout.shards();
+    logger_wrapper_ = std::make_unique<LoggerWrapper>((uint8_t)shards, "../log/risk_engine/risk_engine");
+    // per-shard stages for the configured shard count
+    pretrade_checks_ = std::vector<PreTradeChecks>(shards);
+    posttrade_controls_ = std::vector<PostTradeControls>(shards);
+    vcm_ = std::vector<VCMModule>(shards);
+    pretrade_batch_ = std::vector<PreTradeBatch>(shards);
+    dup_filter_ = std::vector<DuplicateOrderFilter>(shards);
+    // a new engine run is a new session for VWAP reference prices and equity high-water marks;
+    // after that the market-data and shard threads reset them at each session_clock boundary
+    reference_prices.resetSession();
+    mark_to_market.resetHighWaterMarks();
+    uint64_t now_ms = utils::nowMs();
+    for (auto &filter : dup_filter_) {
+        filter.init(DuplicateFilterParams{}, now_ms);
+    }
     // Initialize Messaging with callbacks bound to this instance
     bool ok = messaging_.initialize(logger_wrapper_);
     if (!ok) {
         blogger_.error("[RiskEngine] Failed to initialize Messaging");
         return false;
     }
+    vcm_states.setTransitionHandler([this](const VcmTransition &t) {
+        blogger_.info("[RiskEngine] VCM instrument {}: state {} -> {}, reference {}",
+                      t.instrument_id, (int)t.from, (int)t.to, t.reference_price);
+        messaging_.sendVcmTransition(t);
+    });
     return true;
 }
 
@@ -33,10 +66,12 @@ void RiskEngine::start() {
     running_ = true;
 
     // Launch shard threads
-    for (int i = 0; i < NUM_SHARDS; ++i) {
+    for (uint32_t i = 0; i < shard_layout.shards(); ++i) {
         shard_threads_.emplace_back(&RiskEngine::runShard, this, i);
     }
 
+    market_data_thread_ = std::thread(&RiskEngine::runMarketData, this);
+
     blogger_.debug("[RiskEngine] Shard threads started");
     blogger_.debug("[RiskEngine] Listening for messages via Aeron");
     // Messaging already spun up its listener thread in initialize()
@@ -52,31 +87,72 @@ void RiskEngine::stop() {
         }
     }
     shard_threads_.clear();
+    if (market_data_thread_.joinable()) {
+        market_data_thread_.join();
+    }
 
     // Shut down messaging
     messaging_.shutdown();
 
+    for (size_t i = 0; i < custom_rules.size(); ++i) {
+        RuleStats st = custom_rules.stats(i);
+        double avg_cycles = st.sampled ? (double)st.sampled_cycles / st.sampled : 0.0;
+        blogger_.info("[RiskEngine] Rule {}: {} evaluations, {} rejects, {:.1f} cycles avg",
+                      custom_rules.rule(i).name, st.evaluations, st.rejects, avg_cycles);
+    }
+
     blogger_.debug("[RiskEngine] Stopped all threads and messaging");
 }
 
 void RiskEngine::runShard(int shard_id) {
-    logger_wrapper_->debug(shard_id, "[RiskEngine] Running shard");
+    logger_wrapper_->debug(shard_id, "[RiskEngine] Running shard, batch kernel {}",
+                           PreTradeBatch::isaName(PreTradeBatch::detectIsa()));
     aeron::concurrent::BackoffIdleStrategy idle_strategy(100, 1000);
     auto& queue = messaging_.getQueue()[shard_id];
+    std::vector<Order> pending;
+    pending.reserve(MAX_PRETRADE_BATCH_SIZE);
     bool processed = false;
+    uint64_t next_sweep_ms = utils::coarseNowMs() + MTM_SWEEP_INTERVAL_MS;
+    uint64_t next_var_ms = utils::coarseNowMs() + VAR_RECOMPUTE_INTERVAL_MS;
+    // initialize() reset the session state; later boundaries are noticed on the sweep
+    uint64_t session = session_clock.session(utils::nowMs());
+    instrument_lists.online(shard_id);
     while (running_) {
-        for (int i = 0; i < MAX_FRAGMENT_BATCH_SIZE; ++i) {
+        // no instrument set is held across loops, so a replaced one can be freed once every shard got here
+        instrument_lists.quiesce(shard_id);
+        for (int i = 0; i < MAX_PRETRADE_BATCH_SIZE; ++i) {
             auto msg = queue.dequeue();
             if (msg.has_value()) {
                 processed = true;
                 logger_wrapper_->debug(shard_id, "RiskEngine dequeing completed on shard");
-                auto variant = msg.value();
+                auto &variant = msg.value();
                 if (std::holds_alternative<Order>(variant)) {
-                    onOrderReceived(std::get<Order>(variant), shard_id);
+                    Order &order = std::get<Order>(variant);
+                    // instrument_id indexes the limits, scales, reference prices, VCM and L1: check it before gather()
+                    if (order.instrument_id >= NUM_INSTRUMENTS) {
+                        logger_wrapper_->error(shard_id, "[RiskEngine] Order id {} for account {} rejected: unknown instrument {}",
+                                               order.order_id, order.account_id, order.instrument_id);
+                        continue;
+                    }
+                    pending.push_back(std::move(order));
                 }
                 else if (std::holds_alternative<TradeExecution>(variant)) {
+                    // a fill changes positions, so orders queued ahead of it are screened first
+                    onOrderBatch(pending, shard_id);
+                    pending.clear();
                     onTradeReceived(std::get<TradeExecution>(variant), shard_id);
                 }
+                else if (std::holds_alternative<TradeCorrection>(variant)) {
+                    onOrderBatch(pending, shard_id);
+                    pending.clear();
+                    onCorrectionReceived(std::get<TradeCorrection>(variant), shard_id);
+                }
+                else if (std::holds_alternative<OrderCancel>(variant)) {
+                    // the order being cancelled may still be in the batch
+                    onOrderBatch(pending, shard_id);
+                    pending.clear();
+                    onCancelReceived(std::get<OrderCancel>(variant), shard_id);
+                }
                 else {
                     logger_wrapper_->error(shard_id, "[RiskEngine] Unknown or malformed message received");
                 }
@@ -84,32 +160,192 @@ void RiskEngine::runShard(int shard_id) {
             else
                 break;
         }
+        if (!pending.empty()) {
+            onOrderBatch(pending, shard_id);
+            pending.clear();
+        }
+        // reprice after the burst so the next burst sees current equity
+        if (mark_to_market.reprice(shard_id) > 0) processed = true;
+        uint64_t now_ms = utils::coarseNowMs();
+        if (now_ms >= next_sweep_ms) {
+            mark_to_market.sweep(shard_id);
+            scenario_margin.recompute(shard_id);
+            next_sweep_ms = now_ms + MTM_SWEEP_INTERVAL_MS;
+            uint64_t now_session = session_clock.session(utils::nowMs());
+            if (now_session != session) {
+                session = now_session;
+                // drawdown is measured from where equity stands at the open
+                mark_to_market.resetHighWaterMarks(shard_id);
+                // the trade history of a day is bounded only if it is dropped at the next open
+                posttrade_controls_[shard_id].resetSession();
+                logger_wrapper_->info(shard_id, "[RiskEngine] New session {}: high-water marks and trade ledger reset", session);
+            }
+        }
+        // VaR vectors are rebuilt at current marks a slice per loop, between bursts
+        if (now_ms >= next_var_ms && historical_var.recomputeStep(shard_id, VAR_RECOMPUTE_SLICE)) {
+            next_var_ms = now_ms + VAR_RECOMPUTE_INTERVAL_MS;
+        }
+        // a mark move can breach drawdown or maintenance without any trade on the account
+        mark_to_market.drainRepricedAccounts(shard_id, [now_ms](uint32_t account_id) {
+            liquidations.checkAccount(account_id, now_ms);
+        });
         if (!processed) {
+            // wipes the filter's spare generation while nothing is waiting
+            dup_filter_[shard_id].advance(utils::nowMs());
+            credit_manager.rebalance(shard_id);
+            volume_windows.reclaim(shard_id, now_ms, 64);
             idle_strategy.idle();
         }
         processed = false;
     }
+    instrument_lists.offline(shard_id);
     logger_wrapper_->debug(shard_id, "[RiskEngine] runShard exiting");
 }
 
+void RiskEngine::runMarketData() {
+    blogger_.debug("[RiskEngine] Market-data thread started");
+    aeron::concurrent::BackoffIdleStrategy idle_strategy(100, 1000);
+    // coarse timer; VCM deadlines are in seconds
+    constexpr uint64_t TIMER_PERIOD_MS = 10;
+    uint64_t next_timer_ms = 0;
+    uint64_t session = session_clock.session(utils::nowMs());
+    while (running_) {
+        // drain what is there, then publish only the newest state per instrument
+        int fragments = messaging_.pollMarketData(md_conflator_);
+        md_conflator_.drain(md_vcm_);
+        uint64_t now_ms = utils::coarseNowMs();
+        if (now_ms >= next_timer_ms) {
+            md_vcm_.onTimer(now_ms);
+            next_timer_ms = now_ms + TIMER_PERIOD_MS;
+            uint64_t now_session = session_clock.session(utils::nowMs());
+            if (now_session != session) {
+                session = now_session;
+                // this thread is the only writer of the VWAP and last-trade sums
+                std::vector<double> before(NUM_INSTRUMENTS);
+                for (uint32_t i = 0; i < NUM_INSTRUMENTS; ++i) before[i] = reference_prices.reference(i);
+                reference_prices.resetSession();
+                for (uint32_t i = 0; i < NUM_INSTRUMENTS; ++i) {
+                    if (reference_prices.reference(i) != before[i]) mark_to_market.onMarkChanged(i);
+                }
+                blogger_.info("[RiskEngine] New session {}: reference prices reset", session);
+            }
+        }
+        // this thread already spins; it also publishes the shards' liquidation orders
+        int published = messaging_.publishLiquidations(liquidations);
+        if (fragments == 0 && published == 0) idle_strategy.idle();
+    }
+    blogger_.debug("[RiskEngine] Market-data thread exiting, {} stale ticks dropped, {} conflated",
+                   md_conflator_.staleDropped(), md_conflator_.conflated());
+    const auto &latency = liquidations.latency();
+    blogger_.info("[RiskEngine] Liquidations: {} issued, {} suppressed, {} ring full, breach-to-publish p50 {} ns p99 {} ns max {} ns",
+                  liquidations.issued(), liquidations.suppressed(), liquidations.ringFull(),
+                  latency.percentileNs(0.5), latency.percentileNs(0.99), latency.max_ns.load());
+}
+
+void RiskEngine::onOrderBatch(const std::vector<Order> &orders, int shard_id) {
+    if (orders.empty()) return;
+    dup_filter_[shard_id].advance(utils::nowMs());
+    auto &batch = pretrade_batch_[shard_id];
+    batch.clear();
+    // band around the instrument's reference price; 0 (none yet) leaves the band unchecked
+    for (const auto &order : orders) {
+        batch.gather(order, reference_prices.reference(order.instrument_id));
+    }
+    BatchRejects rejects = batch.evaluate();
+
+    for (size_t i = 0; i < orders.size(); ++i) {
+        const Order &order = orders[i];
+        uint64_t bit = 1ULL << i;
+        if (rejects.max_qty & bit) {
+            logger_wrapper_->error(shard_id, "[RiskEngine] Order rejected: max qty exceeded for account {}", order.account_id);
+        }
+        else if (rejects.notional & bit) {
+            logger_wrapper_->error(shard_id, "[RiskEngine] Order rejected: max notional exceeded for account {}", order.account_id);
+        }
+        else if (rejects.price_band & bit) {
+            logger_wrapper_->error(shard_id, "[RiskEngine] Order rejected: price outside band for account {}", order.account_id);
+        }
+        else if (rejects.position & bit) {
+            logger_wrapper_->error(shard_id, "[RiskEngine] Order rejected: position limit for account {}", order.account_id);
+        }
+        else {
+            onOrderReceived(order, shard_id);
+        }
+    }
+}
+
 void RiskEngine::onOrderReceived(const Order &order, int shard_id) {
     logger_wrapper_->debug(shard_id, "[RiskEngine] Received order");
-    // Determine which shard this order belongs to
-    int shard = static_cast<int>(order.account_id % NUM_SHARDS);
-
-    // 1) Pre-trade checks
-    bool passQty   = pretrade_checks_[shard].checkMaxOrderQty(order);
-    bool passPos   = pretrade_checks_[shard].checkPositionLimit(order);
-    // We don't have a reference price here; assume checkPriceBand not used for now
+    // Stateless checks (qty, notional, price band, position) already ran in onOrderBatch.
+    int shard = (int)shardOf(order.account_id);
+    auto &dup_filter = dup_filter_[shard];
 
-    if (!passQty) {
-        logger_wrapper_->error(shard_id, "[RiskEngine] Order rejected: max qty exceeded for account {}", order.account_id);
+    // an account first seen here takes the shard's next slot; none left means no state to risk it against
+    if (shard_layout.assign(order.account_id) == ShardLayout::NO_SLOT) {
+        logger_wrapper_->error(shard_id, "[RiskEngine] Order rejected: shard {} has no slot left for account {}", shard, order.account_id);
+        return;
+    }
+    if (!pretrade_checks_[shard].checkTickSize(order)) {
+        logger_wrapper_->error(shard_id, "[RiskEngine] Order rejected: price {} off the tick grid of instrument {}", order.price, order.instrument_id);
+        return;
+    }
+    if (!pretrade_checks_[shard].checkRestricted(order)) {
+        logger_wrapper_->error(shard_id, "[RiskEngine] Order rejected: instrument {} is restricted", order.instrument_id);
         return;
     }
-    if (!passPos) {
+    if (!vcm_[shard].checkTradingState(order)) {
+        logger_wrapper_->error(shard_id, "[RiskEngine] Order rejected: VCM halt or cooling-off band on instrument {}", order.instrument_id);
+        return;
+    }
+    if (!vcm_[shard].checkSpread(order)) {
+        logger_wrapper_->error(shard_id, "[RiskEngine] Order rejected: spread too wide on instrument {}", order.instrument_id);
+        return;
+    }
+    if (!vcm_[shard].checkVolatility(order)) {
+        logger_wrapper_->error(shard_id, "[RiskEngine] Order rejected: volatility band breached on instrument {}", order.instrument_id);
+        return;
+    }
+    if (dup_filter.mayContain(order.order_id)) {
+        if (open_orders_.isOpen(order.account_id, order.order_id)) {
+            logger_wrapper_->error(shard_id, "[RiskEngine] Order rejected: duplicate order id {} for account {}", order.order_id, order.account_id);
+            return;
+        }
+        // filter false positive, or a replay of an order that is no longer working
+        logger_wrapper_->debug(shard_id, "[RiskEngine] Order id {} matched filter but is not open", order.order_id);
+    }
+    // orders accepted earlier in the batch may have used up the headroom the snapshot saw
+    if (!pretrade_checks_[shard].checkPositionLimit(order)) {
         logger_wrapper_->error(shard_id, "[RiskEngine] Order rejected: position limit for account {}", order.account_id);
         return;
     }
+    if (!pretrade_checks_[shard].checkShortSell(order)) {
+        logger_wrapper_->error(shard_id, "[RiskEngine] Order rejected: short sell in hard-to-borrow instrument {} for account {}", order.instrument_id, order.account_id);
+        return;
+    }
+    if (!pretrade_checks_[shard].checkWindowVolume(order, utils::coarseNowMs())) {
+        logger_wrapper_->error(shard_id, "[RiskEngine] Order rejected: rolling-window volume limit for account {}", order.account_id);
+        return;
+    }
+    if (!pretrade_checks_[shard].checkInitialMargin(order)) {
+        logger_wrapper_->error(shard_id, "[RiskEngine] Order rejected: initial margin exceeds equity for account {}", order.account_id);
+        return;
+    }
+    if (!pretrade_checks_[shard].checkLimitTree(order)) {
+        logger_wrapper_->error(shard_id, "[RiskEngine] Order rejected: firm/desk/trader exposure cap for account {}", order.account_id);
+        return;
+    }
+    int rule = custom_rules.evaluate(order, shard);
+    if (rule >= 0) {
+        logger_wrapper_->error(shard_id, "[RiskEngine] Order rejected: rule {} for account {}", custom_rules.rule(rule).name, order.account_id);
+        return;
+    }
+    // last check: it reserves credit, which the open order holds until fill or cancel
+    if (!credit_manager.tryConsume(order.account_id, price_scales.notional(order.instrument_id, order.quantity, order.price))) {
+        logger_wrapper_->error(shard_id, "[RiskEngine] Order rejected: credit line exhausted for account {}", order.account_id);
+        return;
+    }
+    open_orders_.onAccepted(order);
+    dup_filter.insert(order.order_id);
 
     // If passed, send the order to the matching engine (not implemented here).
     logger_wrapper_->debug(shard_id, "[RiskEngine] Order accepted: account {}, qty {}", order.account_id, order.quantity);
@@ -117,12 +353,45 @@ void RiskEngine::onOrderReceived(const Order &order, int shard_id) {
 
 void RiskEngine::onTradeReceived(const TradeExecution &trade, int shard_id) {
     // Determine shard
-    int shard = static_cast<int>(trade.account_id % NUM_SHARDS);
+    int shard = (int)shardOf(trade.account_id);
 
     // Post-trade update (positions, PnL, margin)
-    posttrade_controls_[shard].onTrade(trade);
+    if (!posttrade_controls_[shard].onTrade(trade)) {
+        if (trade.instrument_id >= NUM_INSTRUMENTS) {
+            logger_wrapper_->error(shard_id, "[RiskEngine] Trade id {} from venue {} for unknown instrument {} rejected",
+                                   trade.trade_id, trade.venue_id, trade.instrument_id);
+            return;
+        }
+        logger_wrapper_->debug(shard_id, "[RiskEngine] Duplicate trade id {} from venue {} ignored", trade.trade_id, trade.venue_id);
+        return;
+    }
 
     // After updating positions, send a trade confirmation back if needed
     // (In this example, we simply log it)
     logger_wrapper_->debug(shard_id, "[RiskEngine] Trade received: account {}, qty {}, price {}", trade.account_id, trade.quantity, trade.price);
+}
+
+void RiskEngine::onCorrectionReceived(const TradeCorrection &correction, int shard_id) {
+    int shard = (int)shardOf(correction.account_id);
+    if (!posttrade_controls_[shard].onCorrection(correction)) {
+        logger_wrapper_->error(shard_id, "[RiskEngine] {} of unknown or already busted trade id {} from venue {}, or unknown instrument",
+                               correction.kind == TradeCorrectionKind::Bust ? "Bust" : "Correction",
+                               correction.trade_id, correction.venue_id);
+        return;
+    }
+    logger_wrapper_->debug(shard_id, "[RiskEngine] Trade id {} from venue {} {} for account {}",
+                           correction.trade_id, correction.venue_id,
+                           correction.kind == TradeCorrectionKind::Bust ? "busted" : "corrected", correction.account_id);
+}
+
+void RiskEngine::onCancelReceived(const OrderCancel &cancel, int shard_id) {
+    if (liquidations.onCancel(cancel.account_id, cancel.order_id)) {
+        logger_wrapper_->info(shard_id, "[RiskEngine] Liquidation order {} of account {} cancelled", cancel.order_id, cancel.account_id);
+        return;
+    }
+    if (!open_orders_.onCancel(cancel.account_id, cancel.order_id)) {
+        logger_wrapper_->debug(shard_id, "[RiskEngine] Cancel for unknown order id {}", cancel.order_id);
+        return;
+    }
+    logger_wrapper_->debug(shard_id, "[RiskEngine] Order cancelled: account {}, order id {}", cancel.account_id, cancel.order_id);
 }
\ No newline at end of file
@@ -0,0 +1,451 @@
+//
+// Created by muhammad-abdullah on 6/26/25.
+//
+
+// File: src/rule_engine.cpp
+#include "rule_engine.h"
+#include "mark_to_market.h"
+#include "scenario_margin.h"
+#include "historical_var.h"
+#include "price_scale.h"
+#include <x86intrin.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+
+rms::RuleSet rms::custom_rules;
+
+namespace {
+    using rms::RuleOp;
+    using rms::RuleVar;
+    using rms::RuleInstr;
+
+    struct VarName {
+        const char *name;
+        RuleVar var;
+    };
+
+    constexpr VarName kVars[] = {
+        {"order.qty", RuleVar::OrderQty},
+        {"order.quantity", RuleVar::OrderQty},
+        {"order.price", RuleVar::OrderPrice},
+        {"order.notional", RuleVar::OrderNotional},
+        {"order.is_buy", RuleVar::OrderIsBuy},
+        {"position.net_qty", RuleVar::PositionNetQty},
+        {"position.open_buy", RuleVar::PositionOpenBuy},
+        {"position.open_sell", RuleVar::PositionOpenSell},
+        {"limit.max_order_qty", RuleVar::LimitMaxOrderQty},
+        {"limit.max_order_notional", RuleVar::LimitMaxOrderNotional},
+        {"limit.max_daily_position", RuleVar::LimitMaxDailyPosition},
+        {"limit.price_tolerance_pct", RuleVar::LimitPriceTolerancePct},
+        {"account.max_leverage", RuleVar::AccountMaxLeverage},
+        {"account.max_drawdown_pct", RuleVar::AccountMaxDrawdownPct},
+        {"account.equity", RuleVar::AccountEquity},
+        {"account.scenario_margin", RuleVar::AccountScenarioMargin},
+        {"account.var", RuleVar::AccountVar},
+    };
+
+    constexpr uint32_t varBit(RuleVar v) { return 1u << (uint32_t)v; }
+    constexpr uint32_t kPositionVars = varBit(RuleVar::PositionNetQty);
+    constexpr uint32_t kOpenVars = varBit(RuleVar::PositionOpenBuy) | varBit(RuleVar::PositionOpenSell);
+    constexpr uint32_t kAccountVars = varBit(RuleVar::AccountMaxLeverage) | varBit(RuleVar::AccountMaxDrawdownPct);
+    constexpr uint32_t kEquityVars = varBit(RuleVar::AccountEquity);
+    constexpr uint32_t kScenarioVars = varBit(RuleVar::AccountScenarioMargin);
+    constexpr uint32_t kVarVars = varBit(RuleVar::AccountVar);
+
+    // Constant folding at compile time
+    inline double applyBinary(RuleOp op, double a, double b) {
+        switch (op) {
+            case RuleOp::Add: return a + b;
+            case RuleOp::Sub: return a - b;
+            case RuleOp::Mul: return a * b;
+            case RuleOp::Div: return a / b;
+            case RuleOp::Lt:  return a < b;
+            case RuleOp::Le:  return a <= b;
+            case RuleOp::Gt:  return a > b;
+            case RuleOp::Ge:  return a >= b;
+            case RuleOp::Eq:  return a == b;
+            case RuleOp::Ne:  return a != b;
+            case RuleOp::And: return (a != 0.0) && (b != 0.0);
+            case RuleOp::Or:  return (a != 0.0) || (b != 0.0);
+            case RuleOp::Min: return std::min(a, b);
+            case RuleOp::Max: return std::max(a, b);
+            default:          return 0.0;
+        }
+    }
+
+    inline double applyUnary(RuleOp op, double a) {
+        switch (op) {
+            case RuleOp::Neg: return -a;
+            case RuleOp::Not: return a == 0.0;
+            case RuleOp::Abs: return std::abs(a);
+            default:          return a;
+        }
+    }
+
+    // Recursive-descent parser emitting postfix code. Precedence, low to high:
+    // || , && , comparisons, + - , * / , unary - ! , primaries.
+    class Compiler {
+    public:
+        Compiler(const std::string &src, std::vector<RuleInstr> &code) : src_(src), code_(code) {}
+
+        bool run(std::string &error) {
+            code_.clear();
+            next();
+            if (parseOr() && tok_ != Tok::End) fail("unexpected '" + text_ + "'");
+            error = error_;
+            return error_.empty();
+        }
+
+    private:
+        enum class Tok { End, Number, Ident, Op, LParen, RParen, Comma };
+
+        void fail(const std::string &msg) {
+            if (error_.empty()) error_ = msg + " at offset " + std::to_string(start_);
+        }
+
+        void next() {
+            while (pos_ < src_.size() && std::isspace((unsigned char)src_[pos_])) ++pos_;
+            start_ = pos_;
+            if (pos_ >= src_.size()) { tok_ = Tok::End; text_.clear(); return; }
+            char c = src_[pos_];
+            if (std::isdigit((unsigned char)c) || (c == '.' && pos_ + 1 < src_.size() && std::isdigit((unsigned char)src_[pos_ + 1]))) {
+                char *end = nullptr;
+                number_ = std::strtod(src_.c_str() + pos_, &end);
+                pos_ = end - src_.c_str();
+                tok_ = Tok::Number;
+            }
+            else if (std::isalpha((unsigned char)c) || c == '_') {
+                while (pos_ < src_.size() && (std::isalnum((unsigned char)src_[pos_]) || src_[pos_] == '_' || src_[pos_] == '.')) ++pos_;
+                tok_ = Tok::Ident;
+            }
+            else if (c == '(') { ++pos_; tok_ = Tok::LParen; }
+            else if (c == ')') { ++pos_; tok_ = Tok::RParen; }
+            else if (c == ',') { ++pos_; tok_ = Tok::Comma; }
+            else {
+                static const char *ops[] = {"&&", "||", "<=", ">=", "==", "!=", "<", ">", "+", "-", "*", "/", "!"};
+                tok_ = Tok::End;
+                for (const char *op : ops) {
+                    size_t n = std::char_traits<char>::length(op);
+                    if (src_.compare(pos_, n, op) == 0) { pos_ += n; tok_ = Tok::Op; break; }
+                }
+                if (tok_ == Tok::End) { fail(std::string("unexpected character '") + c + "'"); return; }
+            }
+            text_ = src_.substr(start_, pos_ - start_);
+        }
+
+        bool isOp(const char *op) const {
+            return (tok_ == Tok::Op && text_ == op) || (tok_ == Tok::Ident && text_ == op);
+        }
+
+        void emit(RuleOp op, RuleVar var = RuleVar::Count, double value = 0.0) {
+            code_.push_back(RuleInstr{op, var, value});
+            if (op == RuleOp::PushConst || op == RuleOp::PushVar) {
+                if (++depth_ > rms::RULE_MAX_STACK) fail("expression too deep");
+            }
+        }
+
+        void emitUnary(RuleOp op) {
+            if (!code_.empty() && code_.back().op == RuleOp::PushConst) {
+                code_.back().value = applyUnary(op, code_.back().value);
+                return;
+            }
+            code_.push_back(RuleInstr{op, RuleVar::Count, 0.0});
+        }
+
+        void emitBinary(RuleOp op) {
+            size_t n = code_.size();
+            --depth_;
+            if (n >= 2 && code_[n - 1].op == RuleOp::PushConst && code_[n - 2].op == RuleOp::PushConst) {
+                code_[n - 2].value = applyBinary(op, code_[n - 2].value, code_[n - 1].value);
+                code_.pop_back();
+                return;
+            }
+            code_.push_back(RuleInstr{op, RuleVar::Count, 0.0});
+        }
+
+        bool parseOr() {
+            if (!parseAnd()) return false;
+            while (isOp("||") || isOp("or")) {
+                next();
+                if (!parseAnd()) return false;
+                emitBinary(RuleOp::Or);
+            }
+            return true;
+        }
+
+        bool parseAnd() {
+            if (!parseCmp()) return false;
+            while (isOp("&&") || isOp("and")) {
+                next();
+                if (!parseCmp()) return false;
+                emitBinary(RuleOp::And);
+            }
+            return true;
+        }
+
+        bool parseCmp() {
+            if (!parseAdd()) return false;
+            static const std::pair<const char *, RuleOp> cmps[] = {
+                {"<=", RuleOp::Le}, {">=", RuleOp::Ge}, {"==", RuleOp::Eq},
+                {"!=", RuleOp::Ne}, {"<", RuleOp::Lt}, {">", RuleOp::Gt}};
+            for (const auto &[text, op] : cmps) {
+                if (isOp(text)) {
+                    next();
+                    if (!parseAdd()) return false;
+                    emitBinary(op);
+                    break;
+                }
+            }
+            return true;
+        }
+
+        bool parseAdd() {
+            if (!parseMul()) return false;
+            while (isOp("+") || isOp("-")) {
+                RuleOp op = text_ == "+" ? RuleOp::Add : RuleOp::Sub;
+                next();
+                if (!parseMul()) return false;
+                emitBinary(op);
+            }
+            return true;
+        }
+
+        bool parseMul() {
+            if (!parseUnary()) return false;
+            while (isOp("*") || isOp("/")) {
+                RuleOp op = text_ == "*" ? RuleOp::Mul : RuleOp::Div;
+                next();
+                if (!parseUnary()) return false;
+                emitBinary(op);
+            }
+            return true;
+        }
+
+        bool parseUnary() {
+            if (isOp("-") || isOp("!") || isOp("not")) {
+                RuleOp op = text_ == "-" ? RuleOp::Neg : RuleOp::Not;
+                next();
+                if (!parseUnary()) return false;
+                emitUnary(op);
+                return true;
+            }
+            return parsePrimary();
+        }
+
+        bool parsePrimary() {
+            if (tok_ == Tok::Number) {
+                emit(RuleOp::PushConst, RuleVar::Count, number_);
+                next();
+                return true;
+            }
+            if (tok_ == Tok::LParen) {
+                next();
+                if (!parseOr()) return false;
+                if (tok_ != Tok::RParen) { fail("expected ')'"); return false; }
+                next();
+                return true;
+            }
+            if (tok_ != Tok::Ident) { fail(tok_ == Tok::End ? "unexpected end of expression" : "unexpected '" + text_ + "'"); return false; }
+
+            std::string name = text_;
+            next();
+            if (name == "true" || name == "false") {
+                emit(RuleOp::PushConst, RuleVar::Count, name == "true" ? 1.0 : 0.0);
+                return true;
+            }
+            if (tok_ == Tok::LParen) return parseCall(name);
+            for (const auto &v : kVars) {
+                if (name == v.name) {
+                    emit(RuleOp::PushVar, v.var);
+                    return true;
+                }
+            }
+            fail("unknown field '" + name + "'");
+            return false;
+        }
+
+        bool parseCall(const std::string &name) {
+            int arity;
+            RuleOp op;
+            if (name == "abs") { arity = 1; op = RuleOp::Abs; }
+            else if (name == "min") { arity = 2; op = RuleOp::Min; }
+            else if (name == "max") { arity = 2; op = RuleOp::Max; }
+            else { fail("unknown function '" + name + "'"); return false; }
+            next();
+            for (int i = 0; i < arity; ++i) {
+                if (i > 0) {
+                    if (tok_ != Tok::Comma) { fail("expected ','"); return false; }
+                    next();
+                }
+                if (!parseOr()) return false;
+            }
+            if (tok_ != Tok::RParen) { fail("expected ')'"); return false; }
+            next();
+            if (arity == 1) emitUnary(op);
+            else emitBinary(op);
+            return true;
+        }
+
+        const std::string &src_;
+        std::vector<RuleInstr> &code_;
+        size_t pos_ = 0;
+        size_t start_ = 0;
+        Tok tok_ = Tok::End;
+        std::string text_;
+        double number_ = 0.0;
+        int depth_ = 0;
+        std::string error_;
+    };
+}
+
+bool rms::RuleSet::compile(const std::string &expr, std::vector<RuleInstr> &code, std::string &error) {
+    Compiler compiler(expr, code);
+    return compiler.run(error);
+}
+
+bool rms::RuleSet::addRule(const std::string &name, const std::string &expr, std::string &error) {
+    CompiledRule rule{name, expr, {}};
+    if (!compile(expr, rule.code, error)) {
+        return false;
+    }
+    for (const auto &in : rule.code) {
+        if (in.op == RuleOp::PushVar) used_vars_ |= varBit(in.var);
+    }
+    rules_.push_back(std::move(rule));
+    for (auto &shard : stats_) {
+        shard.rules.resize(rules_.size());
+    }
+    return true;
+}
+
+void rms::RuleSet::resize(uint32_t shards) {
+    stats_ = std::vector<ShardStats>(shards);
+    for (auto &shard : stats_) shard.rules.resize(rules_.size());
+}
+
+void rms::RuleSet::clear() {
+    rules_.clear();
+    used_vars_ = 0;
+    for (auto &shard : stats_) {
+        shard.rules.clear();
+        shard.tick = 0;
+    }
+}
+
+void rms::RuleSet::bind(const Order &order, RuleContext &ctx) const {
+    int shard = shardOf(order.account_id);
+    const auto &lim = instrument_limits;
+    uint32_t inst = order.instrument_id;
+    double *v = ctx.vars;
+    v[(int)RuleVar::OrderQty] = (double)order.quantity;
+    v[(int)RuleVar::OrderPrice] = price_scales.toDouble(order.instrument_id, order.price);
+    v[(int)RuleVar::OrderNotional] = price_scales.notional(order.instrument_id, order.quantity, order.price);
+    v[(int)RuleVar::OrderIsBuy] = (used_vars_ & varBit(RuleVar::OrderIsBuy)) && isBuy(order) ? 1.0 : 0.0;
+    v[(int)RuleVar::LimitMaxOrderQty] = lim.max_order_qty[inst];
+    v[(int)RuleVar::LimitMaxOrderNotional] = lim.max_order_notional[inst];
+    v[(int)RuleVar::LimitMaxDailyPosition] = lim.max_daily_position[inst];
+    v[(int)RuleVar::LimitPriceTolerancePct] = lim.price_tolerance_pct[inst];
+
+    // account limits and hash lookups only when some rule reads them
+    if (used_vars_ & kAccountVars) {
+        uint32_t slot = shard_layout.slot(order.account_id);
+        AccountLimits acct_lim = slot == ShardLayout::NO_SLOT ? AccountLimits{} : account_limits[shard].get(slot);
+        v[(int)RuleVar::AccountMaxLeverage] = acct_lim.max_leverage;
+        v[(int)RuleVar::AccountMaxDrawdownPct] = acct_lim.max_drawdown_pct;
+    }
+    v[(int)RuleVar::AccountEquity] = 0.0;
+    if (used_vars_ & kEquityVars) {
+        v[(int)RuleVar::AccountEquity] = mark_to_market.equity(order.account_id);
+    }
+    v[(int)RuleVar::AccountScenarioMargin] = 0.0;
+    if (used_vars_ & kScenarioVars) {
+        v[(int)RuleVar::AccountScenarioMargin] = scenario_margin.scenarioMargin(order.account_id);
+    }
+    v[(int)RuleVar::AccountVar] = 0.0;
+    if (used_vars_ & kVarVars) {
+        v[(int)RuleVar::AccountVar] = historical_var.var(order.account_id);
+    }
+    v[(int)RuleVar::PositionNetQty] = 0.0;
+    if (used_vars_ & kPositionVars) {
+        const Position *pos = position_store[shard].find(order.account_id, order.instrument_id);
+        if (pos != nullptr) v[(int)RuleVar::PositionNetQty] = (double)pos->net_qty;
+    }
+    v[(int)RuleVar::PositionOpenBuy] = 0.0;
+    v[(int)RuleVar::PositionOpenSell] = 0.0;
+    if (used_vars_ & kOpenVars) {
+        auto &exp_map = open_exposure_store[shard];
+        auto it = exp_map.find(positionKey(order.account_id, order.instrument_id));
+        if (it != exp_map.end()) {
+            v[(int)RuleVar::PositionOpenBuy] = (double)it->second.buy_qty;
+            v[(int)RuleVar::PositionOpenSell] = (double)it->second.sell_qty;
+        }
+    }
+}
+
+double rms::RuleSet::run(const CompiledRule &rule, const RuleContext &ctx) {
+    double stack[RULE_MAX_STACK];
+    double *top = stack - 1;
+    // one case per op so each dispatch is a single indirect jump
+    for (const RuleInstr &in : rule.code) {
+        switch (in.op) {
+            case RuleOp::PushConst: *++top = in.value; break;
+            case RuleOp::PushVar:   *++top = ctx.vars[(int)in.var]; break;
+            case RuleOp::Add: --top; top[0] = top[0] + top[1]; break;
+            case RuleOp::Sub: --top; top[0] = top[0] - top[1]; break;
+            case RuleOp::Mul: --top; top[0] = top[0] * top[1]; break;
+            case RuleOp::Div: --top; top[0] = top[0] / top[1]; break;
+            case RuleOp::Lt:  --top; top[0] = top[0] < top[1]; break;
+            case RuleOp::Le:  --top; top[0] = top[0] <= top[1]; break;
+            case RuleOp::Gt:  --top; top[0] = top[0] > top[1]; break;
+            case RuleOp::Ge:  --top; top[0] = top[0] >= top[1]; break;
+            case RuleOp::Eq:  --top; top[0] = top[0] == top[1]; break;
+            case RuleOp::Ne:  --top; top[0] = top[0] != top[1]; break;
+            case RuleOp::And: --top; top[0] = (top[0] != 0.0) & (top[1] != 0.0); break;
+            case RuleOp::Or:  --top; top[0] = (top[0] != 0.0) | (top[1] != 0.0); break;
+            case RuleOp::Min: --top; top[0] = std::min(top[0], top[1]); break;
+            case RuleOp::Max: --top; top[0] = std::max(top[0], top[1]); break;
+            case RuleOp::Neg: top[0] = -top[0]; break;
+            case RuleOp::Not: top[0] = top[0] == 0.0; break;
+            case RuleOp::Abs: top[0] = std::abs(top[0]); break;
+        }
+    }
+    return top >= stack ? stack[0] : 0.0;
+}
+
+int rms::RuleSet::evaluate(const Order &order, int shard) {
+    if (rules_.empty()) return -1;
+    RuleContext ctx;
+    bind(order, ctx);
+    auto &st = stats_[shard];
+    bool timed = (++st.tick % RULE_TIMING_SAMPLE) == 0;
+    for (size_t i = 0; i < rules_.size(); ++i) {
+        RuleStats &rs = st.rules[i];
+        uint64_t t0 = timed ? __rdtsc() : 0;
+        bool reject = run(rules_[i], ctx) != 0.0;
+        if (timed) {
+            rs.sampled_cycles += __rdtsc() - t0;
+            ++rs.sampled;
+        }
+        ++rs.evaluations;
+        if (reject) {
+            ++rs.rejects;
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+rms::RuleStats rms::RuleSet::stats(size_t idx) const {
+    RuleStats total;
+    for (const auto &shard : stats_) {
+        if (idx >= shard.rules.size()) continue;
+        const RuleStats &rs = shard.rules[idx];
+        total.evaluations += rs.evaluations;
+        total.rejects += rs.rejects;
+        total.sampled += rs.sampled;
+        total.sampled_cycles += rs.sampled_cycles;
+    }
+    return total;
+}
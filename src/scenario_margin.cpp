@@ -0,0 +1,136 @@
+//
+// Created by muhammad-abdullah on 7/23/25.
+//
+
+// File: src/scenario_margin.cpp
+#include "scenario_margin.h"
+#include <immintrin.h>
+#include <algorithm>
+#include <thread>
+
+rms::ScenarioMarginEngine rms::scenario_margin;
+
+namespace {
+    constexpr int N = rms::ScenarioMarginEngine::SCENARIOS;
+
+    // risk[s] += qty * pnl[s] over the scenario grid
+    void axpyScalar(double qty, const double *pnl, double *risk) {
+        for (int s = 0; s < N; ++s) risk[s] += qty * pnl[s];
+    }
+
+    __attribute__((target("avx2")))
+    void axpyAvx2(double qty, const double *pnl, double *risk) {
+        const __m256d q = _mm256_set1_pd(qty);
+        for (int s = 0; s < N; s += 4) {
+            __m256d r = _mm256_load_pd(risk + s);
+            _mm256_store_pd(risk + s, _mm256_add_pd(r, _mm256_mul_pd(q, _mm256_load_pd(pnl + s))));
+        }
+    }
+
+    using AxpyKernel = void (*)(double, const double *, double *);
+
+    AxpyKernel axpyKernel() {
+        static const AxpyKernel kernel = [] {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") ? axpyAvx2 : axpyScalar;
+        }();
+        return kernel;
+    }
+}
+
+rms::ScenarioMarginEngine::ScenarioMarginEngine() : vectors_(NUM_INSTRUMENTS) {
+    resize(ShardLayout::DEFAULT_SHARDS, ShardLayout::DEFAULT_ACCOUNTS_PER_SHARD);
+    for (auto &v : vectors_) std::fill_n(v.pnl, SCENARIOS, 0.0);
+}
+
+void rms::ScenarioMarginEngine::resize(uint32_t shards, uint32_t accounts_per_shard) {
+    shards_ = std::vector<Shard>(shards);
+    for (auto &shard : shards_) {
+        shard.columns.resize(NUM_INSTRUMENTS);
+        shard.accounts = accounts_per_shard;
+        shard.arena.reset(ShardArena::bytesFor(accounts_per_shard, {sizeof(Vector)}));
+        shard.risk = shard.arena.take<Vector>(accounts_per_shard);
+    }
+}
+
+void rms::ScenarioMarginEngine::setScenarios(uint32_t instrument_id, const double *pnl) {
+    if (instrument_id >= NUM_INSTRUMENTS) return;
+    std::copy_n(pnl, SCENARIOS, vectors_[instrument_id].pnl);
+}
+
+void rms::ScenarioMarginEngine::setLinearScenarios(uint32_t instrument_id, double price_scan) {
+    // a linear instrument has no vega: the volatility up/down pairs lose the same
+    static constexpr double kMoves[SCENARIOS] = {
+        0.0, 0.0, 1.0 / 3, 1.0 / 3, -1.0 / 3, -1.0 / 3, 2.0 / 3, 2.0 / 3,
+        -2.0 / 3, -2.0 / 3, 1.0, 1.0, -1.0, -1.0, 3.0 * 0.35, -3.0 * 0.35,
+    };
+    double pnl[SCENARIOS];
+    for (int s = 0; s < SCENARIOS; ++s) pnl[s] = kMoves[s] * price_scan;
+    setScenarios(instrument_id, pnl);
+}
+
+void rms::ScenarioMarginEngine::onPosition(uint32_t account_id, uint32_t instrument_id, Position &pos) {
+    if (instrument_id >= NUM_INSTRUMENTS) return;
+    Shard &shard = shards_[shardOf(account_id)];
+    Columns &cols = shard.columns[instrument_id];
+    uint32_t slot = shard_layout.assign(account_id);
+    if (slot == ShardLayout::NO_SLOT || slot >= shard.accounts) return;
+    uint16_t acct = (uint16_t)slot;
+    if (pos.scenario_slot == NO_MARK_SLOT) {
+        pos.scenario_slot = (uint32_t)cols.qty.size();
+        cols.qty.push_back(0.0);
+        cols.account.push_back(acct);
+    }
+    double &qty = cols.qty[pos.scenario_slot];
+    double delta = (double)pos.net_qty - qty;
+    if (delta == 0.0) return;
+    qty = (double)pos.net_qty;
+    axpyKernel()(delta, vectors_[instrument_id].pnl, shard.risk[acct].pnl);
+}
+
+void rms::ScenarioMarginEngine::recompute(int shard_id) {
+    Shard &shard = shards_[shard_id];
+    std::fill_n(&shard.risk[0].pnl[0], (size_t)shard.accounts * SCENARIOS, 0.0);
+    AxpyKernel axpy = axpyKernel();
+    for (uint32_t i = 0; i < NUM_INSTRUMENTS; ++i) {
+        const Columns &cols = shard.columns[i];
+        const double *pnl = vectors_[i].pnl;
+        for (size_t k = 0; k < cols.qty.size(); ++k) {
+            axpy(cols.qty[k], pnl, shard.risk[cols.account[k]].pnl);
+        }
+    }
+}
+
+void rms::ScenarioMarginEngine::recomputeAll() {
+    std::vector<std::thread> threads;
+    threads.reserve(shards_.size() - 1);
+    for (int s = 1; s < (int)shards_.size(); ++s) {
+        threads.emplace_back(&ScenarioMarginEngine::recompute, this, s);
+    }
+    recompute(0);
+    for (auto &t : threads) t.join();
+}
+
+void rms::ScenarioMarginEngine::clear() {
+    for (auto &shard : shards_) {
+        for (auto &cols : shard.columns) cols = Columns{};
+        std::fill_n(&shard.risk[0].pnl[0], (size_t)shard.accounts * SCENARIOS, 0.0);
+    }
+}
+
+double rms::ScenarioMarginEngine::scenarioMargin(uint32_t account_id) const {
+    const double *risk = riskArray(account_id);
+    double worst = *std::min_element(risk, risk + SCENARIOS);
+    return worst < 0.0 ? -worst : 0.0;
+}
+
+const double *rms::ScenarioMarginEngine::riskArray(uint32_t account_id) const {
+    uint32_t acct = shard_layout.slot(account_id);
+    return acct == ShardLayout::NO_SLOT ? no_risk_.pnl : shards_[shardOf(account_id)].risk[acct].pnl;
+}
+
+size_t rms::ScenarioMarginEngine::positions(int shard) const {
+    size_t n = 0;
+    for (const auto &cols : shards_[shard].columns) n += cols.qty.size();
+    return n;
+}
@@ -0,0 +1,26 @@
+//
+// Created by muhammad-abdullah on 7/31/25.
+//
+
+// File: src/session_clock.cpp
+#include "session_clock.h"
+
+rms::SessionClock rms::session_clock;
+
+bool rms::SessionClock::parseTimeOfDay(const std::string &text, uint32_t &ms) {
+    uint32_t fields[3] = {0, 0, 0};
+    int n = 0;
+    size_t i = 0;
+    while (n < 3) {
+        size_t start = i;
+        uint32_t v = 0;
+        while (i < text.size() && text[i] >= '0' && text[i] <= '9' && i - start < 2) v = v * 10 + (text[i++] - '0');
+        if (i - start != 2) return false;
+        fields[n++] = v;
+        if (i == text.size()) break;
+        if (text[i++] != ':') return false;
+    }
+    if (n < 2 || i != text.size() || fields[0] > 23 || fields[1] > 59 || fields[2] > 59) return false;
+    ms = ((fields[0] * 60 + fields[1]) * 60 + fields[2]) * 1000;
+    return true;
+}
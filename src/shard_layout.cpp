@@ -0,0 +1,38 @@
+//
+// Created by muhammad-abdullah on 7/30/25.
+//
+
+// File: src/shard_layout.cpp
+#include "shard_layout.h"
+#include <cstring>
+
+rms::ShardLayout rms::shard_layout;
+
+void rms::ShardArena::reset(size_t bytes) {
+    bytes = (bytes + ALIGN - 1) & ~(ALIGN - 1);
+    block_.reset(bytes == 0 ? nullptr : static_cast<std::byte *>(std::aligned_alloc(ALIGN, bytes)));
+    size_ = block_ ? bytes : 0;
+    used_ = 0;
+    if (block_) std::memset(block_.get(), 0, size_);
+}
+
+bool rms::ShardLayout::configure(uint32_t shards, uint32_t accounts_per_shard) {
+    if (shards == 0 || shards > MAX_SHARDS || accounts_per_shard == 0 || accounts_per_shard > MAX_ACCOUNTS_PER_SHARD) {
+        return false;
+    }
+    shards_ = shards;
+    accounts_per_shard_ = accounts_per_shard;
+    directories_ = std::vector<Directory>(shards);
+    return true;
+}
+
+uint32_t rms::ShardLayout::assign(uint32_t account_id) {
+    Directory &dir = directories_[shardOf(account_id)];
+    auto it = dir.slots.find(account_id);
+    if (it != dir.slots.end()) return it->second;
+    if (dir.accounts.size() >= accounts_per_shard_) return NO_SLOT;
+    uint32_t slot = (uint32_t)dir.accounts.size();
+    dir.slots.emplace(account_id, slot);
+    dir.accounts.push_back(account_id);
+    return slot;
+}
@@ -28,10 +28,45 @@ void ShardedQueue::enqueue(aeron::concurrent::AtomicBuffer buffer, int32_t offse
         idleStrategy.idle();
     }
 }
-std::optional<std::variant<Order, TradeExecution>> ShardedQueue::dequeue() {
-    std::optional<std::variant<Order, TradeExecution>> result;
-    _ring_buffer.read([&](int8_t msgType, aeron::concurrent::AtomicBuffer& buffer, int32_t offset, int32_t length)
+bool isCurrentOrderFrame(const aeron::concurrent::AtomicBuffer &buffer, int32_t offset, int32_t length) {
+    if (length < (int32_t)baseline::Order::sbeBlockAndHeaderLength()) return false;
+    baseline::MessageHeader header;
+    header.wrap(reinterpret_cast<char *>(buffer.buffer()), offset, 0, buffer.capacity());
+    return header.templateId() == baseline::Order::sbeTemplateId()
+        && header.schemaId() == baseline::Order::sbeSchemaId()
+        && header.version() == baseline::Order::sbeSchemaVersion()
+        && header.blockLength() >= baseline::Order::sbeBlockLength();
+}
+
+std::optional<InboundMessage> ShardedQueue::dequeue() {
+    std::optional<InboundMessage> result;
+    _ring_buffer.read([&](int8_t, aeron::concurrent::AtomicBuffer& buffer, int32_t offset, int32_t length)
     {
+        // trades, corrections and cancels are a type byte and the struct, exactly
+        uint8_t wireType = buffer.getUInt8(offset);
+        if (wireType == TRADE_MSG_TYPE && length == (int32_t)(1 + sizeof(TradeExecution))) {
+            TradeExecution trade;
+            memcpy(&trade, buffer.buffer() + offset + 1, sizeof(trade));
+            result.emplace(trade);
+            return;
+        }
+        if (wireType == TRADE_CORRECTION_MSG_TYPE && length == (int32_t)(1 + sizeof(TradeCorrection))) {
+            TradeCorrection correction;
+            memcpy(&correction, buffer.buffer() + offset + 1, sizeof(correction));
+            result.emplace(correction);
+            return;
+        }
+        if (wireType == ORDER_CANCEL_MSG_TYPE && length == (int32_t)(1 + sizeof(OrderCancel))) {
+            OrderCancel cancel;
+            memcpy(&cancel, buffer.buffer() + offset + 1, sizeof(cancel));
+            result.emplace(cancel);
+            return;
+        }
+        if (!isCurrentOrderFrame(buffer, offset, length)) {
+            std::cerr << "Dropped inbound frame: not a version " << baseline::Order::sbeSchemaVersion()
+                      << " Order" << std::endl;
+            return;
+        }
         baseline::MessageHeader _message_header;
         baseline::Order _order_decoder;
 
@@ -39,7 +74,7 @@ std::optional<std::variant<Order, TradeExecution>> ShardedQueue::dequeue() {
         offset += _message_header.encodedLength();  // usually 8 bytes
         _order_decoder.wrapForDecode(reinterpret_cast<char*>(buffer.buffer()), offset, _message_header.blockLength(), _message_header.version(), buffer.capacity());
 
-        if (_message_header.templateId() == 1) {
+        {
             Order order;
             //getting fixed block from sbe
             order.order_id = _order_decoder.order_id();
@@ -53,16 +88,6 @@ std::optional<std::variant<Order, TradeExecution>> ShardedQueue::dequeue() {
 
             result.emplace(order);
         }
-        else if (msgType == '2') {
-            TradeExecution trade;
-            if (length >= sizeof(trade)) {
-                memcpy(&trade, buffer.buffer() + offset + 1, sizeof(trade));
-            }
-            result.emplace(trade);
-        }
-        else {
-            std::cerr << "Unexpected msgType" << std::endl;
-        }
     });
     return result;
 }
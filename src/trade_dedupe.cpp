@@ -0,0 +1,67 @@
+//
+// Created by muhammad-abdullah on 7/25/25.
+//
+
+// File: src/trade_dedupe.cpp
+#include "trade_dedupe.h"
+#include <algorithm>
+
+rms::TradeDeduplicator::TradeDeduplicator(const TradeDedupeParams &params) : params_(params), venues_(MAX_VENUES) {
+    // the ring index is id & (window - 1)
+    uint32_t window = 64;
+    while (window < params_.window) window <<= 1;
+    params_.window = window;
+}
+
+void rms::TradeDeduplicator::clear() {
+    for (auto &venue : venues_) venue = Venue{};
+    duplicates_ = unknown_ = 0;
+}
+
+void rms::TradeDeduplicator::slide(Venue &venue, uint64_t new_base) {
+    const uint64_t mask = params_.window - 1;
+    if (new_base - venue.base >= params_.window) {
+        std::fill(venue.bits.begin(), venue.bits.end(), 0);
+        venue.base = new_base;
+        return;
+    }
+    // clear the ids passed over so the slots can hold the new ones
+    for (uint64_t id = venue.base; id < new_base;) {
+        uint64_t &word = venue.bits[(id & mask) >> 6];
+        if ((id & 63) == 0 && new_base - id >= 64) {
+            word = 0;
+            id += 64;
+            continue;
+        }
+        word &= ~(1ULL << (id & 63));
+        ++id;
+    }
+    venue.base = new_base;
+}
+
+rms::TradeSeen rms::TradeDeduplicator::check(uint16_t venue_id, uint64_t trade_id) {
+    if (trade_id == 0) return TradeSeen::New;
+    if (venue_id >= MAX_VENUES) {
+        ++unknown_;
+        return TradeSeen::Unknown;
+    }
+    Venue &venue = venues_[venue_id];
+    if (venue.bits.empty()) {
+        // first trade of the venue: leave room below it for trades still in flight
+        venue.bits.assign(params_.window / 64, 0);
+        venue.base = trade_id > params_.window / 2 ? trade_id - params_.window / 2 : 1;
+    }
+    if (trade_id < venue.base) {
+        ++unknown_;
+        return TradeSeen::Unknown;
+    }
+    if (trade_id >= venue.base + params_.window) slide(venue, trade_id - params_.window + 1);
+    uint64_t &word = venue.bits[(trade_id & (params_.window - 1)) >> 6];
+    uint64_t bit = 1ULL << (trade_id & 63);
+    if (word & bit) {
+        ++duplicates_;
+        return TradeSeen::Duplicate;
+    }
+    word |= bit;
+    return TradeSeen::New;
+}
@@ -0,0 +1,149 @@
+//
+// Created by muhammad-abdullah on 7/26/25.
+//
+
+// File: src/trade_ledger.cpp
+#include "trade_ledger.h"
+#include "price_scale.h"
+#include <algorithm>
+
+uint32_t rms::TradeLedger::addRecord(uint64_t position, int64_t qty, FixedPrice price) {
+    Record rec;
+    rec.position = position;
+    rec.qty = qty;
+    rec.price = price;
+    records_.push_back(std::move(rec));
+    return (uint32_t)(records_.size() - 1);
+}
+
+rms::TradeLedger::Book &rms::TradeLedger::bookFor(uint32_t account_id, uint32_t instrument_id, Position &pos) {
+    uint64_t key = positionKey(account_id, instrument_id);
+    auto [it, inserted] = books_.try_emplace(key);
+    if (inserted) {
+        it->second.realized_base = pos.realized_pnl;
+        // a position restored without its history opens as one lot at its average
+        // price, to the nearest unit
+        if (pos.net_qty != 0) {
+            FixedPrice price = price_scales.toFixed(instrument_id, pos.avg_entry_price);
+            uint32_t seed = addRecord(key, pos.net_qty, price);
+            it->second.lots.push_back({seed, pos.net_qty, price});
+            it->second.net = pos.net_qty;
+            it->second.cost = pos.net_qty * price;
+        }
+    }
+    return it->second;
+}
+
+void rms::TradeLedger::sync(const Book &book, uint32_t instrument_id, Position &pos) {
+    // cost and realized are exact; only these views of them round
+    pos.net_qty = book.net;
+    pos.avg_entry_price = book.net == 0 ? 0.0 : price_scales.toDouble(instrument_id, book.cost) / (double)book.net;
+    pos.realized_pnl = book.realized_base + price_scales.toDouble(instrument_id, book.realized);
+}
+
+void rms::TradeLedger::apply(Book &book, uint32_t record, int64_t qty, FixedPrice price, bool reopen) {
+    while (qty != 0 && !book.lots.empty() && (book.lots.front().qty > 0) != (qty > 0)) {
+        Lot &lot = book.lots.front();
+        int64_t closed = lot.qty > 0 ? std::min(lot.qty, -qty) : std::max(lot.qty, -qty);
+        int64_t pnl = (price - lot.price) * closed;
+        book.realized += pnl;
+        records_[record].closed.push_back({lot.record, closed, lot.price, pnl});
+        records_[lot.record].closed_by.emplace_back(record, closed);
+        lot.qty -= closed;
+        book.net -= closed;
+        book.cost -= closed * lot.price;
+        qty += closed;
+        if (lot.qty == 0) book.lots.pop_front();
+    }
+    if (qty != 0) {
+        // a lot coming back from a bust is older than anything still open
+        if (reopen) book.lots.push_front({record, qty, price});
+        else book.lots.push_back({record, qty, price});
+        book.net += qty;
+        book.cost += qty * price;
+    }
+}
+
+void rms::TradeLedger::unwind(Book &book, uint32_t r) {
+    // what is left of its own lot
+    for (auto it = book.lots.begin(); it != book.lots.end();) {
+        if (it->record != r) {
+            ++it;
+            continue;
+        }
+        book.net -= it->qty;
+        book.cost -= it->qty * it->price;
+        it = book.lots.erase(it);
+    }
+    // the pieces it closed reopen, oldest ending up first
+    std::vector<Piece> closed = std::move(records_[r].closed);
+    records_[r].closed.clear();
+    for (auto it = closed.rbegin(); it != closed.rend(); ++it) {
+        book.realized -= it->pnl;
+        auto &by = records_[it->lot].closed_by;
+        auto back = std::find(by.begin(), by.end(), std::make_pair(r, it->qty));
+        if (back != by.end()) by.erase(back);
+        apply(book, it->lot, it->qty, it->lot_price, true);
+    }
+    // trades that closed part of its lot traded against nothing: apply them again
+    auto closed_by = std::move(records_[r].closed_by);
+    records_[r].closed_by.clear();
+    for (const auto &[closer, qty] : closed_by) {
+        auto &pieces = records_[closer].closed;
+        auto piece = std::find_if(pieces.begin(), pieces.end(),
+                                  [&](const Piece &p) { return p.lot == r && p.qty == qty; });
+        if (piece == pieces.end()) continue;
+        book.realized -= piece->pnl;
+        pieces.erase(piece);
+        apply(book, closer, -qty, records_[closer].price, false);
+    }
+    records_[r].busted = true;
+}
+
+void rms::TradeLedger::onFill(const TradeExecution &trade, Position &pos) {
+    Book &book = bookFor(trade.account_id, trade.instrument_id, pos);
+    int64_t signed_qty = trade.is_buy ? trade.quantity : -trade.quantity;
+    uint32_t record = addRecord(positionKey(trade.account_id, trade.instrument_id), signed_qty, trade.price);
+    if (trade.trade_id != 0) ids_[idKey(trade.venue_id, trade.trade_id)] = record;
+    apply(book, record, signed_qty, trade.price, false);
+    sync(book, trade.instrument_id, pos);
+}
+
+bool rms::TradeLedger::bust(uint16_t venue_id, uint64_t trade_id, uint32_t account_id, uint32_t instrument_id,
+                            Position &pos) {
+    auto it = ids_.find(idKey(venue_id, trade_id));
+    if (it == ids_.end()) return false;
+    uint32_t r = it->second;
+    if (records_[r].busted || records_[r].position != positionKey(account_id, instrument_id)) return false;
+    Book &book = bookFor(account_id, instrument_id, pos);
+    unwind(book, r);
+    sync(book, instrument_id, pos);
+    return true;
+}
+
+bool rms::TradeLedger::correct(uint16_t venue_id, uint64_t trade_id, uint32_t account_id, uint32_t instrument_id,
+                               int64_t quantity, FixedPrice price, Position &pos) {
+    auto it = ids_.find(idKey(venue_id, trade_id));
+    if (it == ids_.end()) return false;
+    uint32_t r = it->second;
+    bool was_buy = records_[r].qty > 0;
+    if (!bust(venue_id, trade_id, account_id, instrument_id, pos)) return false;
+    int64_t signed_qty = was_buy ? quantity : -quantity;
+    Book &book = books_[positionKey(account_id, instrument_id)];
+    uint32_t corrected = addRecord(positionKey(account_id, instrument_id), signed_qty, price);
+    ids_[idKey(venue_id, trade_id)] = corrected;
+    apply(book, corrected, signed_qty, price, false);
+    sync(book, instrument_id, pos);
+    return true;
+}
+
+void rms::TradeLedger::clear() {
+    books_.clear();
+    ids_.clear();
+    records_.clear();
+}
+
+size_t rms::TradeLedger::openLots(uint32_t account_id, uint32_t instrument_id) const {
+    auto it = books_.find(positionKey(account_id, instrument_id));
+    return it == books_.end() ? 0 : it->second.lots.size();
+}
@@ -5,19 +5,50 @@
 #include "data_types.h"
 // File: src/vcm_module.cpp
 #include "vcm_module.h"
+#include "l1_table.h"
+#include "volatility.h"
+#include "vcm_state.h"
+#include "price_scale.h"
+#include "utils/time_utils.h"
 #include <cmath>
 
 void rms::VCMModule::onMarketData(uint32_t instrument_id, double best_bid, double best_ask) {
-    // Simplified: do nothing
+    l1_table.updateQuote(instrument_id, best_bid, best_ask);
+    if (best_bid > 0.0 && best_ask > 0.0) {
+        double mid = 0.5 * (best_bid + best_ask);
+        uint64_t now_ms = utils::coarseNowMs();
+        volatility_table.onQuote(instrument_id, mid, now_ms);
+        vcm_states.onMarketData(instrument_id, mid, volatility_table.state(instrument_id), now_ms);
+    }
+}
+
+void rms::VCMModule::onTimer(uint64_t now_ms) {
+    vcm_states.onTimer(now_ms);
+}
+
+void rms::VCMModule::onLastTrade(uint32_t instrument_id, double price) {
+    l1_table.updateLast(instrument_id, price);
 }
 
 bool rms::VCMModule::checkSpread(const Order &order) {
     int inst_id = order.instrument_id;
-    const auto &lim = instrument_limits_shards[inst_id % NUM_SHARDS][inst_id];
-    double spread = 0.0; // stub
-    return spread <= lim.max_spread_ticks;
+    L1Snapshot quote;
+    if (!l1_table.read(inst_id, quote) || !quote.hasQuote()) {
+        return true;
+    }
+    // prices sit on the tick grid, so rounding removes binary noise from the division
+    double spread_ticks = (double)std::llround((quote.ask - quote.bid) / quote.tick_size);
+    return spread_ticks <= instrument_limits.max_spread_ticks[inst_id];
 }
 
 bool rms::VCMModule::checkVolatility(const Order &order) {
-    return true; // stub always pass
+    return volatility_table.state(order.instrument_id) != VolState::Breach;
+}
+
+bool rms::VCMModule::checkTradingState(const Order &order) {
+    VcmState state = vcm_states.state(order.instrument_id);
+    if (state == VcmState::Triggered) return false;
+    if (state != VcmState::CoolingOff) return true;
+    FixedPrice ref = price_scales.toFixed(order.instrument_id, vcm_states.referencePrice(order.instrument_id));
+    return std::abs(order.price - ref) <= PriceScales::fraction(ref, vcm_states.coolingBandPct());
 }
\ No newline at end of file
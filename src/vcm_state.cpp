@@ -0,0 +1,83 @@
+//
+// Created by muhammad-abdullah on 7/10/25.
+//
+
+// File: src/vcm_state.cpp
+#include "vcm_state.h"
+#include <algorithm>
+#include <cmath>
+
+rms::VcmStateMachine rms::vcm_states;
+
+void rms::VcmStateMachine::init(const VcmParams &params) {
+    params_ = params;
+    for (int i = 0; i < NUM_INSTRUMENTS; ++i) {
+        state_[i].store((uint8_t)VcmState::Normal, std::memory_order_relaxed);
+        ref_price_[i].store(0.0, std::memory_order_relaxed);
+        deadline_[i] = 0;
+    }
+    active_.clear();
+    active_.reserve(NUM_INSTRUMENTS);
+}
+
+void rms::VcmStateMachine::onMarketData(uint32_t i, double mid, VolState vol, uint64_t now_ms) {
+    if (i >= NUM_INSTRUMENTS) return;
+    switch (state(i)) {
+        case VcmState::Normal:
+        case VcmState::Resumed:
+            if (vol == VolState::Breach) transition(i, VcmState::Triggered, mid, now_ms);
+            break;
+        case VcmState::CoolingOff: {
+            double ref = referencePrice(i);
+            if (std::abs(mid - ref) > params_.cooling_band_pct * ref) {
+                transition(i, VcmState::Triggered, mid, now_ms);
+            }
+            break;
+        }
+        case VcmState::Triggered:
+            break;
+    }
+}
+
+void rms::VcmStateMachine::onTimer(uint64_t now_ms) {
+    for (size_t k = 0; k < active_.size();) {
+        uint32_t i = active_[k];
+        if (now_ms < deadline_[i]) {
+            ++k;
+            continue;
+        }
+        double ref = referencePrice(i);
+        switch (state(i)) {
+            case VcmState::Triggered:  transition(i, VcmState::CoolingOff, ref, now_ms); break;
+            case VcmState::CoolingOff: transition(i, VcmState::Resumed, ref, now_ms); break;
+            case VcmState::Resumed:    transition(i, VcmState::Normal, ref, now_ms); break;
+            case VcmState::Normal:     break;
+        }
+        // transition() may have dropped i from active_ by swapping in the last entry
+        if (k < active_.size() && active_[k] == i) ++k;
+    }
+}
+
+void rms::VcmStateMachine::transition(uint32_t i, VcmState to, double ref, uint64_t now_ms) {
+    VcmState from = state(i);
+    switch (to) {
+        case VcmState::Triggered:  deadline_[i] = now_ms + params_.halt_ms; break;
+        case VcmState::CoolingOff: deadline_[i] = now_ms + params_.cooling_ms; break;
+        case VcmState::Resumed:    deadline_[i] = now_ms + params_.resumed_ms; break;
+        case VcmState::Normal:     deadline_[i] = 0; break;
+    }
+    if (from == VcmState::Normal) {
+        active_.push_back(i);
+    }
+    else if (to == VcmState::Normal) {
+        auto it = std::find(active_.begin(), active_.end(), i);
+        *it = active_.back();
+        active_.pop_back();
+    }
+    // the reference price is in place before shards can observe the new state
+    ref_price_[i].store(ref, std::memory_order_relaxed);
+    state_[i].store((uint8_t)to, std::memory_order_release);
+    if (handler_) {
+        handler_(VcmTransition{now_ms, i, from, to, ref});
+    }
+}
@@ -0,0 +1,100 @@
+//
+// Created by muhammad-abdullah on 7/8/25.
+//
+
+// File: src/volatility.cpp
+#include "volatility.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+rms::VolatilityTable rms::volatility_table;
+
+namespace {
+    constexpr double kInf = std::numeric_limits<double>::infinity();
+}
+
+rms::VolatilityTable::VolatilityTable() {
+    std::fill_n(max_var_, NUM_INSTRUMENTS, kInf);
+    std::fill_n(max_range_, NUM_INSTRUMENTS, kInf);
+    init(VolatilityParams{});
+}
+
+void rms::VolatilityTable::init(const VolatilityParams &params) {
+    lambda_ = params.ewma_lambda;
+    range_ms_ = std::max<uint32_t>(params.range_ms, 1);
+    std::fill_n(last_mid_, NUM_INSTRUMENTS, 0.0);
+    std::fill_n(ewma_var_, NUM_INSTRUMENTS, 0.0);
+    std::fill_n(cur_high_, NUM_INSTRUMENTS, 0.0);
+    std::fill_n(cur_low_, NUM_INSTRUMENTS, 0.0);
+    std::fill_n(prev_high_, NUM_INSTRUMENTS, 0.0);
+    std::fill_n(prev_low_, NUM_INSTRUMENTS, 0.0);
+    std::fill_n(bucket_, NUM_INSTRUMENTS, 0);
+    for (auto &s : state_) s.store((uint8_t)VolState::Normal, std::memory_order_relaxed);
+}
+
+void rms::VolatilityTable::setBands(uint32_t instrument_id, double max_tick_vol, double max_range_pct) {
+    if (instrument_id >= NUM_INSTRUMENTS) return;
+    max_var_[instrument_id] = max_tick_vol > 0.0 ? max_tick_vol * max_tick_vol : kInf;
+    max_range_[instrument_id] = max_range_pct > 0.0 ? max_range_pct : kInf;
+}
+
+bool rms::VolatilityTable::breached(double ewma_var, double max_var, double range, double max_range) {
+    return ewma_var > max_var || range > max_range;
+}
+
+void rms::VolatilityTable::onQuote(uint32_t i, double mid, uint64_t now_ms) {
+    if (i >= NUM_INSTRUMENTS || !(mid > 0.0)) return;
+    double prev = last_mid_[i];
+    if (prev > 0.0) {
+        double r = std::log(mid / prev);
+        ewma_var_[i] = lambda_ * ewma_var_[i] + (1.0 - lambda_) * r * r;
+    }
+    last_mid_[i] = mid;
+
+    // two buckets of range_ms: the range covers the current one and the one before
+    uint64_t bucket = now_ms / range_ms_;
+    if (bucket != bucket_[i] || prev <= 0.0) {
+        bool adjacent = prev > 0.0 && bucket == bucket_[i] + 1;
+        prev_high_[i] = adjacent ? cur_high_[i] : mid;
+        prev_low_[i] = adjacent ? cur_low_[i] : mid;
+        cur_high_[i] = mid;
+        cur_low_[i] = mid;
+        bucket_[i] = bucket;
+    }
+    else {
+        cur_high_[i] = std::max(cur_high_[i], mid);
+        cur_low_[i] = std::min(cur_low_[i], mid);
+    }
+    double range = (std::max(cur_high_[i], prev_high_[i]) - std::min(cur_low_[i], prev_low_[i])) / mid;
+    VolState s = breached(ewma_var_[i], max_var_[i], range, max_range_[i]) ? VolState::Breach : VolState::Normal;
+    if (state_[i].load(std::memory_order_relaxed) != (uint8_t)s) {
+        state_[i].store((uint8_t)s, std::memory_order_relaxed);
+    }
+}
+
+void rms::VolatilityTable::recompute() {
+    alignas(64) uint8_t next[NUM_INSTRUMENTS];
+    // branch-free over plain arrays so the compiler emits packed compares
+    for (int i = 0; i < NUM_INSTRUMENTS; ++i) {
+        double hi = std::max(cur_high_[i], prev_high_[i]);
+        double lo = std::min(cur_low_[i], prev_low_[i]);
+        double mid = last_mid_[i] > 0.0 ? last_mid_[i] : 1.0;
+        double range = (hi - lo) / mid;
+        next[i] = (uint8_t)((ewma_var_[i] > max_var_[i]) | (range > max_range_[i]));
+    }
+    for (int i = 0; i < NUM_INSTRUMENTS; ++i) {
+        state_[i].store(next[i], std::memory_order_relaxed);
+    }
+}
+
+double rms::VolatilityTable::tickVol(uint32_t instrument_id) const {
+    return std::sqrt(ewma_var_[instrument_id]);
+}
+
+double rms::VolatilityTable::rangePct(uint32_t instrument_id) const {
+    double mid = last_mid_[instrument_id];
+    if (!(mid > 0.0)) return 0.0;
+    return (std::max(cur_high_[instrument_id], prev_high_[instrument_id])
+            - std::min(cur_low_[instrument_id], prev_low_[instrument_id])) / mid;
+}
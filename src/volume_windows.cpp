@@ -0,0 +1,108 @@
+//
+// Created by muhammad-abdullah on 7/2/25.
+//
+
+// File: src/volume_windows.cpp
+#include "volume_windows.h"
+#include <algorithm>
+
+rms::VolumeWindows rms::volume_windows;
+
+void rms::VolumeWindows::init(const VolumeWindowParams &params) {
+    buckets_ = std::max<uint32_t>(params.buckets, 1);
+    bucket_ms_ = std::max<uint32_t>(params.window_ms / buckets_, 1);
+    rings_per_block_ = std::max<uint32_t>(params.rings_per_block, 1);
+    for (auto &shard : shards_) {
+        shard = Shard{};
+    }
+}
+
+void rms::VolumeWindows::resize(uint32_t shards) {
+    shards_ = std::vector<Shard>(shards);
+}
+
+void rms::VolumeWindows::onTrade(uint32_t account_id, uint32_t instrument_id, int64_t qty, double notional, uint64_t now_ms) {
+    Shard &shard = shards_[shardOf(account_id)];
+    uint64_t key = positionKey(account_id, instrument_id);
+    uint64_t bucket = now_ms / bucket_ms_;
+    auto it = shard.index.find(key);
+    uint32_t ring = it == shard.index.end() ? acquire(shard, key, bucket) : it->second;
+    advance(shard, ring, bucket);
+    Bucket &slot = slots(shard, ring)[bucket % buckets_];
+    slot.qty += qty;
+    slot.notional += notional;
+    RingHeader &h = shard.headers[ring];
+    h.total.qty += qty;
+    h.total.notional += notional;
+}
+
+rms::WindowVolume rms::VolumeWindows::volume(uint32_t account_id, uint32_t instrument_id, uint64_t now_ms) {
+    Shard &shard = shards_[shardOf(account_id)];
+    auto it = shard.index.find(positionKey(account_id, instrument_id));
+    if (it == shard.index.end()) return WindowVolume{};
+    advance(shard, it->second, now_ms / bucket_ms_);
+    return shard.headers[it->second].total;
+}
+
+size_t rms::VolumeWindows::reclaim(int shard_id, uint64_t now_ms, size_t max_rings) {
+    Shard &shard = shards_[shard_id];
+    size_t n = std::min(max_rings, shard.headers.size());
+    uint64_t bucket = now_ms / bucket_ms_;
+    size_t freed = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (shard.cursor >= shard.headers.size()) shard.cursor = 0;
+        uint32_t ring = (uint32_t)shard.cursor++;
+        RingHeader &h = shard.headers[ring];
+        // every slot has aged out once the newest one is a full window old
+        if (h.in_use && bucket >= h.last_bucket + buckets_) {
+            shard.index.erase(h.key);
+            h.in_use = false;
+            shard.free.push_back(ring);
+            ++freed;
+        }
+    }
+    return freed;
+}
+
+uint32_t rms::VolumeWindows::acquire(Shard &shard, uint64_t key, uint64_t bucket) {
+    uint32_t ring;
+    if (!shard.free.empty()) {
+        ring = shard.free.back();
+        shard.free.pop_back();
+    }
+    else {
+        ring = (uint32_t)shard.headers.size();
+        if (ring % rings_per_block_ == 0) {
+            shard.blocks.emplace_back(new Bucket[(size_t)rings_per_block_ * buckets_]);
+        }
+        shard.headers.push_back(RingHeader{});
+    }
+    std::fill_n(slots(shard, ring), buckets_, Bucket{0, 0.0});
+    shard.headers[ring] = RingHeader{key, bucket, WindowVolume{}, true};
+    shard.index.emplace(key, ring);
+    return ring;
+}
+
+rms::VolumeWindows::Bucket *rms::VolumeWindows::slots(Shard &shard, uint32_t ring) const {
+    return shard.blocks[ring / rings_per_block_].get() + (size_t)(ring % rings_per_block_) * buckets_;
+}
+
+void rms::VolumeWindows::advance(Shard &shard, uint32_t ring, uint64_t bucket) {
+    RingHeader &h = shard.headers[ring];
+    if (bucket <= h.last_bucket) return;
+    Bucket *ring_slots = slots(shard, ring);
+    if (bucket - h.last_bucket >= buckets_) {
+        std::fill_n(ring_slots, buckets_, Bucket{0, 0.0});
+        h.total = WindowVolume{};
+    }
+    else {
+        // expire the slots the window slid past
+        for (uint64_t b = h.last_bucket + 1; b <= bucket; ++b) {
+            Bucket &slot = ring_slots[b % buckets_];
+            h.total.qty -= slot.qty;
+            h.total.notional -= slot.notional;
+            slot = Bucket{0, 0.0};
+        }
+    }
+    h.last_bucket = bucket;
+}
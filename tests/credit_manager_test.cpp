@@ -0,0 +1,79 @@
+//
+// Created by muhammad-abdullah on 6/23/25.
+//
+// File: tests/credit_manager_test.cpp
+#include <gtest/gtest.h>
+#include <thread>
+#include "credit_manager.h"
+
+TEST(CreditManagerTest, SliceRunsDryButLineDoesNot) {
+    rms::CreditManager credit;
+    int32_t line = credit.addLine("FIRM", 1000.0, 100.0);
+    for (uint32_t acct = 0; acct < rms::shard_layout.shards(); ++acct) credit.assignAccount(acct, line);
+    credit.finalize();
+    EXPECT_EQ(credit.available(line), rms::CreditManager::toUnits(1000.0));
+
+    // shard 0 can use the whole line even though other shards hold slices
+    EXPECT_TRUE(credit.tryConsume(0, 950.0));
+    EXPECT_FALSE(credit.tryConsume(1, 60.0));
+    EXPECT_TRUE(credit.tryConsume(1, 50.0));
+    EXPECT_EQ(credit.available(line), 0);
+    EXPECT_FALSE(credit.tryConsume(2, 0.01));
+
+    credit.adjust(0, -200.0);
+    EXPECT_TRUE(credit.tryConsume(3, 200.0));
+    EXPECT_TRUE(credit.tryConsume(42, 1e12));   // account without a line
+}
+
+TEST(CreditManagerTest, RebalanceReturnsSurplus) {
+    rms::CreditManager credit;
+    int32_t line = credit.addLine("FIRM", 10000.0, 100.0);
+    credit.assignAccount(0, line);
+    credit.finalize();
+    credit.adjust(0, 1000.0);    // a fill takes more than the slice holds
+    EXPECT_EQ(credit.slice(line, 0), rms::CreditManager::toUnits(-900.0));
+    credit.rebalance(0);
+    EXPECT_EQ(credit.slice(line, 0), rms::CreditManager::toUnits(100.0));
+    credit.adjust(0, -1000.0);   // the position closes: the release lands on shard 0's slice
+    EXPECT_EQ(credit.slice(line, 0), rms::CreditManager::toUnits(1100.0));
+    credit.rebalance(0);
+    EXPECT_EQ(credit.slice(line, 0), rms::CreditManager::toUnits(100.0));
+    EXPECT_EQ(credit.available(line), rms::CreditManager::toUnits(10000.0));
+}
+
+TEST(CreditManagerTest, ReleasesAreCappedAtWhatWasConsumed) {
+    rms::CreditManager credit;
+    int32_t line = credit.addLine("FIRM", 10000.0, 100.0);
+    credit.assignAccount(0, line);
+    credit.finalize();
+    EXPECT_TRUE(credit.tryConsume(0, 300.0));
+    EXPECT_EQ(credit.used(line), rms::CreditManager::toUnits(300.0));
+    credit.adjust(0, -1000.0);
+    EXPECT_EQ(credit.used(line), 0);
+    EXPECT_EQ(credit.available(line), rms::CreditManager::toUnits(10000.0));
+    credit.adjust(0, -50.0);     // nothing left to release
+    EXPECT_EQ(credit.available(line), rms::CreditManager::toUnits(10000.0));
+}
+
+TEST(CreditManagerTest, ConcurrentShardsExhaustExactly) {
+    rms::CreditManager credit;
+    int32_t line = credit.addLine("FIRM", 5000.0, 10.0);
+    for (uint32_t acct = 0; acct < rms::shard_layout.shards(); ++acct) credit.assignAccount(acct, line);
+    credit.finalize();
+    std::atomic<int64_t> granted{0};
+    std::vector<std::thread> shards;
+    for (uint32_t acct = 0; acct < rms::shard_layout.shards(); ++acct) {
+        shards.emplace_back([&, acct] {
+            int failures = 0;
+            while (failures < 100) {
+                if (credit.tryConsume(acct, 1.0)) granted.fetch_add(1);
+                else ++failures;
+                if ((granted.load() & 63) == 0) credit.rebalance(acct);
+            }
+        });
+    }
+    for (auto &t : shards) t.join();
+    EXPECT_EQ(granted.load(), 5000);
+    EXPECT_EQ(credit.available(line), 0);
+    EXPECT_EQ(credit.used(line), rms::CreditManager::toUnits(5000.0));
+}
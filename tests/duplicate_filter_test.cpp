@@ -0,0 +1,64 @@
+//
+// Created by muhammad-abdullah on 6/16/25.
+//
+// File: tests/duplicate_filter_test.cpp
+#include <gtest/gtest.h>
+#include "duplicate_filter.h"
+
+TEST(DuplicateOrderFilterTest, NoFalseNegativesInsideWindow) {
+    rms::DuplicateOrderFilter filter;
+    rms::DuplicateFilterParams params;
+    params.ids_per_generation = 1u << 16;
+    filter.init(params, 0);
+    for (uint64_t id = 1; id <= 50000; ++id) filter.insert(id * 7919);
+    for (uint64_t id = 1; id <= 50000; ++id) EXPECT_TRUE(filter.mayContain(id * 7919));
+
+    uint32_t false_hits = 0;
+    for (uint64_t id = 1; id <= 50000; ++id) false_hits += filter.mayContain(id * 7919 + 1);
+    EXPECT_LT(false_hits, 500u); // well under 1% at 16 bits per id
+}
+
+TEST(DuplicateOrderFilterTest, IdsAgeOutAfterWindow) {
+    rms::DuplicateOrderFilter filter;
+    rms::DuplicateFilterParams params;
+    params.generations = 4;
+    params.ids_per_generation = 1024;
+    params.window_ms = 3000;
+    filter.init(params, 0);
+    filter.insert(42);
+    filter.advance(1000);
+    filter.advance(2000);
+    filter.advance(3000);
+    EXPECT_TRUE(filter.mayContain(42));   // still inside the window
+    filter.advance(4000);
+    EXPECT_FALSE(filter.mayContain(42));
+    EXPECT_EQ(filter.rotations(), 4u);
+}
+
+TEST(DuplicateOrderFilterTest, MemoryIsFixedUnderBurst) {
+    rms::DuplicateOrderFilter filter;
+    rms::DuplicateFilterParams params;
+    params.ids_per_generation = 4096;
+    filter.init(params, 0);
+    size_t bytes = filter.memoryBytes();
+    for (uint64_t id = 0; id < 100000; ++id) filter.insert(id);
+    EXPECT_EQ(filter.memoryBytes(), bytes);
+    EXPECT_TRUE(filter.mayContain(99999));
+    EXPECT_GT(filter.rotations(), 0u);
+}
+
+TEST(DuplicateOrderFilterTest, ReusedGenerationStartsEmpty) {
+    rms::DuplicateOrderFilter filter;
+    rms::DuplicateFilterParams params;
+    params.generations = 4;
+    params.ids_per_generation = 1024;
+    filter.init(params, 0);
+    for (uint64_t id = 0; id < 1024; ++id) filter.insert(id);
+    // every slot, the spare included, is written again
+    for (uint64_t id = 0; id < 6 * 1024; ++id) filter.insert((1ull << 40) + id);
+    EXPECT_EQ(filter.rotations(), 6u);
+    uint32_t stale = 0;
+    for (uint64_t id = 0; id < 1024; ++id) stale += filter.mayContain(id);
+    EXPECT_LT(stale, 50u);
+    for (uint64_t id = 3 * 1024; id < 6 * 1024; ++id) EXPECT_TRUE(filter.mayContain((1ull << 40) + id));
+}
@@ -0,0 +1,108 @@
+//
+// Created by muhammad-abdullah on 7/24/25.
+//
+// File: tests/historical_var_test.cpp
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <vector>
+#include "historical_var.h"
+#include "limit_tree.h"
+#include "reference_price.h"
+
+namespace {
+    constexpr uint32_t SCENARIOS = 100;
+
+    // 90 returns -5%..+4.9% across the history, 91 exactly the opposite
+    std::string writeReturns() {
+        std::vector<double> columns(92 * SCENARIOS, 0.0);
+        for (uint32_t s = 0; s < SCENARIOS; ++s) {
+            columns[90 * SCENARIOS + s] = ((double)s - 50.0) / 1000.0;
+            columns[91 * SCENARIOS + s] = -((double)s - 50.0) / 1000.0;
+        }
+        std::string path = testing::TempDir() + "var_returns.bin";
+        EXPECT_TRUE(rms::HistoricalVarEngine::writeFile(path, 92, SCENARIOS, columns.data()));
+        return path;
+    }
+
+    Position makePosition(int64_t qty) {
+        Position pos;
+        pos.net_qty = qty;
+        return pos;
+    }
+}
+
+TEST(HistoricalVarTest, AccountAndDeskVarFollowFills) {
+    rms::limit_tree.clear();
+    int32_t firm = rms::limit_tree.addNode("FIRM", rms::LimitLevel::Firm, -1, 1e12);
+    int32_t desk = rms::limit_tree.addNode("DESK", rms::LimitLevel::Desk, firm, 1e12);
+    ASSERT_TRUE(rms::limit_tree.assignAccount(3, desk));
+    ASSERT_TRUE(rms::limit_tree.assignAccount(6, desk));
+    rms::limit_tree.finalize();
+    std::string path = writeReturns();
+    auto &var = rms::historical_var;
+    ASSERT_TRUE(var.load(path));
+    EXPECT_EQ(var.scenarios(), SCENARIOS);
+    EXPECT_EQ(var.returns(92), nullptr);
+
+    // 1000 of exposure: the second worst day of 100 is -4.9%
+    Position long3 = makePosition(100);
+    var.onPosition(3, 90, long3, 10.0);
+    EXPECT_NEAR(var.var(3), 49.0, 1e-9);
+    // the mirror position on another shard hedges the desk completely
+    Position long6 = makePosition(100);
+    var.onPosition(6, 91, long6, 10.0);
+    EXPECT_NEAR(var.var(6), 48.0, 1e-9);
+    std::vector<double> scratch;
+    EXPECT_NEAR(var.nodeVar(desk, scratch), 0.0, 1e-9);
+
+    // selling half of 90 leaves the desk net short of its return
+    long3.net_qty = 50;
+    var.onPosition(3, 90, long3, 10.0);
+    EXPECT_NEAR(var.var(3), 24.5, 1e-9);
+    EXPECT_NEAR(var.nodeVar(desk, scratch), 24.0, 1e-9);
+    EXPECT_NEAR(var.nodeVar(firm, scratch), 24.0, 1e-9);
+
+    rms::limit_tree.clear();
+    var.unload();
+    std::remove(path.c_str());
+}
+
+TEST(HistoricalVarTest, SlicedRecomputeRepricesWithoutLosingFills) {
+    rms::limit_tree.clear();
+    rms::limit_tree.finalize();
+    std::string path = writeReturns();
+    auto &var = rms::historical_var;
+    ASSERT_TRUE(var.load(path));
+
+    // accounts 3 and 7 share shard 3
+    Position long3 = makePosition(50);
+    Position short7 = makePosition(-10);
+    var.onPosition(3, 90, long3, 10.0);
+    var.onPosition(7, 91, short7, 10.0);
+    EXPECT_NEAR(var.var(3), 24.5, 1e-9);
+
+    // 90 doubles: the vectors still hold the exposure at 10 until a pass runs
+    rms::reference_prices.setPolicy(90, rms::RefPricePolicy::Settlement);
+    rms::reference_prices.setSettlement(90, 20.0);
+    EXPECT_NEAR(var.var(3), 24.5, 1e-9);
+
+    // one instrument per slice: 90 is rebuilt, then a fill lands before 91 is
+    EXPECT_FALSE(var.recomputeStep(3, 1));
+    long3.net_qty = 100;
+    var.onPosition(3, 90, long3, 10.0);
+    EXPECT_TRUE(var.recomputeStep(3, 1));
+    for (uint32_t s = 0; s < SCENARIOS; ++s) {
+        EXPECT_NEAR(var.pnl(3)[s], 2000.0 * var.returns(90)[s], 1e-9);
+        EXPECT_NEAR(var.pnl(7)[s], -100.0 * var.returns(91)[s], 1e-9);
+    }
+    EXPECT_NEAR(var.var(3), 98.0, 1e-9);
+
+    // a full pass at unchanged marks leaves the vectors where the fills put them
+    var.recomputeAll();
+    EXPECT_NEAR(var.var(3), 98.0, 1e-9);
+    EXPECT_NEAR(var.var(7), 4.9, 1e-9);
+
+    rms::reference_prices.setSettlement(90, 0.0);
+    var.unload();
+    std::remove(path.c_str());
+}
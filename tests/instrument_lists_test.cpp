@@ -0,0 +1,85 @@
+//
+// Created by muhammad-abdullah on 6/30/25.
+//
+// File: tests/instrument_lists_test.cpp
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include "instrument_lists.h"
+
+using rms::InstrumentListKind;
+
+TEST(InstrumentListsTest, ParseAndSwap) {
+    rms::InstrumentLists lists;
+    std::vector<uint32_t> ids;
+    std::string error;
+    const std::string text = "# restricted\n7, 64\n\t1000 7\n";
+    ASSERT_TRUE(rms::InstrumentLists::parseIds(text.data(), text.size(), ids, error)) << error;
+    EXPECT_EQ(ids, (std::vector<uint32_t>{7, 64, 1000, 7}));
+    const std::string bad = "12\n3x\n";
+    EXPECT_FALSE(rms::InstrumentLists::parseIds(bad.data(), bad.size(), ids, error));
+    EXPECT_NE(error.find("line 2"), std::string::npos);
+
+    EXPECT_FALSE(lists.contains(InstrumentListKind::Restricted, 7));
+    ASSERT_TRUE(lists.publish(InstrumentListKind::Restricted, {7, 64, 1000, 7}));
+    EXPECT_EQ(lists.size(InstrumentListKind::Restricted), 3u);
+    EXPECT_TRUE(lists.contains(InstrumentListKind::Restricted, 64));
+    EXPECT_FALSE(lists.contains(InstrumentListKind::Restricted, 65));
+    EXPECT_FALSE(lists.contains(InstrumentListKind::Restricted, 1u << 20));   // past the last word
+    EXPECT_FALSE(lists.contains(InstrumentListKind::HardToBorrow, 64));
+
+    // next day's list replaces the old one wholesale
+    ASSERT_TRUE(lists.publish(InstrumentListKind::Restricted, {65}));
+    EXPECT_FALSE(lists.contains(InstrumentListKind::Restricted, 64));
+    EXPECT_TRUE(lists.contains(InstrumentListKind::Restricted, 65));
+    EXPECT_FALSE(lists.publish(InstrumentListKind::Restricted, {rms::InstrumentSet::MAX_INSTRUMENT_ID}));
+    EXPECT_TRUE(lists.contains(InstrumentListKind::Restricted, 65));
+}
+
+TEST(InstrumentListsTest, LoadsLargeFile) {
+    const std::string path = "instrument_lists_test_ids.txt";
+    {
+        std::ofstream out(path);
+        for (uint32_t i = 0; i < 100000; ++i) out << i * 3 << '\n';
+    }
+    rms::InstrumentLists lists;
+    auto t0 = std::chrono::steady_clock::now();
+    ASSERT_TRUE(lists.loadFile(InstrumentListKind::HardToBorrow, path));
+    auto elapsed = std::chrono::steady_clock::now() - t0;
+    std::remove(path.c_str());
+
+    EXPECT_EQ(lists.size(InstrumentListKind::HardToBorrow), 100000u);
+    EXPECT_TRUE(lists.contains(InstrumentListKind::HardToBorrow, 299997));
+    EXPECT_FALSE(lists.contains(InstrumentListKind::HardToBorrow, 299998));
+    EXPECT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(), 250);
+}
+
+TEST(InstrumentListsTest, ReadersNeverSeeAFreedSet) {
+    rms::InstrumentLists lists;
+    ASSERT_TRUE(lists.publish(InstrumentListKind::Restricted, {5}));
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> misses{0};
+    std::vector<std::thread> readers;
+    for (uint32_t r = 0; r < 4; ++r) {
+        readers.emplace_back([&, r] {
+            lists.online(r);
+            while (!done.load(std::memory_order_relaxed)) {
+                // every published set holds 5
+                if (!lists.contains(InstrumentListKind::Restricted, 5)) misses.fetch_add(1);
+                lists.quiesce(r);
+            }
+            lists.offline(r);
+        });
+    }
+    for (uint32_t i = 0; i < 2000; ++i) {
+        ASSERT_TRUE(lists.publish(InstrumentListKind::Restricted, {5, 64 + i}));
+    }
+    done = true;
+    for (auto &t : readers) t.join();
+    EXPECT_EQ(misses.load(), 0u);
+    EXPECT_EQ(lists.size(InstrumentListKind::Restricted), 2u);
+    lists.clear();
+    EXPECT_FALSE(lists.contains(InstrumentListKind::Restricted, 5));
+}
@@ -7,19 +7,20 @@
 #include "vcm_module.h"
 #include "posttrade_controls.h"
 #include "data_types.h"
+#include "price_scale.h"
 
 TEST(IntegrationTest, OrderToTradeFlow) {
-    Order o{0,0,10,50,100.0};
+    Order o{0,0,10,50,rms::price_scales.toFixed(10, 100.0)};
     rms::PreTradeChecks pt;
-    instrument_limits_shards[0][0].max_order_qty = 50;
+    instrument_limits.max_order_qty[0] = 50;
     EXPECT_FALSE(pt.checkMaxOrderQty(o));
     o.quantity = 20;
     EXPECT_TRUE(pt.checkMaxOrderQty(o));
     rms::VCMModule vcm;
     EXPECT_TRUE(vcm.checkSpread(o));
-    TradeExecution t{0,0,20,50,100.0,true};
-    position_store[0][0] = Position();
+    TradeExecution t{0,0,20,50,rms::price_scales.toFixed(20, 100.0),true};
+    position_store[0].findOrInsert(0, 0) = Position();
     rms::PostTradeControls ptc;
     ptc.onTrade(t);
-    EXPECT_EQ(position_store[0][0].net_qty, 20);
+    EXPECT_EQ(position_store[0].findOrInsert(0, 0).net_qty, 20);
 }
\ No newline at end of file
@@ -0,0 +1,46 @@
+//
+// Created by muhammad-abdullah on 6/20/25.
+//
+// File: tests/limit_tree_test.cpp
+#include <gtest/gtest.h>
+#include "limit_tree.h"
+
+TEST(LimitTreeTest, CheckWalksAccountPath) {
+    rms::LimitTree tree;
+    int32_t firm = tree.addNode("FIRM", rms::LimitLevel::Firm, -1, 1000.0);
+    int32_t desk = tree.addNode("DESK", rms::LimitLevel::Desk, firm, 600.0);
+    int32_t trader = tree.addNode("TRADER", rms::LimitLevel::Trader, desk, 400.0);
+    ASSERT_TRUE(tree.assignAccount(1, trader));
+    ASSERT_TRUE(tree.assignAccount(2, desk));
+    tree.finalize();
+
+    EXPECT_EQ(tree.pathFor(1)->depth, 3);
+    EXPECT_TRUE(tree.check(1, 400.0));
+    EXPECT_FALSE(tree.check(1, 401.0));
+
+    // accounts on different shards both feed the desk
+    tree.addUsage(1, 300.0);
+    tree.addUsage(2, 250.0);
+    EXPECT_DOUBLE_EQ(tree.usage(desk), 550.0);
+    EXPECT_DOUBLE_EQ(tree.usage(firm), 550.0);
+    EXPECT_DOUBLE_EQ(tree.usage(trader), 300.0);
+    EXPECT_FALSE(tree.check(2, 60.0));   // desk cap
+    EXPECT_TRUE(tree.check(2, 50.0));
+
+    tree.addUsage(1, -300.0);
+    EXPECT_DOUBLE_EQ(tree.usage(desk), 250.0);
+    // accounts outside the tree are not capped by it
+    EXPECT_TRUE(tree.check(99, 1e12));
+}
+
+TEST(LimitTreeTest, RejectsTooDeepOrUnknownParent) {
+    rms::LimitTree tree;
+    int32_t n = tree.addNode("L0", rms::LimitLevel::Firm, -1, 1.0);
+    for (int i = 1; i < rms::MAX_LIMIT_DEPTH; ++i) {
+        n = tree.addNode("L" + std::to_string(i), rms::LimitLevel::Desk, n, 1.0);
+        ASSERT_GE(n, 0);
+    }
+    EXPECT_EQ(tree.addNode("too_deep", rms::LimitLevel::Account, n, 1.0), -1);
+    EXPECT_EQ(tree.addNode("orphan", rms::LimitLevel::Desk, 42, 1.0), -1);
+    EXPECT_EQ(tree.findNode("L2"), 2);
+}
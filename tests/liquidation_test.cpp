@@ -0,0 +1,164 @@
+//
+// Created by muhammad-abdullah on 7/21/25.
+//
+// File: tests/liquidation_test.cpp
+#include <gtest/gtest.h>
+#include <vector>
+#include "liquidation.h"
+#include "mark_to_market.h"
+#include "reference_price.h"
+#include "price_scale.h"
+
+namespace {
+    constexpr uint32_t ACCOUNT = 10;
+    // the tests run on the default layout
+    constexpr int SHARD = ACCOUNT % rms::ShardLayout::DEFAULT_SHARDS;
+
+    uint32_t slot() { return rms::shard_layout.assign(ACCOUNT); }
+
+    std::vector<rms::LiquidationOrder> drainAll(rms::LiquidationEngine &engine) {
+        std::vector<rms::LiquidationOrder> out;
+        engine.drain(SHARD, [&](const rms::LiquidationOrder &order) { out.push_back(order); });
+        return out;
+    }
+
+    void setPosition(uint32_t instrument_id, int64_t qty, double entry) {
+        Position &pos = position_store[SHARD].findOrInsert(ACCOUNT, instrument_id);
+        pos.net_qty = qty;
+        pos.avg_entry_price = entry;
+        rms::mark_to_market.onPosition(ACCOUNT, instrument_id, pos, entry);
+    }
+
+    void setMark(uint32_t instrument_id, double mark) {
+        rms::reference_prices.setPolicy(instrument_id, rms::RefPricePolicy::Settlement);
+        rms::reference_prices.setSettlement(instrument_id, mark);
+        rms::mark_to_market.onMarkChanged(instrument_id);
+        rms::mark_to_market.reprice(SHARD);
+    }
+
+    // long 100 @ 10 in 50, short 200 @ 20 in 51, 1000 of equity at session start
+    void setUpPositions(double max_drawdown_pct) {
+        rms::mark_to_market.clear();
+        position_store[SHARD].clear();
+        account_limits[SHARD].initial_equity[slot()] = 1000.0;
+        account_limits[SHARD].max_drawdown_pct[slot()] = max_drawdown_pct;
+        instrument_limits.init_margin_pct[50] = 0.1;
+        instrument_limits.maint_margin_pct[50] = 0.05;
+        instrument_limits.init_margin_pct[51] = 0.2;
+        instrument_limits.maint_margin_pct[51] = 0.1;
+        setMark(51, 20.0);
+        setPosition(50, 100, 10.0);
+        setPosition(51, -200, 20.0);
+        rms::mark_to_market.resetHighWaterMarks();
+    }
+
+    // 51 rallies to 24: the short loses 800, an 80% drawdown
+    void setUpBreach() {
+        setUpPositions(0.9);
+        setMark(51, 24.0);
+    }
+}
+
+TEST(LiquidationTest, MaintenanceBreachReducesTheBiggestMarginUser) {
+    setUpBreach();
+    EXPECT_DOUBLE_EQ(rms::mark_to_market.equity(ACCOUNT), 200.0);
+    EXPECT_DOUBLE_EQ(rms::mark_to_market.maintMargin(ACCOUNT), 530.0);
+    std::vector<uint32_t> repriced;
+    rms::mark_to_market.drainRepricedAccounts(SHARD, [&](uint32_t account_id) { repriced.push_back(account_id); });
+    ASSERT_EQ(repriced, std::vector<uint32_t>{ACCOUNT});
+
+    auto engine = std::make_unique<rms::LiquidationEngine>();
+    ASSERT_TRUE(engine->checkAccount(ACCOUNT, 1000));
+    auto orders = drainAll(*engine);
+    // initial margin 1060 against equity 200: buy back ceil(860 / 4.8) of the short
+    ASSERT_EQ(orders.size(), 1u);
+    EXPECT_EQ(orders[0].instrument_id, 51u);
+    EXPECT_TRUE(orders[0].is_buy);
+    EXPECT_EQ(orders[0].quantity, 180);
+    EXPECT_EQ(orders[0].price, rms::price_scales.toFixed(51, 24.0));
+    EXPECT_EQ(orders[0].reason, rms::LiquidationReason::MaintenanceMargin);
+
+    // the same breach seen again on the next ticks is covered by the order in flight
+    EXPECT_EQ(engine->inFlight(ACCOUNT, 51), 180);
+    EXPECT_TRUE(engine->checkAccount(ACCOUNT, 1100));
+    EXPECT_TRUE(engine->checkAccount(ACCOUNT, 60000));
+    EXPECT_TRUE(drainAll(*engine).empty());
+    EXPECT_EQ(engine->suppressed(), 2u);
+
+    // 100 of it fill; the test leaves the position alone, so only the 80 still out
+    // are netted: 860 - 80 * 4.8 is left to cover
+    TradeExecution fill{};
+    fill.order_id = orders[0].liquidation_id;
+    fill.account_id = ACCOUNT;
+    fill.instrument_id = 51;
+    fill.quantity = 100;
+    engine->onFill(fill);
+    EXPECT_EQ(engine->inFlight(ACCOUNT, 51), 80);
+    EXPECT_TRUE(engine->checkAccount(ACCOUNT, 60001));
+    auto more = drainAll(*engine);
+    ASSERT_EQ(more.size(), 1u);
+    EXPECT_EQ(more[0].quantity, 100);
+    EXPECT_EQ(engine->inFlight(ACCOUNT, 51), 180);
+
+    // the venue rejects the rest of the first order
+    EXPECT_FALSE(engine->onCancel(ACCOUNT + 1, orders[0].liquidation_id));
+    EXPECT_TRUE(engine->onCancel(ACCOUNT, orders[0].liquidation_id));
+    EXPECT_FALSE(engine->onCancel(ACCOUNT, orders[0].liquidation_id));
+    EXPECT_EQ(engine->inFlight(ACCOUNT, 51), 100);
+    EXPECT_EQ(engine->issued(), 2u);
+
+    engine->onPublished(orders[0], orders[0].breach_ns + 3000);
+    EXPECT_EQ(engine->latency().count.load(), 1u);
+    EXPECT_GE(engine->latency().percentileNs(0.99), 3000u);
+    account_limits[SHARD].initial_equity[slot()] = 0.0;
+}
+
+TEST(LiquidationTest, DrawdownAndExhaustedEquityFlatten) {
+    setUpBreach();
+    auto engine = std::make_unique<rms::LiquidationEngine>();
+    EXPECT_EQ(engine->onBreach(ACCOUNT, rms::LiquidationReason::Drawdown, 1000), 2u);
+    auto orders = drainAll(*engine);
+    ASSERT_EQ(orders.size(), 2u);
+    for (const auto &order : orders) {
+        EXPECT_EQ(order.reason, rms::LiquidationReason::Drawdown);
+        EXPECT_EQ(order.quantity, order.instrument_id == 50 ? 100 : 200);
+        EXPECT_EQ(order.is_buy, order.instrument_id == 51);
+    }
+    EXPECT_NE(orders[0].liquidation_id, orders[1].liquidation_id);
+
+    // a rally to 26 wipes out the equity: margin sizing no longer applies
+    setMark(51, 26.0);
+    EXPECT_LE(rms::mark_to_market.equity(ACCOUNT), 0.0);
+    auto fresh = std::make_unique<rms::LiquidationEngine>();
+    ASSERT_TRUE(fresh->checkAccount(ACCOUNT, 1000));
+    EXPECT_EQ(drainAll(*fresh).size(), 2u);
+
+    // without initial_equity the account is not margined at all
+    account_limits[SHARD].initial_equity[slot()] = 0.0;
+    EXPECT_FALSE(fresh->checkAccount(ACCOUNT, 5000));
+}
+
+TEST(LiquidationTest, DrawdownFromTheAccountHighWaterMark) {
+    setUpPositions(0.1);
+    auto engine = std::make_unique<rms::LiquidationEngine>();
+    EXPECT_DOUBLE_EQ(rms::mark_to_market.highWaterMark(ACCOUNT), 1000.0);
+
+    // the short gains 200 on a mark alone: the high-water mark follows
+    setMark(51, 19.0);
+    EXPECT_FALSE(engine->checkAccount(ACCOUNT, 1000));
+    EXPECT_DOUBLE_EQ(rms::mark_to_market.highWaterMark(ACCOUNT), 1200.0);
+
+    // back to 900: 25% off the 1200 peak, though still below the 1000 start only by 10%
+    setMark(51, 20.5);
+    EXPECT_DOUBLE_EQ(rms::mark_to_market.updateDrawdown(ACCOUNT), 0.25);
+    ASSERT_TRUE(engine->checkAccount(ACCOUNT, 1000));
+    auto orders = drainAll(*engine);
+    ASSERT_EQ(orders.size(), 2u);
+    EXPECT_EQ(orders[0].reason, rms::LiquidationReason::Drawdown);
+
+    // a new session measures from where equity stands
+    rms::mark_to_market.resetHighWaterMarks(SHARD);
+    EXPECT_DOUBLE_EQ(rms::mark_to_market.highWaterMark(ACCOUNT), 900.0);
+    EXPECT_DOUBLE_EQ(rms::mark_to_market.updateDrawdown(ACCOUNT), 0.0);
+    account_limits[SHARD].initial_equity[slot()] = 0.0;
+}
@@ -0,0 +1,100 @@
+//
+// Created by muhammad-abdullah on 7/18/25.
+//
+// File: tests/mark_to_market_test.cpp
+#include <gtest/gtest.h>
+#include "mark_to_market.h"
+#include "reference_price.h"
+
+namespace {
+    void setMid(uint32_t instrument_id, double mid) {
+        rms::reference_prices.onQuote(instrument_id, mid - 0.5, mid + 0.5);
+        rms::reference_prices.publish(instrument_id);
+        rms::mark_to_market.onMarkChanged(instrument_id);
+    }
+
+    Position makePosition(int64_t qty, double entry, double realized = 0.0) {
+        Position pos;
+        pos.net_qty = qty;
+        pos.avg_entry_price = entry;
+        pos.realized_pnl = realized;
+        return pos;
+    }
+}
+
+TEST(MarkToMarketTest, RepricesEveryPositionOnAMarkChange) {
+    auto &mtm = rms::mark_to_market;
+    mtm.clear();
+    account_limits[shardOf(4)].initial_equity[rms::shard_layout.assign(4)] = 10000.0;
+    rms::reference_prices.setPolicy(20, rms::RefPricePolicy::Mid);
+    setMid(20, 100.0);
+
+    // accounts 4 and 8 share shard 0; 4 is long, 8 short, 5 sits on another shard
+    Position long4 = makePosition(10, 95.0, 50.0);
+    Position short8 = makePosition(-3, 102.0);
+    Position long5 = makePosition(7, 90.0);
+    mtm.onPosition(4, 20, long4, 0.0);
+    mtm.onPosition(8, 20, short8, 0.0);
+    mtm.onPosition(5, 20, long5, 0.0);
+    EXPECT_DOUBLE_EQ(mtm.unrealizedPnl(4, 20, long4), 50.0);
+    EXPECT_DOUBLE_EQ(mtm.equity(4), 10000.0 + 50.0 + 50.0);
+
+    setMid(20, 110.0);
+    EXPECT_EQ(mtm.reprice(0), 1u);
+    EXPECT_EQ(mtm.reprice(0), 0u);   // flag consumed
+    EXPECT_DOUBLE_EQ(mtm.unrealizedPnl(4), 150.0);
+    EXPECT_DOUBLE_EQ(mtm.unrealizedPnl(8), -24.0);
+    EXPECT_DOUBLE_EQ(mtm.equity(4), 10000.0 + 50.0 + 150.0);
+    // other shards reprice on their own thread
+    EXPECT_DOUBLE_EQ(mtm.unrealizedPnl(5), 70.0);
+    EXPECT_EQ(mtm.reprice(shardOf(5)), 1u);
+    EXPECT_DOUBLE_EQ(mtm.unrealizedPnl(5), 140.0);
+
+    // a fill that closes half the long realizes PnL and updates the same row
+    long4.net_qty = 5;
+    long4.realized_pnl = 125.0;
+    mtm.onPosition(4, 20, long4, 0.0);
+    EXPECT_DOUBLE_EQ(mtm.unrealizedPnl(4), 75.0);
+    EXPECT_DOUBLE_EQ(mtm.realizedPnl(4), 125.0);
+    EXPECT_EQ(mtm.positions(0), 2u);
+    account_limits[shardOf(4)].initial_equity[rms::shard_layout.assign(4)] = 0.0;
+}
+
+TEST(MarkToMarketTest, SweepMatchesIncrementalTotals) {
+    auto &mtm = rms::mark_to_market;
+    mtm.clear();
+    std::vector<Position> positions;
+    positions.reserve(600);
+    // more rows than a vector width, with a remainder
+    for (uint32_t k = 0; k < 600; ++k) {
+        uint32_t account = (k % 37) * rms::shard_layout.shards();
+        uint32_t instrument = 30 + k % 3;
+        positions.push_back(makePosition((int64_t)(k % 11) - 5, 50.0 + k % 7, k * 0.25));
+        mtm.onPosition(account, instrument, positions.back(), 51.0);
+    }
+    for (uint32_t i = 30; i < 33; ++i) {
+        rms::reference_prices.setPolicy(i, rms::RefPricePolicy::Mid);
+        setMid(i, 52.0 + i);
+    }
+    EXPECT_EQ(mtm.reprice(0), 3u);
+    double incremental[37], incremental_margin[37];
+    for (uint32_t a = 0; a < 37; ++a) {
+        incremental[a] = mtm.equity(a * rms::shard_layout.shards());
+        incremental_margin[a] = mtm.initMargin(a * rms::shard_layout.shards());
+    }
+    mtm.sweep(0);
+    for (uint32_t a = 0; a < 37; ++a) {
+        double expected = 0.0, expected_margin = 0.0;
+        for (uint32_t k = a; k < 600; k += 37) {
+            const Position &pos = positions[k];
+            uint32_t instrument = 30 + k % 3;
+            double mark = 52.0 + instrument;
+            expected += pos.realized_pnl + (mark - pos.avg_entry_price) * pos.net_qty;
+            expected_margin += std::abs(pos.net_qty) * mark * instrument_limits.init_margin_pct[instrument];
+        }
+        EXPECT_NEAR(mtm.equity(a * rms::shard_layout.shards()), expected, 1e-6);
+        EXPECT_NEAR(incremental[a], expected, 1e-6);
+        EXPECT_NEAR(mtm.initMargin(a * rms::shard_layout.shards()), expected_margin, 1e-6);
+        EXPECT_NEAR(incremental_margin[a], expected_margin, 1e-6);
+    }
+}
@@ -0,0 +1,51 @@
+//
+// Created by muhammad-abdullah on 7/12/25.
+//
+// File: tests/market_data_test.cpp
+#include <gtest/gtest.h>
+#include <memory>
+#include "market_data.h"
+#include "l1_table.h"
+#include "reference_price.h"
+
+TEST(MarketDataTest, ConflatesToLatestAndDropsStale) {
+    auto conflator = std::make_unique<rms::MarketDataConflator>();
+    rms::VCMModule vcm;
+    const uint32_t inst = 40;
+    // a burst for one instrument: only the last quote and last trade survive
+    for (uint64_t seq = 1; seq <= 100; ++seq) {
+        ASSERT_TRUE(conflator->offer({seq, inst, rms::MD_HAS_QUOTE, 50.0 + seq * 0.01, 50.02 + seq * 0.01, 0.0}));
+    }
+    ASSERT_TRUE(conflator->offer({101, inst, rms::MD_HAS_LAST, 0.0, 0.0, 51.0}));
+    EXPECT_FALSE(conflator->offer({99, inst, rms::MD_HAS_QUOTE, 1.0, 2.0, 0.0}));     // stale
+    EXPECT_FALSE(conflator->offer({101, inst, rms::MD_HAS_QUOTE, 1.0, 2.0, 0.0}));    // replay
+    EXPECT_FALSE(conflator->offer({5, NUM_INSTRUMENTS, rms::MD_HAS_QUOTE, 1.0, 2.0, 0.0}));
+    ASSERT_TRUE(conflator->offer({1, inst + 1, rms::MD_HAS_QUOTE, 10.0, 10.1, 0.0}));
+    EXPECT_EQ(conflator->staleDropped(), 2u);
+    EXPECT_EQ(conflator->conflated(), 100u);
+
+    EXPECT_EQ(conflator->drain(vcm), 2u);
+    rms::L1Snapshot snap;
+    ASSERT_TRUE(rms::l1_table.read(inst, snap));
+    EXPECT_DOUBLE_EQ(snap.bid, 51.0);
+    EXPECT_DOUBLE_EQ(snap.ask, 51.02);
+    EXPECT_DOUBLE_EQ(snap.last, 51.0);
+    ASSERT_TRUE(rms::l1_table.read(inst + 1, snap));
+    EXPECT_DOUBLE_EQ(snap.ask, 10.1);
+
+    // nothing pending: a second drain publishes nothing
+    EXPECT_EQ(conflator->drain(vcm), 0u);
+}
+
+TEST(MarketDataTest, EveryTradeReachesVwap) {
+    auto conflator = std::make_unique<rms::MarketDataConflator>();
+    rms::VCMModule vcm;
+    const uint32_t inst = 42;
+    rms::reference_prices.setPolicy(inst, rms::RefPricePolicy::Vwap);
+    // conflated into one publish, but all three prints count towards the VWAP
+    conflator->offer({1, inst, rms::MD_HAS_LAST, 0.0, 0.0, 10.0, 100});
+    conflator->offer({2, inst, rms::MD_HAS_LAST, 0.0, 0.0, 11.0, 100});
+    conflator->offer({3, inst, rms::MD_HAS_LAST | rms::MD_HAS_QUOTE, 11.9, 12.1, 12.0, 200});
+    conflator->drain(vcm);
+    EXPECT_DOUBLE_EQ(rms::reference_prices.reference(inst), (1000.0 + 1100.0 + 2400.0) / 400.0);
+}
@@ -0,0 +1,64 @@
+//
+// Created by muhammad-abdullah on 7/16/25.
+//
+// File: tests/position_table_test.cpp
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include "data_types.h"
+
+TEST(PositionTableTest, KeysByAccountAndInstrument) {
+    PositionTable table(16);
+    EXPECT_EQ(table.find(1, 7), nullptr);
+    table.findOrInsert(1, 7).net_qty = 10;
+    table.findOrInsert(2, 7).net_qty = -4;     // same instrument, different account
+    EXPECT_EQ(table.find(1, 7)->net_qty, 10);
+    EXPECT_EQ(table.find(2, 7)->net_qty, -4);
+    EXPECT_EQ(table.find(7, 1), nullptr);
+    EXPECT_EQ(table.size(), 2u);
+    table.findOrInsert(1, 7).net_qty += 5;
+    EXPECT_EQ(table.find(1, 7)->net_qty, 15);
+    EXPECT_EQ(table.size(), 2u);
+    table.clear();
+    EXPECT_EQ(table.find(1, 7), nullptr);
+    EXPECT_EQ(table.size(), 0u);
+}
+
+TEST(PositionTableTest, GrowsAndIteratesPerAccount) {
+    PositionTable table(16);
+    std::mt19937_64 rng(5);
+    std::map<uint64_t, int64_t> expected;
+    for (int i = 0; i < 50000; ++i) {
+        uint32_t account = (uint32_t)(rng() % 64);
+        uint32_t inst = (uint32_t)(rng() % 4096);
+        int64_t qty = (int64_t)(rng() % 100) - 50;
+        table.findOrInsert(account, inst).net_qty += qty;
+        expected[positionKey(account, inst)] += qty;
+    }
+    EXPECT_EQ(table.size(), expected.size());
+    EXPECT_LE(table.size() * 10, table.capacity() * 7);
+    for (const auto &[key, qty] : expected) {
+        const Position *pos = table.find((uint32_t)(key >> 32), (uint32_t)key);
+        ASSERT_NE(pos, nullptr);
+        ASSERT_EQ(pos->net_qty, qty);
+    }
+
+    // the per-account chain visits exactly that account's instruments, after rehashes too
+    size_t visited = 0;
+    int64_t sum = 0, expected_sum = 0;
+    table.forEachOfAccount(17, [&](uint32_t inst, Position &pos) {
+        ++visited;
+        sum += pos.net_qty;
+        EXPECT_TRUE(expected.count(positionKey(17, inst)));
+    });
+    size_t expected_visits = 0;
+    for (const auto &[key, qty] : expected) {
+        if ((key >> 32) == 17) {
+            ++expected_visits;
+            expected_sum += qty;
+        }
+    }
+    EXPECT_EQ(visited, expected_visits);
+    EXPECT_EQ(sum, expected_sum);
+    table.forEachOfAccount(1000, [&](uint32_t, Position &) { ADD_FAILURE(); });
+}
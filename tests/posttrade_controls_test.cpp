@@ -5,11 +5,133 @@
 #include <gtest/gtest.h>
 #include "posttrade_controls.h"
 #include "data_types.h"
+#include "price_scale.h"
 TEST(PostTradeControlsTest, BasicPnL) {
     rms::PostTradeControls pt;
-    TradeExecution t{0,0,10,50,100.0,true};
-    position_store[0][0] = Position();
+    TradeExecution t{0,0,10,50,rms::price_scales.toFixed(10, 100.0),true};
+    position_store[0].findOrInsert(0, 0) = Position();
     pt.onTrade(t);
     // After buy, unrealized_pnl = 0
-    EXPECT_EQ(position_store[0][0].net_qty, 10);
-}
\ No newline at end of file
+    EXPECT_EQ(position_store[0].findOrInsert(0, 0).net_qty, 10);
+}
+TEST(PostTradeControlsTest, ReplayedTradeIsAppliedOnce) {
+    rms::PostTradeControls pt;
+    TradeExecution t{};
+    t.account_id = 8;
+    t.instrument_id = 3;
+    t.quantity = 5;
+    t.price = rms::price_scales.toFixed(3, 100.0);
+    t.is_buy = true;
+    t.venue_id = 2;
+    t.trade_id = 41;
+    position_store[0].findOrInsert(8, 3) = Position();
+    EXPECT_TRUE(pt.onTrade(t));
+    EXPECT_FALSE(pt.onTrade(t));   // drop-copy replay
+    EXPECT_EQ(position_store[0].findOrInsert(8, 3).net_qty, 5);
+    t.trade_id = 42;
+    EXPECT_TRUE(pt.onTrade(t));
+    EXPECT_EQ(position_store[0].findOrInsert(8, 3).net_qty, 10);
+    EXPECT_EQ(pt.dedupe().duplicates(), 1u);
+}
+
+TEST(PostTradeControlsTest, TradesBelowTheDedupeWindowAreCheckedAgainstTheLedger) {
+    rms::PostTradeControls pt;
+    TradeExecution t{};
+    t.account_id = 8;
+    t.instrument_id = 3;
+    t.quantity = 1;
+    t.price = rms::price_scales.toFixed(3, 100.0);
+    t.is_buy = true;
+    t.venue_id = 4;
+    position_store[0].findOrInsert(8, 3) = Position();
+    // this shard gets every fourth id of the venue; 9 is still in flight when
+    // the venue runs past the window
+    for (uint64_t id : {5u, 13u, 17u}) {
+        t.trade_id = id;
+        ASSERT_TRUE(pt.onTrade(t));
+    }
+    t.trade_id = 1u << 20;
+    ASSERT_TRUE(pt.onTrade(t));
+    t.trade_id = 9;
+    EXPECT_TRUE(pt.onTrade(t));    // a genuine late fill is applied
+    EXPECT_FALSE(pt.onTrade(t));   // and only once
+    t.trade_id = 13;
+    EXPECT_FALSE(pt.onTrade(t));   // replayed from long ago
+    EXPECT_EQ(position_store[0].findOrInsert(8, 3).net_qty, 5);
+    EXPECT_EQ(pt.dedupe().duplicates(), 0u);
+    EXPECT_EQ(pt.dedupe().unknown(), 3u);
+}
+
+TEST(PostTradeControlsTest, BustTakesTheTradeBack) {
+    rms::PostTradeControls pt;
+    TradeExecution t{};
+    t.account_id = 12;
+    t.instrument_id = 3;
+    t.quantity = 6;
+    t.price = rms::price_scales.toFixed(3, 50.0);
+    t.is_buy = true;
+    t.venue_id = 1;
+    t.trade_id = 7;
+    position_store[0].findOrInsert(12, 3) = Position();
+    ASSERT_TRUE(pt.onTrade(t));
+    EXPECT_EQ(position_store[0].findOrInsert(12, 3).net_qty, 6);
+
+    TradeCorrection bust{12, 3, 1, 7, 0, 0, TradeCorrectionKind::Bust};
+    EXPECT_TRUE(pt.onCorrection(bust));
+    EXPECT_EQ(position_store[0].findOrInsert(12, 3).net_qty, 0);
+    EXPECT_FALSE(pt.onCorrection(bust));
+}
+
+TEST(PostTradeControlsTest, OutOfRangeInstrumentsTouchNoTable) {
+    rms::PostTradeControls pt;
+    TradeExecution t{};
+    t.account_id = 0xFFFFFFFF;
+    t.quantity = 1;
+    t.price = 100;
+    t.is_buy = true;
+    t.venue_id = 1;
+    t.trade_id = 9;
+    int shard = shardOf(t.account_id);
+    size_t positions = position_store[shard].size();
+    for (uint32_t instrument_id : {(uint32_t)NUM_INSTRUMENTS, 0xFFFFFFFFu}) {
+        t.instrument_id = instrument_id;
+        EXPECT_FALSE(pt.onTrade(t));
+        TradeCorrection bust{t.account_id, instrument_id, 1, 9, 0, 0, TradeCorrectionKind::Bust};
+        EXPECT_FALSE(pt.onCorrection(bust));
+    }
+    EXPECT_EQ(position_store[shard].size(), positions);
+    EXPECT_EQ(pt.ledger().trades(), 0u);
+    // the id was not recorded either: the same trade on a valid instrument still applies
+    t.account_id = 12;
+    t.instrument_id = 3;
+    EXPECT_TRUE(pt.onTrade(t));
+}
+
+TEST(PostTradeControlsTest, SessionResetForgetsTradesButKeepsPositions) {
+    rms::PostTradeControls pt;
+    TradeExecution t{};
+    t.account_id = 16;
+    t.instrument_id = 3;
+    t.quantity = 4;
+    t.price = rms::price_scales.toFixed(3, 20.0);
+    t.is_buy = true;
+    t.venue_id = 3;
+    t.trade_id = 90;
+    position_store[0].findOrInsert(16, 3) = Position();
+    ASSERT_TRUE(pt.onTrade(t));
+    pt.resetSession();
+    EXPECT_EQ(pt.ledger().trades(), 0u);
+
+    // yesterday's trade can no longer be busted
+    TradeCorrection bust{16, 3, 3, 90, 0, 0, TradeCorrectionKind::Bust};
+    EXPECT_FALSE(pt.onCorrection(bust));
+    EXPECT_EQ(position_store[0].findOrInsert(16, 3).net_qty, 4);
+
+    // today's fills still close against the carried position
+    t.trade_id = 91;
+    t.is_buy = false;
+    t.quantity = 1;
+    ASSERT_TRUE(pt.onTrade(t));
+    EXPECT_EQ(position_store[0].findOrInsert(16, 3).net_qty, 3);
+    EXPECT_EQ(pt.ledger().openLots(16, 3), 1u);
+}
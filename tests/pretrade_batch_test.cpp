@@ -0,0 +1,96 @@
+//
+// Created by muhammad-abdullah on 6/12/25.
+//
+// File: tests/pretrade_batch_test.cpp
+#include <gtest/gtest.h>
+#include <random>
+#include "pretrade_batch.h"
+#include "pretrade_checks.h"
+#include "data_types.h"
+#include "price_scale.h"
+
+static Order makeOrder(std::mt19937_64 &rng) {
+    Order o{};
+    o.order_id = rng();
+    o.account_id = rng() % 16;
+    o.instrument_id = rng() % 8;
+    o.quantity = (int64_t)(rng() % 300) - 100;
+    o.price = rms::price_scales.toFixed(o.instrument_id, 90.0 + (double)(rng() % 2000) / 100.0);
+    return o;
+}
+
+TEST(PreTradeBatchTest, KernelsMatchScalarChecks) {
+    std::mt19937_64 rng(42);
+    for (uint32_t inst = 0; inst < 8; ++inst) {
+        InstrumentLimits lim;
+        lim.max_order_qty = 100;
+        lim.max_order_notional = 15000.0;
+        lim.price_tolerance_pct = 0.05;
+        lim.max_daily_position = 150;
+        instrument_limits.set(inst, lim);
+    }
+    for (uint32_t account = 0; account < 16; ++account) {
+        for (uint32_t inst = 0; inst < 8; ++inst) {
+            position_store[shardOf(account)].findOrInsert(account, inst).net_qty = (int64_t)(rng() % 200) - 100;
+        }
+    }
+    const double ref = 100.0;
+    rms::PreTradeChecks scalar;
+    for (uint32_t n : {1u, 3u, 7u, 13u, 64u}) {
+        std::vector<Order> orders;
+        rms::PreTradeBatch batch;
+        for (uint32_t i = 0; i < n; ++i) {
+            orders.push_back(makeOrder(rng));
+            batch.gather(orders.back(), ref);
+        }
+        uint64_t expected = 0;
+        for (uint32_t i = 0; i < n; ++i) {
+            const Order &o = orders[i];
+            bool pass = scalar.checkMaxOrderQty(o) && scalar.checkMaxOrderNotional(o)
+                        && scalar.checkPriceBand(o, ref) && scalar.checkPositionLimit(o);
+            if (!pass) expected |= 1ULL << i;
+        }
+        for (auto isa : {rms::BatchIsa::Scalar, rms::BatchIsa::Avx2, rms::BatchIsa::Avx512}) {
+            if (!rms::PreTradeBatch::isaSupported(isa)) continue;
+            EXPECT_EQ(batch.evaluate(isa).any(), expected) << rms::PreTradeBatch::isaName(isa) << " n=" << n;
+        }
+    }
+}
+
+TEST(PreTradeBatchTest, NoReferencePriceSkipsBand) {
+    instrument_limits.max_order_qty[0] = 100;
+    instrument_limits.max_order_notional[0] = 1e9;
+    instrument_limits.max_daily_position[0] = 1000;
+    position_store[0].findOrInsert(0, 0) = Position();
+    rms::PreTradeBatch batch;
+    Order o{0, 0, 0, 10, rms::price_scales.toFixed(0, 5000.0)};
+    batch.gather(o, 0.0);
+    o.quantity = 500;
+    batch.gather(o, 0.0);
+    rms::BatchRejects r = batch.evaluate();
+    EXPECT_EQ(r.price_band, 0u);
+    EXPECT_EQ(r.max_qty, 0b10u);
+    EXPECT_EQ(batch.size(), 2u);
+}
+
+TEST(PreTradeBatchTest, NotionalOverflowIsRejected) {
+    instrument_limits.max_order_qty[0] = INT32_MAX;
+    instrument_limits.max_order_notional[0] = 1e6;
+    instrument_limits.max_daily_position[0] = INT32_MAX;
+    position_store[0].findOrInsert(0, 0) = Position();
+    // 1e6 * 2^62 wraps int64 to 0
+    Order o{0, 0, 0, 1000000, (int64_t)1 << 62};
+    EXPECT_EQ(rms::PriceScales::notionalUnits(o.quantity, o.price), INT64_MAX);
+    EXPECT_EQ(rms::PriceScales::notionalUnits(-o.quantity, o.price), -INT64_MAX);
+    rms::PreTradeChecks scalar;
+    EXPECT_FALSE(scalar.checkMaxOrderNotional(o));
+    for (auto isa : {rms::BatchIsa::Scalar, rms::BatchIsa::Avx2, rms::BatchIsa::Avx512}) {
+        if (!rms::PreTradeBatch::isaSupported(isa)) continue;
+        rms::PreTradeBatch batch;
+        batch.gather(o, 0.0);
+        o.quantity = -o.quantity;
+        batch.gather(o, 0.0);
+        o.quantity = -o.quantity;
+        EXPECT_EQ(batch.evaluate(isa).notional, 0b11u) << rms::PreTradeBatch::isaName(isa);
+    }
+}
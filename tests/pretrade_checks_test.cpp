@@ -5,14 +5,166 @@
 #include <gtest/gtest.h>
 #include "pretrade_checks.h"
 #include "data_types.h"
+#include "open_orders.h"
+#include "instrument_lists.h"
+#include "volume_windows.h"
+#include "reference_price.h"
+#include "mark_to_market.h"
+#include "price_scale.h"
+
+namespace {
+    FixedPrice px(uint32_t instrument_id, double price) { return rms::price_scales.toFixed(instrument_id, price); }
+}
 
 TEST(PreTradeChecksTest, MaxOrderQty) {
     rms::PreTradeChecks checker;
-    Order o{0, 0, 50, 50,100.0};
-    instrument_limits_shards[0][0].max_order_qty = 100;
+    Order o{0, 0, 50, 50,px(50, 100.0)};
+    instrument_limits.max_order_qty[0] = 100;
     EXPECT_TRUE(checker.checkMaxOrderQty(o));
     std::cout<< checker.checkMaxOrderQty(o) << std::endl;
     o.quantity = 150;
     EXPECT_FALSE(checker.checkMaxOrderQty(o));
     std::cout<< checker.checkMaxOrderQty(o) << std::endl;
 }
+
+TEST(PreTradeChecksTest, PositionLimitCountsWorkingOrders) {
+    rms::PreTradeChecks checker;
+    rms::OpenOrderTracker open_orders;
+    instrument_limits.max_daily_position[3] = 100;
+    position_store[1].findOrInsert(1, 3).net_qty = 20;
+    Order o{0, 1, 3, 30, px(3, 100.0), "", "BUY"};
+    // three resting buys of 30 on top of a 20 long use up 110 of the 100 limit
+    for (uint64_t id = 1; id <= 2; ++id) {
+        o.order_id = id;
+        ASSERT_TRUE(checker.checkPositionLimit(o));
+        ASSERT_TRUE(open_orders.onAccepted(o));
+    }
+    o.order_id = 3;
+    EXPECT_FALSE(checker.checkPositionLimit(o));
+
+    // a sell only widens the short side: 20 - 30 stays inside the limit
+    Order s{4, 1, 3, 30, px(3, 100.0), "", "SELL"};
+    EXPECT_TRUE(checker.checkPositionLimit(s));
+
+    // cancelling and filling release working quantity
+    EXPECT_TRUE(open_orders.onCancel(1, 1));
+    EXPECT_TRUE(checker.checkPositionLimit(o));
+    TradeExecution fill{2, 1, 3, 30, px(3, 100.0), "", true};
+    open_orders.onFill(fill);
+    EXPECT_EQ(open_orders.exposure(1, 3).buy_qty, 0);
+    EXPECT_FALSE(open_orders.isOpen(1, 2));
+}
+
+TEST(PreTradeChecksTest, RestrictedAndHardToBorrow) {
+    rms::PreTradeChecks checker;
+    rms::OpenOrderTracker open_orders;
+    ASSERT_TRUE(rms::instrument_lists.publish(rms::InstrumentListKind::Restricted, {9}));
+    ASSERT_TRUE(rms::instrument_lists.publish(rms::InstrumentListKind::HardToBorrow, {5}));
+    Order o{10, 2, 9, 10, px(9, 100.0), "", "BUY"};
+    EXPECT_FALSE(checker.checkRestricted(o));
+    o.instrument_id = 5;
+    EXPECT_TRUE(checker.checkRestricted(o));
+
+    // long 25: selling 20 is fine, but a second working sell of 20 would go short
+    position_store[2].findOrInsert(2, 5).net_qty = 25;
+    Order s{11, 2, 5, 20, px(5, 100.0), "", "SELL"};
+    EXPECT_TRUE(checker.checkShortSell(s));
+    ASSERT_TRUE(open_orders.onAccepted(s));
+    s.order_id = 12;
+    EXPECT_FALSE(checker.checkShortSell(s));
+    s.quantity = 5;
+    EXPECT_TRUE(checker.checkShortSell(s));
+    // buys and easy-to-borrow names are not affected
+    o.quantity = 1000;
+    EXPECT_TRUE(checker.checkShortSell(o));
+    s.instrument_id = 6;
+    s.quantity = 1000;
+    EXPECT_TRUE(checker.checkShortSell(s));
+    rms::instrument_lists.clear();
+}
+
+TEST(PreTradeChecksTest, WindowVolume) {
+    rms::PreTradeChecks checker;
+    instrument_limits.max_window_qty[4] = 100;
+    instrument_limits.max_window_notional[4] = 0.0;
+    uint64_t now = 5000000;
+    rms::volume_windows.onTrade(3, 4, 80, 8000.0, now);
+    Order o{20, 3, 4, 20, px(4, 100.0), "", "BUY"};
+    EXPECT_TRUE(checker.checkWindowVolume(o, now));
+    o.quantity = 21;
+    EXPECT_FALSE(checker.checkWindowVolume(o, now));
+    instrument_limits.max_window_qty[4] = 0;
+    instrument_limits.max_window_notional[4] = 10000.0;
+    EXPECT_FALSE(checker.checkWindowVolume(o, now));         // 8000 + 2100 > 10000
+    o.quantity = 10;
+    EXPECT_TRUE(checker.checkWindowVolume(o, now));
+    instrument_limits.max_window_notional[4] = 0.0;
+}
+
+TEST(PreTradeChecksTest, PriceBandUsesReferencePrice) {
+    rms::PreTradeChecks checker;
+    instrument_limits.price_tolerance_pct[21] = 0.05;
+    Order o{30, 0, 21, 1, px(21, 120.0), "", "BUY"};
+    EXPECT_TRUE(checker.checkPriceBand(o));           // no reference yet
+    rms::reference_prices.setPolicy(21, rms::RefPricePolicy::Settlement);
+    rms::reference_prices.setSettlement(21, 100.0);
+    EXPECT_FALSE(checker.checkPriceBand(o));
+    o.price = px(21, 104.0);
+    EXPECT_TRUE(checker.checkPriceBand(o));
+}
+
+TEST(PreTradeChecksTest, InitialMarginAgainstLiveEquity) {
+    rms::PreTradeChecks checker;
+    instrument_limits.init_margin_pct[40] = 0.1;
+    instrument_limits.maint_margin_pct[40] = 0.05;
+    Order o{40, 6, 40, 600, px(40, 100.0), "", "BUY"};
+    EXPECT_TRUE(checker.checkInitialMargin(o));       // no initial_equity: not enforced
+    account_limits[shardOf(6)].initial_equity[rms::shard_layout.assign(6)] = 10000.0;
+
+    Position &pos = position_store[shardOf(6)].findOrInsert(6, 40);
+    pos.net_qty = 500;
+    pos.avg_entry_price = 100.0;
+    rms::mark_to_market.onPosition(6, 40, pos, 100.0);
+    EXPECT_DOUBLE_EQ(rms::mark_to_market.initMargin(6), 5000.0);
+    EXPECT_FALSE(checker.checkInitialMargin(o));      // 5000 + 6000 > 10000
+    o.quantity = 400;
+    EXPECT_TRUE(checker.checkInitialMargin(o));
+    Order reduce{41, 6, 40, 900, px(40, 100.0), "", "SELL"};  // ends 400 short: less gross than now
+    EXPECT_TRUE(checker.checkInitialMargin(reduce));
+
+    // a rally lifts equity faster than margin
+    rms::reference_prices.setPolicy(40, rms::RefPricePolicy::Settlement);
+    rms::reference_prices.setSettlement(40, 120.0);
+    rms::mark_to_market.onMarkChanged(40);
+    rms::mark_to_market.reprice(shardOf(6));
+    EXPECT_DOUBLE_EQ(rms::mark_to_market.equity(6), 20000.0);
+    EXPECT_DOUBLE_EQ(rms::mark_to_market.initMargin(6), 6000.0);
+    EXPECT_DOUBLE_EQ(rms::mark_to_market.maintMargin(6), 3000.0);
+    o.quantity = 600;
+    EXPECT_TRUE(checker.checkInitialMargin(o));       // 6000 + 7200 <= 20000
+    account_limits[shardOf(6)].initial_equity[rms::shard_layout.assign(6)] = 0.0;
+}
+
+TEST(PreTradeChecksTest, TickGridAndBandEdgeAreExact) {
+    rms::PreTradeChecks checker;
+    ASSERT_TRUE(rms::price_scales.setDecimals(22, 2));
+    ASSERT_TRUE(rms::price_scales.setTickSize(22, 0.05));
+    EXPECT_FALSE(rms::price_scales.setTickSize(22, 0.005));     // finer than a cent
+    Order o{50, 0, 22, 1, px(22, 100.05), "", "BUY"};
+    EXPECT_EQ(o.price, 10005);
+    EXPECT_TRUE(checker.checkTickSize(o));
+    o.price = px(22, 100.07);
+    EXPECT_FALSE(checker.checkTickSize(o));
+    o.price = 0;
+    EXPECT_FALSE(checker.checkTickSize(o));
+
+    // 0.29 * 100.0 is 28.999999999999996 in doubles; the band edge itself must pass
+    instrument_limits.price_tolerance_pct[22] = 0.29;
+    o.price = px(22, 129.0);
+    EXPECT_TRUE(checker.checkPriceBand(o, 100.0));
+    o.price = px(22, 129.01);
+    EXPECT_FALSE(checker.checkPriceBand(o, 100.0));
+    o.price = px(22, 71.0);
+    EXPECT_TRUE(checker.checkPriceBand(o, 100.0));
+    rms::price_scales.setDecimals(22, rms::PriceScales::DEFAULT_DECIMALS);
+}
@@ -0,0 +1,59 @@
+//
+// Created by muhammad-abdullah on 7/14/25.
+//
+// File: tests/reference_price_test.cpp
+#include <gtest/gtest.h>
+#include <memory>
+#include "reference_price.h"
+
+using rms::RefPricePolicy;
+
+TEST(ReferencePriceTest, PoliciesAndFallbacks) {
+    auto ref = std::make_unique<rms::ReferencePriceEngine>();
+    ref->setPolicy(1, RefPricePolicy::Mid);
+    ref->setPolicy(2, RefPricePolicy::Last);
+    ref->setPolicy(3, RefPricePolicy::Vwap);
+    ref->setPolicy(4, RefPricePolicy::Settlement);
+    EXPECT_DOUBLE_EQ(ref->reference(1), 0.0);
+
+    for (uint32_t i = 1; i <= 4; ++i) {
+        ref->onQuote(i, 99.0, 101.0);
+        ref->publish(i);
+    }
+    EXPECT_DOUBLE_EQ(ref->reference(1), 100.0);
+    EXPECT_DOUBLE_EQ(ref->reference(2), 100.0);   // no trade yet: falls back to mid
+    EXPECT_DOUBLE_EQ(ref->reference(3), 100.0);
+    EXPECT_DOUBLE_EQ(ref->reference(4), 0.0);     // settlement never falls back
+
+    for (uint32_t i = 1; i <= 4; ++i) {
+        ref->onTrade(i, 100.5, 100);
+        ref->onTrade(i, 102.0, 300);
+        ref->publish(i);
+    }
+    EXPECT_DOUBLE_EQ(ref->reference(1), 100.0);
+    EXPECT_DOUBLE_EQ(ref->reference(2), 102.0);
+    EXPECT_DOUBLE_EQ(ref->reference(3), (100.5 * 100 + 102.0 * 300) / 400);
+    ref->setSettlement(4, 98.25);
+    EXPECT_DOUBLE_EQ(ref->reference(4), 98.25);
+    EXPECT_DOUBLE_EQ(ref->reference(NUM_INSTRUMENTS), 0.0);
+}
+
+TEST(ReferencePriceTest, SessionResetClearsVwap) {
+    auto ref = std::make_unique<rms::ReferencePriceEngine>();
+    ref->setPolicy(7, RefPricePolicy::Vwap);
+    ref->onTrade(7, 50.0, 10);
+    ref->publish(7);
+    EXPECT_DOUBLE_EQ(ref->vwap(7), 50.0);
+    ref->resetSession();
+    EXPECT_DOUBLE_EQ(ref->vwap(7), 0.0);
+    EXPECT_DOUBLE_EQ(ref->reference(7), 0.0);
+    ref->onTrade(7, 60.0, 5);
+    ref->onTrade(7, 0.0, 5);                      // bad print ignored
+    ref->publish(7);
+    EXPECT_DOUBLE_EQ(ref->reference(7), 60.0);
+
+    rms::RefPricePolicy policy;
+    EXPECT_TRUE(rms::ReferencePriceEngine::parsePolicy("settlement", policy));
+    EXPECT_EQ(policy, RefPricePolicy::Settlement);
+    EXPECT_FALSE(rms::ReferencePriceEngine::parsePolicy("close", policy));
+}
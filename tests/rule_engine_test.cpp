@@ -0,0 +1,123 @@
+//
+// Created by muhammad-abdullah on 6/26/25.
+//
+// File: tests/rule_engine_test.cpp
+#include <gtest/gtest.h>
+#include "rule_engine.h"
+#include "mark_to_market.h"
+#include "scenario_margin.h"
+#include "price_scale.h"
+
+namespace {
+    rms::RuleContext contextWith(std::initializer_list<std::pair<rms::RuleVar, double>> values) {
+        rms::RuleContext ctx{};
+        for (const auto &[var, value] : values) ctx.vars[(int)var] = value;
+        return ctx;
+    }
+
+    double evalExpr(const std::string &expr, const rms::RuleContext &ctx = rms::RuleContext{}) {
+        rms::CompiledRule rule{"test", expr, {}};
+        std::string error;
+        EXPECT_TRUE(rms::RuleSet::compile(expr, rule.code, error)) << error;
+        return rms::RuleSet::run(rule, ctx);
+    }
+}
+
+TEST(RuleEngineTest, PrecedenceAndFunctions) {
+    EXPECT_DOUBLE_EQ(evalExpr("1 + 2 * 3"), 7.0);
+    EXPECT_DOUBLE_EQ(evalExpr("(1 + 2) * 3"), 9.0);
+    EXPECT_DOUBLE_EQ(evalExpr("10 - 4 - 3"), 3.0);
+    EXPECT_DOUBLE_EQ(evalExpr("-2 * -3"), 6.0);
+    EXPECT_DOUBLE_EQ(evalExpr("1 < 2 && 3 > 4 || true"), 1.0);
+    EXPECT_DOUBLE_EQ(evalExpr("not (1 < 2) or false"), 0.0);
+    EXPECT_DOUBLE_EQ(evalExpr("max(abs(-5), min(3, 8))"), 5.0);
+
+    auto ctx = contextWith({{rms::RuleVar::OrderQty, 50}, {rms::RuleVar::LimitMaxOrderQty, 100}});
+    EXPECT_DOUBLE_EQ(evalExpr("order.qty > 0.4 * limit.max_order_qty", ctx), 1.0);
+    EXPECT_DOUBLE_EQ(evalExpr("order.quantity >= 2 * limit.max_order_qty / 4 + 1", ctx), 0.0);
+}
+
+TEST(RuleEngineTest, FoldsConstantsAndReportsErrors) {
+    std::vector<rms::RuleInstr> code;
+    std::string error;
+    ASSERT_TRUE(rms::RuleSet::compile("order.notional > 0.2 * 1000000", code, error));
+    // var, folded constant, compare
+    ASSERT_EQ(code.size(), 3u);
+    EXPECT_EQ(code[1].op, rms::RuleOp::PushConst);
+    EXPECT_DOUBLE_EQ(code[1].value, 200000.0);
+
+    EXPECT_FALSE(rms::RuleSet::compile("order.bogus > 1", code, error));
+    EXPECT_NE(error.find("unknown field"), std::string::npos);
+    EXPECT_FALSE(rms::RuleSet::compile("(order.qty > 1", code, error));
+    EXPECT_FALSE(rms::RuleSet::compile("order.qty >", code, error));
+    EXPECT_FALSE(rms::RuleSet::compile("order.qty > 1 1", code, error));
+    EXPECT_FALSE(rms::RuleSet::compile("sqrt(order.qty)", code, error));
+
+    // 17 live operands overflow the fixed stack
+    std::string deep = "order.qty";
+    for (int i = 0; i < rms::RULE_MAX_STACK; ++i) deep = "order.qty + (" + deep + ")";
+    EXPECT_FALSE(rms::RuleSet::compile(deep, code, error));
+    EXPECT_NE(error.find("too deep"), std::string::npos);
+}
+
+TEST(RuleEngineTest, EvaluateRejectsAndCountsPerRule) {
+    instrument_limits.max_order_notional[7] = 10000.0;
+    instrument_limits.max_order_qty[7] = 100;
+
+    rms::RuleSet rules;
+    std::string error;
+    ASSERT_TRUE(rules.addRule("BIG_QTY", "order.qty > 0.5 * limit.max_order_qty", error)) << error;
+    ASSERT_TRUE(rules.addRule("BIG_NOTIONAL", "abs(order.notional) > 0.2 * limit.max_order_notional", error)) << error;
+    ASSERT_FALSE(rules.addRule("BROKEN", "order.qty >", error));
+    EXPECT_EQ(rules.size(), 2u);
+
+    Order order{1, 5, 7, 10, rms::price_scales.toFixed(7, 100.0), "ABC", "BUY"};
+    EXPECT_EQ(rules.evaluate(order, 1), -1);        // notional 1000 < 2000
+    order.quantity = 60;
+    EXPECT_EQ(rules.evaluate(order, 1), 0);
+    order.quantity = 30;
+    EXPECT_EQ(rules.evaluate(order, 1), 1);         // notional 3000 > 2000
+
+    EXPECT_EQ(rules.stats(0).evaluations, 3u);
+    EXPECT_EQ(rules.stats(0).rejects, 1u);
+    EXPECT_EQ(rules.stats(1).evaluations, 2u);
+    EXPECT_EQ(rules.stats(1).rejects, 1u);
+
+    rules.clear();
+    EXPECT_EQ(rules.evaluate(order, 1), -1);
+}
+
+TEST(RuleEngineTest, BindsLiveAccountEquity) {
+    account_limits[shardOf(9)].initial_equity[rms::shard_layout.assign(9)] = 5000.0;
+    Position pos;
+    pos.net_qty = 10;
+    pos.avg_entry_price = 100.0;
+    pos.realized_pnl = -200.0;
+    rms::mark_to_market.onPosition(9, 11, pos, 90.0);   // marked at the fill price: -100
+
+    rms::RuleSet rules;
+    std::string error;
+    ASSERT_TRUE(rules.addRule("LOW_EQUITY", "account.equity < order.notional", error)) << error;
+    Order order{1, 9, 11, 40, rms::price_scales.toFixed(11, 100.0), "ABC", "BUY"};
+    EXPECT_EQ(rules.evaluate(order, shardOf(9)), -1);   // equity 4700 >= 4000
+    order.quantity = 50;
+    EXPECT_EQ(rules.evaluate(order, shardOf(9)), 0);
+    account_limits[shardOf(9)].initial_equity[rms::shard_layout.assign(9)] = 0.0;
+}
+
+TEST(RuleEngineTest, BindsScenarioMargin) {
+    rms::scenario_margin.setLinearScenarios(12, 2.0);
+    Position pos;
+    pos.net_qty = -30;
+    rms::scenario_margin.onPosition(9, 12, pos);   // worst case: up a full scan range, -60
+
+    rms::RuleSet rules;
+    std::string error;
+    ASSERT_TRUE(rules.addRule("SPAN_CAP", "account.scenario_margin > 50", error)) << error;
+    Order order{1, 9, 12, 1, rms::price_scales.toFixed(12, 100.0), "ABC", "BUY"};
+    EXPECT_EQ(rules.evaluate(order, shardOf(9)), 0);
+    pos.net_qty = -20;
+    rms::scenario_margin.onPosition(9, 12, pos);
+    EXPECT_EQ(rules.evaluate(order, shardOf(9)), -1);
+    rms::scenario_margin.clear();
+}
@@ -0,0 +1,94 @@
+//
+// Created by muhammad-abdullah on 7/23/25.
+//
+// File: tests/scenario_margin_test.cpp
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "scenario_margin.h"
+
+namespace {
+    Position makePosition(int64_t qty) {
+        Position pos;
+        pos.net_qty = qty;
+        return pos;
+    }
+}
+
+TEST(ScenarioMarginTest, OffsettingPositionsNetAcrossTheGrid) {
+    auto &span = rms::scenario_margin;
+    span.clear();
+    span.setLinearScenarios(60, 3.0);
+    span.setLinearScenarios(61, 3.0);
+    // a long straddle-like payoff: gains on big moves either way, bleeds when nothing happens
+    double option[rms::ScenarioMarginEngine::SCENARIOS] = {
+        -1.0, -0.5, -0.6, -0.2, -0.6, -0.2, 0.4, 0.8, 0.4, 0.8, 2.0, 2.5, 2.0, 2.5, 3.0, 3.0,
+    };
+    span.setScenarios(62, option);
+
+    Position long60 = makePosition(10);
+    span.onPosition(7, 60, long60);
+    EXPECT_NEAR(span.riskArray(7)[12], -30.0, 1e-9);   // price down a full scan range
+    EXPECT_NEAR(span.scenarioMargin(7), 31.5, 1e-9);   // down three scan ranges, 35% covered
+
+    // a short in an instrument with the same grid hedges it completely
+    Position short61 = makePosition(-10);
+    span.onPosition(7, 61, short61);
+    EXPECT_DOUBLE_EQ(span.scenarioMargin(7), 0.0);
+
+    // reducing the hedge brings half the risk back, on the same row
+    short61.net_qty = -5;
+    span.onPosition(7, 61, short61);
+    EXPECT_NEAR(span.scenarioMargin(7), 15.75, 1e-9);
+    EXPECT_EQ(span.positions(shardOf(7)), 2u);
+
+    // the option position loses most when the market does not move
+    Position option62 = makePosition(4);
+    span.onPosition(11, 62, option62);
+    EXPECT_DOUBLE_EQ(span.scenarioMargin(11), 4.0);
+    // accounts on the same shard do not share a risk array
+    EXPECT_NEAR(span.scenarioMargin(7), 15.75, 1e-9);
+}
+
+TEST(ScenarioMarginTest, RecomputeMatchesIncrementalUpdates) {
+    auto &span = rms::scenario_margin;
+    span.clear();
+    std::mt19937_64 rng(44);
+    for (uint32_t i = 70; i < 80; ++i) {
+        double pnl[rms::ScenarioMarginEngine::SCENARIOS];
+        for (double &p : pnl) p = (double)(rng() % 2001) / 100.0 - 10.0;
+        span.setScenarios(i, pnl);
+    }
+    std::vector<Position> positions(3000);
+    std::vector<uint32_t> accounts(positions.size()), instruments(positions.size());
+    for (size_t k = 0; k < positions.size(); ++k) {
+        accounts[k] = (uint32_t)(k % 101);
+        instruments[k] = 70 + (uint32_t)(k / 101) % 10;
+        positions[k].net_qty = (int64_t)(rng() % 201) - 100;
+        span.onPosition(accounts[k], instruments[k], positions[k]);
+    }
+    // a few fills on positions that already exist
+    for (size_t k = 0; k < positions.size(); k += 7) {
+        positions[k].net_qty += 13;
+        span.onPosition(accounts[k], instruments[k], positions[k]);
+    }
+
+    std::vector<std::vector<double>> incremental;
+    for (uint32_t a = 0; a < 101; ++a) {
+        const double *risk = span.riskArray(a);
+        incremental.emplace_back(risk, risk + rms::ScenarioMarginEngine::SCENARIOS);
+    }
+    span.recomputeAll();
+    for (uint32_t a = 0; a < 101; ++a) {
+        double expected[rms::ScenarioMarginEngine::SCENARIOS] = {};
+        for (size_t k = a; k < positions.size(); k += 101) {
+            for (int s = 0; s < rms::ScenarioMarginEngine::SCENARIOS; ++s) {
+                expected[s] += (double)positions[k].net_qty * span.scenarios(instruments[k])[s];
+            }
+        }
+        for (int s = 0; s < rms::ScenarioMarginEngine::SCENARIOS; ++s) {
+            EXPECT_NEAR(span.riskArray(a)[s], expected[s], 1e-6);
+            EXPECT_NEAR(incremental[a][s], expected[s], 1e-6);
+        }
+    }
+}
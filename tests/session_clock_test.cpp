@@ -0,0 +1,36 @@
+//
+// Created by muhammad-abdullah on 7/31/25.
+//
+// File: tests/session_clock_test.cpp
+#include <gtest/gtest.h>
+#include "session_clock.h"
+
+TEST(SessionClockTest, ParsesTimeOfDay) {
+    uint32_t ms = 0;
+    ASSERT_TRUE(rms::SessionClock::parseTimeOfDay("22:00", ms));
+    EXPECT_EQ(ms, 22u * 3600 * 1000);
+    ASSERT_TRUE(rms::SessionClock::parseTimeOfDay("08:30:15", ms));
+    EXPECT_EQ(ms, (8u * 3600 + 30 * 60 + 15) * 1000);
+    EXPECT_FALSE(rms::SessionClock::parseTimeOfDay("8:30", ms));
+    EXPECT_FALSE(rms::SessionClock::parseTimeOfDay("24:00", ms));
+    EXPECT_FALSE(rms::SessionClock::parseTimeOfDay("08:60", ms));
+    EXPECT_FALSE(rms::SessionClock::parseTimeOfDay("08:30:", ms));
+    EXPECT_FALSE(rms::SessionClock::parseTimeOfDay("08:30:00:00", ms));
+}
+
+TEST(SessionClockTest, SessionChangesOnceADayAtStart) {
+    rms::SessionClock clock;
+    const uint64_t day = rms::SessionClock::DAY_MS;
+    const uint64_t monday = 20000 * day;   // a UTC midnight
+    EXPECT_EQ(clock.session(monday), clock.session(monday + 5 * day));   // one run, one session
+
+    rms::SessionParams params;
+    params.daily = true;
+    params.start_utc_ms = 22u * 3600 * 1000;
+    clock.init(params);
+    uint64_t open = monday + params.start_utc_ms;
+    EXPECT_EQ(clock.session(open - 1), clock.session(monday));
+    EXPECT_EQ(clock.session(open), clock.session(open - 1) + 1);
+    EXPECT_EQ(clock.session(open + day - 1), clock.session(open));
+    EXPECT_EQ(clock.session(open + day), clock.session(open) + 1);
+}
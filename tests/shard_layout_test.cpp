@@ -0,0 +1,77 @@
+//
+// Created by muhammad-abdullah on 7/30/25.
+//
+// File: tests/shard_layout_test.cpp
+#include <gtest/gtest.h>
+#include "shard_layout.h"
+#include "data_types.h"
+#include "mark_to_market.h"
+
+TEST(ShardLayoutTest, AssignsDenseSlotsPerShard) {
+    rms::ShardLayout layout;
+    ASSERT_TRUE(layout.configure(4, 3));
+    EXPECT_EQ(layout.slot(5), rms::ShardLayout::NO_SLOT);
+    // 5, 1029 and 2053 are the same slot under account_id % 256
+    EXPECT_EQ(layout.assign(5), 0u);
+    EXPECT_EQ(layout.assign(1029), 1u);
+    EXPECT_EQ(layout.assign(5), 0u);
+    EXPECT_EQ(layout.assign(2053), 2u);
+    EXPECT_EQ(layout.assign(4097), rms::ShardLayout::NO_SLOT);   // shard 1 is full
+    EXPECT_EQ(layout.assign(6), 0u);                             // shard 2 is not
+    EXPECT_EQ(layout.slot(1029), 1u);
+    EXPECT_EQ(layout.accountAt(1, 2), 2053u);
+    EXPECT_EQ(layout.assigned(1), 3u);
+    EXPECT_EQ(layout.assigned(0), 0u);
+}
+
+TEST(ShardLayoutTest, RejectsOutOfRangeCounts) {
+    rms::ShardLayout layout;
+    EXPECT_FALSE(layout.configure(0, 256));
+    EXPECT_FALSE(layout.configure(rms::ShardLayout::MAX_SHARDS + 1, 256));
+    EXPECT_FALSE(layout.configure(4, 0));
+    EXPECT_FALSE(layout.configure(4, rms::ShardLayout::MAX_ACCOUNTS_PER_SHARD + 1));
+    EXPECT_EQ(layout.shards(), rms::ShardLayout::DEFAULT_SHARDS);   // unchanged
+    EXPECT_TRUE(layout.configure(16, 2500));                        // 40000 accounts
+    EXPECT_EQ(layout.shardOf(40001), 1u);
+}
+
+TEST(ShardLayoutTest, ArenaCarvesAlignedZeroedColumns) {
+    rms::ShardArena arena;
+    arena.reset(rms::ShardArena::bytesFor(100, {sizeof(double), sizeof(uint16_t)}));
+    double *a = arena.take<double>(100);
+    uint16_t *b = arena.take<uint16_t>(100);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    EXPECT_EQ((uintptr_t)a % rms::ShardArena::ALIGN, 0u);
+    EXPECT_EQ((uintptr_t)b % rms::ShardArena::ALIGN, 0u);
+    EXPECT_EQ(a[99], 0.0);
+    EXPECT_EQ(b[99], 0u);
+    EXPECT_EQ(arena.take<double>(1), nullptr);   // used up
+}
+
+TEST(ShardLayoutTest, AccountsThatUsedToAliasKeepSeparateState) {
+    const uint32_t shards = 8, accounts = 5000;   // 40000 accounts
+    ASSERT_TRUE(rms::shard_layout.configure(shards, accounts));
+    resizeShardTables(shards, accounts);
+    rms::mark_to_market.resize(shards, accounts);
+
+    // 3 and 3 + 8 * 256 shared a slot when slots were account_id % 256
+    const uint32_t a = 3, b = 3 + 8 * 256, last = 39999;
+    account_limits[shardOf(a)].initial_equity[rms::shard_layout.assign(a)] = 1000.0;
+    account_limits[shardOf(b)].initial_equity[rms::shard_layout.assign(b)] = 2000.0;
+    for (uint32_t id = 0; id < 40000; ++id) ASSERT_NE(rms::shard_layout.assign(id), rms::ShardLayout::NO_SLOT);
+    EXPECT_EQ(rms::shard_layout.assign(40000), rms::ShardLayout::NO_SLOT);
+
+    Position pos;
+    pos.net_qty = 10;
+    pos.avg_entry_price = 50.0;
+    rms::mark_to_market.onPosition(b, 7, pos, 60.0);
+    EXPECT_DOUBLE_EQ(rms::mark_to_market.equity(a), 1000.0);
+    EXPECT_DOUBLE_EQ(rms::mark_to_market.equity(b), 2100.0);
+    EXPECT_DOUBLE_EQ(rms::mark_to_market.equity(last), 0.0);
+    EXPECT_DOUBLE_EQ(rms::mark_to_market.equity(40000), 0.0);   // no slot
+
+    ASSERT_TRUE(rms::shard_layout.configure(rms::ShardLayout::DEFAULT_SHARDS, rms::ShardLayout::DEFAULT_ACCOUNTS_PER_SHARD));
+    resizeShardTables(rms::ShardLayout::DEFAULT_SHARDS, rms::ShardLayout::DEFAULT_ACCOUNTS_PER_SHARD);
+    rms::mark_to_market.resize(rms::ShardLayout::DEFAULT_SHARDS, rms::ShardLayout::DEFAULT_ACCOUNTS_PER_SHARD);
+}
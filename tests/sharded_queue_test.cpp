@@ -0,0 +1,56 @@
+//
+// Created by muhammad-abdullah on 6/4/25.
+//
+// File: tests/sharded_queue_test.cpp
+#include <gtest/gtest.h>
+#include <array>
+#include <string>
+#include "sharded_queue.h"
+#include "baseline/Order.h"
+
+namespace {
+    // an SBE Order with its header; returns the frame length
+    int32_t encodeOrder(std::array<uint8_t, 256> &frame, uint16_t version, uint16_t template_id) {
+        char *data = reinterpret_cast<char *>(frame.data());
+        baseline::Order encoder;
+        encoder.wrapAndApplyHeader(data, 0, frame.size())
+            .order_id(11)
+            .account_id(5)
+            .instrument_id(3)
+            .quantity(10)
+            .price(1000000);
+        encoder.putSymbol(std::string("ABC"));
+        encoder.putSide(std::string("BUY"));
+        baseline::MessageHeader header;
+        header.wrap(data, 0, 0, frame.size());
+        header.version(version).templateId(template_id);
+        return (int32_t)(baseline::MessageHeader::encodedLength() + encoder.encodedLength());
+    }
+}
+
+TEST(ShardedQueueTest, OnlyCurrentVersionOrdersAreDecoded) {
+    auto queue = std::make_unique<ShardedQueue>();
+    std::array<uint8_t, 256> frame{};
+    aeron::concurrent::AtomicBuffer buffer(frame.data(), frame.size());
+
+    int32_t length = encodeOrder(frame, baseline::Order::sbeSchemaVersion(), baseline::Order::sbeTemplateId());
+    EXPECT_TRUE(isCurrentOrderFrame(buffer, 0, length));
+    queue->enqueue(buffer, 0, length);
+    auto msg = queue->dequeue();
+    ASSERT_TRUE(msg.has_value());
+    ASSERT_TRUE(std::holds_alternative<Order>(*msg));
+    EXPECT_EQ(std::get<Order>(*msg).account_id, 5u);
+    EXPECT_EQ(std::get<Order>(*msg).price, 1000000);
+
+    // a v0 gateway still sends the price as a double: its bits are not read as units
+    length = encodeOrder(frame, 0, baseline::Order::sbeTemplateId());
+    EXPECT_FALSE(isCurrentOrderFrame(buffer, 0, length));
+    queue->enqueue(buffer, 0, length);
+    EXPECT_FALSE(queue->dequeue().has_value());
+
+    length = encodeOrder(frame, baseline::Order::sbeSchemaVersion(), 9);
+    EXPECT_FALSE(isCurrentOrderFrame(buffer, 0, length));
+    queue->enqueue(buffer, 0, length);
+    EXPECT_FALSE(queue->dequeue().has_value());
+    EXPECT_EQ(queue->size(), 0);
+}
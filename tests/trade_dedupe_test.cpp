@@ -0,0 +1,34 @@
+//
+// Created by muhammad-abdullah on 7/25/25.
+//
+// File: tests/trade_dedupe_test.cpp
+#include <gtest/gtest.h>
+#include "trade_dedupe.h"
+
+using rms::TradeSeen;
+
+TEST(TradeDedupeTest, ReplayedSequencesAreDroppedPerVenue) {
+    rms::TradeDeduplicator dedupe(rms::TradeDedupeParams{128});
+    for (uint64_t id = 1; id <= 100; ++id) {
+        ASSERT_EQ(dedupe.check(1, id), TradeSeen::New);
+    }
+    // a reconnect replays the tail of the drop-copy
+    for (uint64_t id = 90; id <= 100; ++id) {
+        EXPECT_EQ(dedupe.check(1, id), TradeSeen::Duplicate);
+    }
+    // the same ids from another venue are different trades
+    EXPECT_EQ(dedupe.check(2, 95), TradeSeen::New);
+    EXPECT_EQ(dedupe.check(2, 95), TradeSeen::Duplicate);
+    // ids the source does not assign are always applied
+    EXPECT_EQ(dedupe.check(1, 0), TradeSeen::New);
+    EXPECT_EQ(dedupe.check(1, 0), TradeSeen::New);
+    EXPECT_EQ(dedupe.duplicates(), 12u);
+
+    // the venue jumps far ahead: what the window passed over is left to the ledger
+    EXPECT_EQ(dedupe.check(1, 300), TradeSeen::New);
+    EXPECT_EQ(dedupe.check(1, 150), TradeSeen::Unknown);
+    EXPECT_EQ(dedupe.check(1, 50), TradeSeen::Unknown);
+    EXPECT_EQ(dedupe.check(1, 299), TradeSeen::New);
+    EXPECT_EQ(dedupe.check(rms::TradeDeduplicator::MAX_VENUES, 7), TradeSeen::Unknown);
+    EXPECT_EQ(dedupe.unknown(), 3u);
+}
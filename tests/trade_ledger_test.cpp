@@ -0,0 +1,101 @@
+//
+// Created by muhammad-abdullah on 7/26/25.
+//
+// File: tests/trade_ledger_test.cpp
+#include <gtest/gtest.h>
+#include "trade_ledger.h"
+#include "price_scale.h"
+
+namespace {
+    TradeExecution fill(uint64_t trade_id, bool is_buy, int64_t qty, double price) {
+        TradeExecution trade{};
+        trade.account_id = 5;
+        trade.instrument_id = 9;
+        trade.quantity = qty;
+        trade.price = rms::price_scales.toFixed(9, price);
+        trade.is_buy = is_buy;
+        trade.venue_id = 1;
+        trade.trade_id = trade_id;
+        return trade;
+    }
+}
+
+TEST(TradeLedgerTest, BustReversesOnlyTheBustedTrade) {
+    rms::TradeLedger ledger;
+    Position pos;
+    ledger.onFill(fill(1, true, 10, 100.0), pos);
+    ledger.onFill(fill(2, true, 10, 110.0), pos);
+    ledger.onFill(fill(3, false, 15, 120.0), pos);
+    // FIFO: all of the 100 lot and half of the 110 lot
+    EXPECT_EQ(pos.net_qty, 5);
+    EXPECT_DOUBLE_EQ(pos.avg_entry_price, 110.0);
+    EXPECT_DOUBLE_EQ(pos.realized_pnl, 250.0);
+
+    // without trade 1 the sale closes the 110 lot and goes short 5
+    ASSERT_TRUE(ledger.bust(1, 1, 5, 9, pos));
+    EXPECT_EQ(pos.net_qty, -5);
+    EXPECT_DOUBLE_EQ(pos.avg_entry_price, 120.0);
+    EXPECT_DOUBLE_EQ(pos.realized_pnl, 100.0);
+    EXPECT_FALSE(ledger.bust(1, 1, 5, 9, pos));     // already busted
+
+    // and without the sale only trade 2 is left
+    ASSERT_TRUE(ledger.bust(1, 3, 5, 9, pos));
+    EXPECT_EQ(pos.net_qty, 10);
+    EXPECT_DOUBLE_EQ(pos.avg_entry_price, 110.0);
+    EXPECT_DOUBLE_EQ(pos.realized_pnl, 0.0);
+
+    EXPECT_FALSE(ledger.bust(1, 99, 5, 9, pos));    // unknown trade
+    EXPECT_FALSE(ledger.bust(1, 2, 6, 9, pos));     // another account's position
+    EXPECT_FALSE(ledger.bust(2, 2, 5, 9, pos));     // same id, another venue
+}
+
+TEST(TradeLedgerTest, CorrectionReappliesAtTheNewTerms) {
+    rms::TradeLedger ledger;
+    Position pos;
+    ledger.onFill(fill(11, true, 10, 100.0), pos);
+    ledger.onFill(fill(12, false, 4, 105.0), pos);
+    EXPECT_DOUBLE_EQ(pos.realized_pnl, 20.0);
+
+    // the buy was really 8 at 101: same as buying 8 at 101 and selling 4 at 105
+    ASSERT_TRUE(ledger.correct(1, 11, 5, 9, 8, rms::price_scales.toFixed(9, 101.0), pos));
+    EXPECT_EQ(pos.net_qty, 4);
+    EXPECT_DOUBLE_EQ(pos.avg_entry_price, 101.0);
+    EXPECT_DOUBLE_EQ(pos.realized_pnl, 16.0);
+    EXPECT_EQ(ledger.openLots(5, 9), 1u);
+
+    // the corrected trade can itself be busted later
+    ASSERT_TRUE(ledger.bust(1, 11, 5, 9, pos));
+    EXPECT_EQ(pos.net_qty, -4);
+    EXPECT_DOUBLE_EQ(pos.avg_entry_price, 105.0);
+    EXPECT_DOUBLE_EQ(pos.realized_pnl, 0.0);
+}
+
+TEST(TradeLedgerTest, RestoredPositionOpensAsOneLot) {
+    rms::TradeLedger ledger;
+    Position pos;
+    pos.net_qty = 7;
+    pos.avg_entry_price = 50.0;
+    ledger.onFill(fill(21, false, 7, 60.0), pos);
+    EXPECT_EQ(pos.net_qty, 0);
+    EXPECT_DOUBLE_EQ(pos.avg_entry_price, 0.0);
+    EXPECT_DOUBLE_EQ(pos.realized_pnl, 70.0);
+    ASSERT_TRUE(ledger.bust(1, 21, 5, 9, pos));
+    EXPECT_EQ(pos.net_qty, 7);
+    EXPECT_DOUBLE_EQ(pos.avg_entry_price, 50.0);
+    EXPECT_DOUBLE_EQ(pos.realized_pnl, 0.0);
+}
+
+TEST(TradeLedgerTest, RealizedPnlDoesNotDrift) {
+    rms::TradeLedger ledger;
+    Position pos;
+    ledger.onFill(fill(31, true, 10, 100.10), pos);
+    // ten sales of one at a 0.10 profit; summed in doubles this is 0.9999999999999999
+    for (uint64_t id = 32; id < 42; ++id) {
+        ledger.onFill(fill(id, false, 1, 100.20), pos);
+    }
+    EXPECT_EQ(pos.net_qty, 0);
+    EXPECT_EQ(pos.realized_pnl, 1.0);
+    ASSERT_TRUE(ledger.bust(1, 35, 5, 9, pos));
+    EXPECT_EQ(pos.realized_pnl, 0.9);
+    EXPECT_EQ(pos.avg_entry_price, 100.10);
+}
@@ -3,10 +3,109 @@
 //
 // File: tests/vcm_module_test.cpp
 #include <gtest/gtest.h>
+#include <thread>
 #include "rms/vcm_module.h"
+#include "rms/l1_table.h"
+#include "rms/volatility.h"
+#include "rms/vcm_state.h"
+#include "rms/price_scale.h"
+#include <memory>
 
 TEST(VCMModuleTest, SpreadCheck) {
     rms::VCMModule vcm;
-    Order o{0,0,10,50,50.0};
+    Order o{0,0,10,50,rms::price_scales.toFixed(10, 50.0)};
     EXPECT_TRUE(vcm.checkSpread(o));
 }
+
+TEST(VCMModuleTest, SpreadInTicks) {
+    rms::VCMModule vcm;
+    instrument_limits.max_spread_ticks[11] = 3;
+    rms::l1_table.setTickSize(11, 0.05);
+    Order o{0, 0, 11, 10, rms::price_scales.toFixed(11, 100.0)};
+    vcm.onMarketData(11, 100.00, 100.15);   // 3 ticks, not 2.9999
+    EXPECT_TRUE(vcm.checkSpread(o));
+    vcm.onMarketData(11, 100.00, 100.20);
+    EXPECT_FALSE(vcm.checkSpread(o));
+    vcm.onLastTrade(11, 100.10);
+    rms::L1Snapshot snap;
+    ASSERT_TRUE(rms::l1_table.read(11, snap));
+    EXPECT_DOUBLE_EQ(snap.last, 100.10);
+    EXPECT_DOUBLE_EQ(snap.ask, 100.20);
+    EXPECT_FALSE(rms::l1_table.read(NUM_INSTRUMENTS, snap));
+}
+
+TEST(VCMModuleTest, SeqlockReadersSeeWholeQuotes) {
+    // the writer always quotes ask = bid + 1; a torn read would break that
+    std::atomic<bool> started{false}, done{false};
+    std::thread writer([&] {
+        while (!started) std::this_thread::yield();
+        for (int i = 1; i <= 2000000; ++i) rms::l1_table.updateQuote(12, i, i + 1.0);
+        done = true;
+    });
+    uint64_t reads = 0;
+    started = true;
+    while (!done) {
+        rms::L1Snapshot snap;
+        ASSERT_TRUE(rms::l1_table.read(12, snap));
+        if (snap.hasQuote()) ASSERT_DOUBLE_EQ(snap.ask - snap.bid, 1.0);
+        ++reads;
+    }
+    writer.join();
+    EXPECT_GT(reads, 0u);
+}
+
+TEST(VCMModuleTest, VolatilityBands) {
+    auto vol = std::make_unique<rms::VolatilityTable>();
+    vol->setBands(3, 0.01, 0.02);
+    uint64_t t = 10000;
+    // quiet market: 1 bp moves
+    for (int i = 0; i < 50; ++i) vol->onQuote(3, 100.0 + (i & 1) * 0.01, t + i);
+    EXPECT_EQ(vol->state(3), rms::VolState::Normal);
+    EXPECT_LT(vol->tickVol(3), 0.001);
+
+    // a 3% jump breaks the range band straight away
+    vol->onQuote(3, 103.0, t + 60);
+    EXPECT_EQ(vol->state(3), rms::VolState::Breach);
+    EXPECT_GT(vol->rangePct(3), 0.02);
+
+    // two quiet buckets later the range has rolled off, but the EWMA still remembers the jump
+    for (int i = 0; i < 5; ++i) vol->onQuote(3, 103.0, t + 2500 + i);
+    EXPECT_LT(vol->rangePct(3), 0.02);
+    EXPECT_GT(vol->tickVol(3), 0.01 * 0.5);
+    // widening the band and recomputing clears the state in bulk
+    vol->setBands(3, 0.05, 0.02);
+    vol->recompute();
+    EXPECT_EQ(vol->state(3), rms::VolState::Normal);
+    vol->setBands(3, 0.001, 0.0);
+    vol->recompute();
+    EXPECT_EQ(vol->state(3), rms::VolState::Breach);
+}
+
+TEST(VCMModuleTest, CheckVolatilityUsesPublishedState) {
+    rms::VCMModule vcm;
+    Order o{0, 0, 13, 10, rms::price_scales.toFixed(13, 100.0)};
+    rms::volatility_table.setBands(13, 0.0, 0.01);
+    vcm.onMarketData(13, 99.99, 100.01);
+    EXPECT_TRUE(vcm.checkVolatility(o));
+    vcm.onMarketData(13, 101.99, 102.01);
+    EXPECT_FALSE(vcm.checkVolatility(o));
+}
+
+TEST(VCMModuleTest, TradingStateGatesOrders) {
+    rms::VCMModule vcm;
+    rms::volatility_table.setBands(14, 0.0, 0.01);
+    Order o{0, 0, 14, 10, rms::price_scales.toFixed(14, 100.0)};
+    vcm.onMarketData(14, 99.99, 100.01);
+    EXPECT_TRUE(vcm.checkTradingState(o));
+    vcm.onMarketData(14, 101.99, 102.01);           // 2% jump triggers the VCM
+    ASSERT_EQ(rms::vcm_states.state(14), rms::VcmState::Triggered);
+    EXPECT_FALSE(vcm.checkTradingState(o));
+
+    uint64_t far_future = ~0ULL >> 1;
+    vcm.onTimer(far_future);                        // halt over: cooling off around 102
+    ASSERT_EQ(rms::vcm_states.state(14), rms::VcmState::CoolingOff);
+    o.price = rms::price_scales.toFixed(14, 103.0);
+    EXPECT_TRUE(vcm.checkTradingState(o));
+    o.price = rms::price_scales.toFixed(14, 110.0);
+    EXPECT_FALSE(vcm.checkTradingState(o));
+}
@@ -0,0 +1,94 @@
+//
+// Created by muhammad-abdullah on 7/10/25.
+//
+// File: tests/vcm_state_test.cpp
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+#include "vcm_state.h"
+
+using rms::VcmState;
+
+namespace {
+    struct Harness {
+        std::unique_ptr<rms::VolatilityTable> vol = std::make_unique<rms::VolatilityTable>();
+        std::unique_ptr<rms::VcmStateMachine> vcm = std::make_unique<rms::VcmStateMachine>();
+        std::vector<rms::VcmTransition> seen;
+
+        Harness() {
+            vcm->init(rms::VcmParams{1000, 5000, 3000, 0.02});
+            vcm->setTransitionHandler([this](const rms::VcmTransition &t) { seen.push_back(t); });
+            vol->setBands(1, 0.0, 0.03);
+        }
+
+        // feed one mid per 10 ms, firing the timer like the market-data thread does
+        void play(const std::vector<double> &path, uint64_t &t) {
+            for (double mid : path) {
+                vol->onQuote(1, mid, t);
+                vcm->onMarketData(1, mid, vol->state(1), t);
+                vcm->onTimer(t);
+                t += 10;
+            }
+        }
+
+        void idle(uint64_t until, uint64_t &t) {
+            for (; t < until; t += 10) vcm->onTimer(t);
+        }
+    };
+}
+
+TEST(VcmStateTest, FullCycleOnAGap) {
+    Harness h;
+    uint64_t t = 100000;
+    h.play({100.0, 100.1, 99.9, 100.0}, t);
+    EXPECT_EQ(h.vcm->state(1), VcmState::Normal);
+    EXPECT_TRUE(h.seen.empty());
+
+    // 4% gap inside the range window trips the band
+    h.play({104.0}, t);
+    ASSERT_EQ(h.seen.size(), 1u);
+    EXPECT_EQ(h.seen[0].from, VcmState::Normal);
+    EXPECT_EQ(h.seen[0].to, VcmState::Triggered);
+    EXPECT_DOUBLE_EQ(h.seen[0].reference_price, 104.0);
+    uint64_t triggered_at = h.seen[0].ts_ms;
+
+    // further ticks during the halt change nothing
+    h.play({104.2, 103.9}, t);
+    EXPECT_EQ(h.vcm->state(1), VcmState::Triggered);
+
+    h.idle(triggered_at + 1000 + 10, t);
+    EXPECT_EQ(h.vcm->state(1), VcmState::CoolingOff);
+    h.play({104.5, 103.5}, t);                       // inside the 2% band
+    EXPECT_EQ(h.vcm->state(1), VcmState::CoolingOff);
+
+    h.idle(triggered_at + 1000 + 5000 + 20, t);
+    EXPECT_EQ(h.vcm->state(1), VcmState::Resumed);
+    h.idle(triggered_at + 1000 + 5000 + 3000 + 30, t);
+    EXPECT_EQ(h.vcm->state(1), VcmState::Normal);
+
+    std::vector<VcmState> path;
+    for (const auto &tr : h.seen) path.push_back(tr.to);
+    EXPECT_EQ(path, (std::vector<VcmState>{VcmState::Triggered, VcmState::CoolingOff,
+                                           VcmState::Resumed, VcmState::Normal}));
+}
+
+TEST(VcmStateTest, RetriggersDuringCoolingOffAndResumed) {
+    Harness h;
+    uint64_t t = 200000;
+    h.play({100.0, 104.0}, t);
+    ASSERT_EQ(h.vcm->state(1), VcmState::Triggered);
+    h.idle(t + 1010, t);
+    ASSERT_EQ(h.vcm->state(1), VcmState::CoolingOff);
+
+    // a mid 3% away from the 104 reference breaks the cooling band
+    h.play({107.2}, t);
+    EXPECT_EQ(h.vcm->state(1), VcmState::Triggered);
+    EXPECT_DOUBLE_EQ(h.vcm->referencePrice(1), 107.2);
+
+    h.idle(t + 1010 + 5010, t);
+    ASSERT_EQ(h.vcm->state(1), VcmState::Resumed);
+    // the range has long rolled off; a fresh gap while resumed halts again
+    h.play({107.0, 111.0}, t);
+    EXPECT_EQ(h.vcm->state(1), VcmState::Triggered);
+    EXPECT_EQ(h.seen.back().from, VcmState::Resumed);
+}
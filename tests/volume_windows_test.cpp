@@ -0,0 +1,46 @@
+//
+// Created by muhammad-abdullah on 7/2/25.
+//
+// File: tests/volume_windows_test.cpp
+#include <gtest/gtest.h>
+#include "volume_windows.h"
+
+TEST(VolumeWindowsTest, SlidesOutOldBuckets) {
+    rms::VolumeWindows windows;
+    windows.init(rms::VolumeWindowParams{60000, 6, 4});   // 10 s buckets
+    uint64_t t = 1000000;
+    EXPECT_EQ(windows.volume(1, 2, t).qty, 0);
+    EXPECT_EQ(windows.ringsInUse(1), 0u);                 // reads never allocate
+
+    windows.onTrade(1, 2, 100, 1000.0, t);
+    windows.onTrade(1, 2, 50, 500.0, t + 25000);
+    windows.onTrade(1, 3, 7, 70.0, t + 25000);
+    EXPECT_EQ(windows.volume(1, 2, t + 30000).qty, 150);
+    EXPECT_DOUBLE_EQ(windows.volume(1, 2, t + 30000).notional, 1500.0);
+    // the first trade's bucket drops out one window later
+    EXPECT_EQ(windows.volume(1, 2, t + 60000).qty, 50);
+    EXPECT_EQ(windows.volume(1, 3, t + 60000).qty, 7);
+    EXPECT_EQ(windows.volume(1, 2, t + 200000).qty, 0);
+}
+
+TEST(VolumeWindowsTest, ReclaimsIdleRings) {
+    rms::VolumeWindows windows;
+    windows.init(rms::VolumeWindowParams{60000, 6, 4});
+    uint64_t t = 1000000;
+    for (uint32_t inst = 0; inst < 10; ++inst) {
+        windows.onTrade(5, inst, 1, 1.0, t);
+    }
+    EXPECT_EQ(windows.ringsInUse(1), 10u);
+    EXPECT_EQ(windows.ringsAllocated(1), 10u);
+    EXPECT_EQ(windows.reclaim(1, t + 30000, 100), 0u);   // still inside the window
+    EXPECT_EQ(windows.reclaim(1, t + 60000, 100), 10u);
+    EXPECT_EQ(windows.ringsInUse(1), 0u);
+
+    // a new burst reuses the pooled rings and starts from zero
+    for (uint32_t inst = 100; inst < 110; ++inst) {
+        windows.onTrade(5, inst, 2, 2.0, t + 70000);
+    }
+    EXPECT_EQ(windows.ringsAllocated(1), 10u);
+    EXPECT_EQ(windows.volume(5, 105, t + 70000).qty, 2);
+    EXPECT_EQ(windows.volume(5, 3, t + 70000).qty, 0);
+}